@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+#include <iostream>
+#include <cstdlib>
+
+
+using namespace fp;
+using namespace std;
+
+
+namespace
+{
+
+long measure(const string &device, int baudRate, const SerialOptions &options, int probes, SerialSettings &settings)
+{
+  FiscalPrinter printer;
+
+  printer.open(device, baudRate, options);
+
+  settings = printer.getSerialSettings();
+
+  printer.getEnqStatus(); // pierwsza odpowiedź poza pomiarem (bufory portu, wybudzenie drukarki)
+
+  long result = printer.measureEnqRoundTrip(probes);
+
+  printer.close();
+
+  return result;
+}
+
+
+void print(const string &name, long roundTrip, const SerialSettings &settings)
+{
+  cout << name << ": " << roundTrip << " us (low latency: " << (settings.lowLatency ? "yes" : "no")
+    << ", latency timer: ";
+
+  if (settings.latencyTimer >= 0)
+  {
+    cout << settings.latencyTimer << " ms";
+  }
+  else
+  {
+    cout << "n/a";
+  }
+
+  cout << ")" << endl;
+
+  for (size_t i = 0; i < settings.errors.size(); ++i)
+  {
+    cout << "  " << settings.errors[i] << endl;
+  }
+}
+
+} // namespace
+
+
+// fiscal-printer-bench <urządzenie> [<prędkość> [<ilość pomiarów>]]
+//
+// Średni czas odpowiedzi na ENQ przy zwykłym otwarciu portu i z SerialOptions::lowLatencyDefaults.
+// Opóźnienie konwertera FTDI (sysfs) jest na koniec przywracane do wartości sprzed pomiaru.
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    cerr << "usage: " << argv[0] << " <device> [<baud rate> [<probes>]]" << endl;
+
+    return 1;
+  }
+
+  string device = argv[1];
+
+  int baudRate = argc > 2 ? atoi(argv[2]) : 9600;
+  int probes = argc > 3 ? atoi(argv[3]) : 50;
+
+  try
+  {
+    // najpierw zwykłe otwarcie, ustawienia niskiego opóźnienia pozostają w sterowniku po zamknięciu
+
+    SerialSettings plainSettings;
+    long plain = measure(device, baudRate, SerialOptions(), probes, plainSettings);
+
+    SerialSettings lowLatencySettings;
+    long lowLatency = measure(device, baudRate, SerialOptions::lowLatencyDefaults(), probes, lowLatencySettings);
+
+    print("open()", plain, plainSettings);
+    print("lowLatencyDefaults()", lowLatency, lowLatencySettings);
+
+    if (lowLatency > 0)
+    {
+      cout << "speedup: " << (double)plain / lowLatency << "x" << endl;
+    }
+
+    if (plainSettings.latencyTimer > 0)
+    {
+      SerialOptions restore;
+
+      restore.latencyTimer = plainSettings.latencyTimer;
+
+      FiscalPrinter printer;
+
+      printer.open(device, baudRate, restore);
+      printer.close();
+    }
+  }
+  catch (const std::exception &e)
+  {
+    cerr << e.what() << endl;
+
+    return 1;
+  }
+
+  return 0;
+}
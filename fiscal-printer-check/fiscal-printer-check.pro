@@ -0,0 +1,13 @@
+CONFIG -= qt
+
+CONFIG += console
+
+TARGET = fiscal-printer-check
+
+TEMPLATE = app
+
+INCLUDEPATH += . ..
+
+SOURCES += main.cpp
+
+LIBS += -L../fiscal-printer -lfiscal-printer -lboost_system -lboost_thread -lboost_coroutine -lboost_context
@@ -0,0 +1,845 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#include <fiscal-printer/Command.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+
+using namespace fp;
+using namespace std;
+
+
+// fiscal-printer-check
+//
+// Porównanie ramek zapisywanych przez opisy rozkazów (fp::command) z ramkami składanymi ręcznie,
+// tak jak robiła to wcześniej klasa FiscalPrinter (bajt po bajcie, razem z bajtem kontrolnym).
+// Kod zwracany: 0 - wszystkie ramki są identyczne, 1 - co najmniej jedna różnica.
+
+
+namespace
+{
+
+int checks = 0;
+int failures = 0;
+
+
+string escape(const string &frame)
+{
+  ostringstream out;
+
+  for (size_t i = 0; i < frame.size(); ++i)
+  {
+    unsigned char c = frame[i];
+
+    if (c >= 0x20 && c < 0x7f && c != '\\')
+    {
+      out << c;
+    }
+    else
+    {
+      out << "\\x" << hex << setw(2) << setfill('0') << (int)c << dec;
+    }
+  }
+
+  return out.str();
+}
+
+
+void check(const string &name, Frame expected, Frame actual)
+{
+  ++checks;
+
+  if (expected.str() != actual.str())
+  {
+    ++failures;
+
+    cout << "FAIL " << name << endl;
+    cout << "  expected: " << escape(expected.str()) << endl;
+    cout << "  actual:   " << escape(actual.str()) << endl;
+  }
+}
+
+
+// Ramki składane ręcznie (wcześniejsza implementacja FiscalPrinter)
+
+
+Frame handBeginTransaction(int items, const EncodedExtraLines &extraLines, CLIENT_ID_TYPE clientIdType,
+  const string &clientId)
+{
+  Frame frame("$h");
+
+  frame.number(items);
+
+  if (extraLines.isEmpty() && clientIdType == CIDT_NONE)
+  {
+  }
+  else if (clientIdType == CIDT_NONE)
+  {
+    frame.number(extraLines.count());
+    frame.lines(extraLines);
+  }
+  else
+  {
+    frame.number(extraLines.count());
+    frame.number(0);
+    frame.number((int)clientIdType);
+    frame.lines(extraLines);
+    frame.line(clientId);
+  }
+
+  return frame;
+}
+
+
+Frame handCancelTransaction(const Id &id)
+{
+  Frame frame("$e");
+
+  frame.number(0);
+
+  if (!id.isEmpty())
+  {
+    frame.line(id.printerId);
+    frame.line(id.operatorId);
+  }
+
+  return frame;
+}
+
+
+Frame handConfirmTransaction(const EncodedId &id, float cashIn, float total, TRANSACTION_DISCOUNT_TYPE discountType,
+  float discountValue, const EncodedExtraLines &extraLines)
+{
+  Frame frame("$e");
+
+  frame.number(1);
+
+  if (discountType != TDT_0)
+  {
+    frame.number(extraLines.count());
+    frame.number(0);
+    frame.number((int)discountType);
+    frame.number(1);
+  }
+  else if (!extraLines.isEmpty())
+  {
+    frame.number(0);
+    frame.number(extraLines.count());
+    frame.number(0);
+  }
+
+  frame.encoded(id.joined());
+
+  if (discountType != TDT_0 || !extraLines.isEmpty())
+  {
+    frame.lines(extraLines);
+  }
+
+  frame.amount(cashIn);
+  frame.amount(total);
+
+  if (discountType != TDT_0)
+  {
+    frame.amount(discountValue);
+  }
+
+  return frame;
+}
+
+
+Frame handPaymentForms1(const EncodedId &id, const PaymentFormsInfo1 &info, float total,
+  TRANSACTION_DISCOUNT_TYPE discountType, float discountValue, const EncodedExtraLines &extraLines)
+{
+  Frame frame("$x");
+
+  frame.number(extraLines.count());
+  frame.number(0);
+  frame.number(0);
+  frame.number((int)discountType);
+
+  frame.number((int)info.cashFlag);
+  frame.number((int)info.cardFlag);
+  frame.number((int)info.chequeFlag);
+  frame.number((int)info.couponFlag);
+  frame.number((int)info.depositCollectedFlag);
+  frame.number((int)info.depositReturnedFlag);
+  frame.number((int)info.changeFlag);
+
+  frame.encoded(id.joined());
+
+  frame.lines(extraLines, 5);
+
+  frame.line(info.cardName);
+  frame.line(info.chequeName);
+  frame.line(info.couponName);
+
+  frame.amount(total);
+  frame.amount(discountValue);
+
+  frame.amount(info.cashIn);
+  frame.amount(info.cardIn);
+  frame.amount(info.chequeIn);
+  frame.amount(info.couponIn);
+
+  frame.amount(info.depositCollected);
+  frame.amount(info.depositReturned);
+
+  frame.amount(info.checkOut);
+
+  return frame;
+}
+
+
+Frame handPaymentForms2(const EncodedId &id, const PaymentFormsInfo2 &info, float total, DISCOUNT_TYPE discountType,
+  float discountValue, const string &sysNr, bool summary, const EncodedExtraLines &extraLines)
+{
+  Frame frame("$y");
+
+  frame.number(extraLines.count());
+  frame.number(0);
+  frame.number((int)summary);
+  frame.number(0);
+  frame.number((int)discountType);
+  frame.number((int)info.depositCollected.size());
+  frame.number((int)info.depositReturned.size());
+  frame.number(sysNr.size() > 0 ? 1 : 0);
+  frame.number((int)info.paymentForms.size());
+  frame.number((int)info.changeFlag);
+  frame.number((int)info.cashFlag);
+
+  for (size_t i = 0; i < info.paymentForms.size(); ++i)
+  {
+    frame.number((int)info.paymentForms[i].type);
+  }
+
+  frame.encoded(id.split());
+  frame.line(sysNr);
+  frame.lines(extraLines);
+
+  for (size_t i = 0; i < info.paymentForms.size(); ++i)
+  {
+    frame.line(info.paymentForms[i].name);
+  }
+
+  for (size_t i = 0; i < info.depositCollected.size(); ++i)
+  {
+    frame.line(info.depositCollected[i].nr);
+  }
+
+  for (size_t i = 0; i < info.depositCollected.size(); ++i)
+  {
+    frame.line(info.depositCollected[i].quantity);
+  }
+
+  for (size_t i = 0; i < info.depositReturned.size(); ++i)
+  {
+    frame.line(info.depositReturned[i].nr);
+  }
+
+  for (size_t i = 0; i < info.depositReturned.size(); ++i)
+  {
+    frame.line(info.depositReturned[i].quantity);
+  }
+
+  frame.amount(total);
+  frame.value("0");
+  frame.amount(discountValue);
+  frame.amount(info.cashIn);
+
+  for (size_t i = 0; i < info.paymentForms.size(); ++i)
+  {
+    frame.amount(info.paymentForms[i].amount);
+  }
+
+  frame.amount(info.changeOut);
+
+  for (size_t i = 0; i < info.depositCollected.size(); ++i)
+  {
+    frame.amount(info.depositCollected[i].amount);
+  }
+
+  for (size_t i = 0; i < info.depositReturned.size(); ++i)
+  {
+    frame.amount(info.depositReturned[i].amount);
+  }
+
+  return frame;
+}
+
+
+Frame handSetVatRates(const Id &id, int count, const float *rates)
+{
+  Frame frame("$p");
+
+  frame.number(count);
+
+  if (!id.isEmpty())
+  {
+    frame.line(id.printerId);
+    frame.line(id.operatorId);
+  }
+
+  int n = count >= 1 && count <= 7 ? count : 4; // 'case 0' i 'default' - cztery stawki
+
+  for (int i = 0; i < n; ++i)
+  {
+    frame.amount(rates[i]);
+  }
+
+  return frame;
+}
+
+
+Frame handBeginInvoice(const BeginInvoiceData &data)
+{
+  Frame frame("$h");
+
+  frame.number(data.items);
+  frame.number(data.clientLines.size());
+  frame.number(1);
+  frame.number((int)data.printCopy);
+  frame.number((int)data.topMargin);
+  frame.number(0);
+  frame.number(data.additionalCopies);
+  frame.number(0);
+  frame.number(0);
+  frame.number((int)data.signature);
+
+  frame.line(data.invoiceNr);
+
+  for (size_t i = 0; i < data.clientLines.size(); ++i)
+  {
+    frame.line(data.clientLines[i]);
+  }
+
+  frame.line(data.nip);
+  frame.line(data.timeout);
+  frame.line(data.paymentForm);
+  frame.line(data.client);
+  frame.line(data.seller);
+  frame.line(data.systemNr);
+
+  return frame;
+}
+
+
+Frame handFinishInvoice(const Id &id, const FinishInvoiceData &data)
+{
+  Frame frame("$e");
+
+  frame.number(1);
+  frame.number(0);
+  frame.number(data.extraLines.count());
+  frame.number(0);
+  frame.number(0);
+  frame.number(1);
+  frame.number(data.payedFlag);
+  frame.number((int)data.client);
+  frame.number((int)data.seller);
+
+  if (id.isEmpty())
+  {
+    frame.line("000");
+  }
+  else
+  {
+    frame.line(id.printerId + id.operatorId);
+  }
+
+  frame.lines(data.extraLines);
+
+  frame.line(data.payed);
+  frame.line(data.clientName);
+  frame.line(data.sellerName);
+
+  frame.amount(data.cashIn);
+  frame.amount(data.total);
+  frame.amount(data.discountValue);
+
+  return frame;
+}
+
+
+Frame handSetInvoiceOption(const InvoiceOptions &options)
+{
+  Frame frame("@c");
+
+  frame.number(options.additionalCopies);
+  frame.number((int)options.client);
+  frame.number((int)options.seller);
+  frame.number((int)options.payedFlag);
+  frame.number(options.year);
+  frame.number(options.month);
+  frame.number(options.day);
+  frame.number(options.summaryOption);
+  frame.number(options.invoiceOptions2);
+  frame.number((int)options.clientIdType);
+  frame.number(options.invoiceOptions3);
+
+  frame.line(options.timeout);
+  frame.line(options.paymentForm);
+  frame.line(options.clientName);
+  frame.line(options.sellerName);
+  frame.line(options.systemNr);
+
+  return frame;
+}
+
+
+Frame handBeginNonFiscal(int printNr, int headerNr)
+{
+  Frame frame("$w");
+
+  frame.number(0);
+  frame.number(printNr);
+  frame.number(headerNr);
+
+  return frame;
+}
+
+
+Frame handPrintNonFiscal(const NonFiscalLine &line)
+{
+  Frame frame("$w");
+
+  frame.number(line.printNr);
+  frame.number(line.lineNr);
+  frame.number((int)line.bold);
+  frame.number((int)line.inverse);
+  frame.number(line.font);
+  frame.number((int)line.center);
+  frame.number((int)line.attrs);
+
+  for (size_t i = 0; i < line.lines.size(); ++i)
+  {
+    frame.line(line.lines[i]);
+  }
+
+  return frame;
+}
+
+
+Frame handFinishNonFiscal(int printNr, const string &sysNr, const ExtraLines &extraLines)
+{
+  Frame frame("$w");
+
+  frame.number(1);
+  frame.number(printNr);
+  frame.number(sysNr.empty() ? 0 : 1);
+  frame.number(extraLines.count());
+
+  frame.line(sysNr);
+
+  frame.lines(extraLines);
+
+  return frame;
+}
+
+
+Frame handCashier(const char *command, const Id &id)
+{
+  Frame frame(command);
+
+  frame.number(0);
+
+  frame.line(id.operatorId);
+  frame.line(id.printerId);
+
+  return frame;
+}
+
+
+// Ramki z opisów rozkazów (wybór wersji rozkazu jak w FiscalPrinter)
+
+
+Frame beginTransaction(int items, const EncodedExtraLines &extraLines, CLIENT_ID_TYPE clientIdType,
+  const string &clientId)
+{
+  command::TransactionArgs args;
+
+  args.items = items;
+  args.extraLines = &extraLines;
+  args.clientIdType = clientIdType;
+  args.clientId = &clientId;
+
+  return extraLines.isEmpty() && clientIdType == CIDT_NONE
+    ? command::serialize<command::BeginTransaction>(args)
+    : clientIdType == CIDT_NONE
+    ? command::serialize<command::BeginTransactionWithLines>(args)
+    : command::serialize<command::BeginTransactionWithClientId>(args);
+}
+
+
+Frame cancelTransaction(const Id &id)
+{
+  command::TransactionArgs args;
+
+  args.id = &id;
+
+  return id.isEmpty()
+    ? command::serialize<command::CancelTransaction>(args)
+    : command::serialize<command::CancelTransactionWithId>(args);
+}
+
+
+Frame confirmTransaction(const EncodedId &id, float cashIn, float total, TRANSACTION_DISCOUNT_TYPE discountType,
+  float discountValue, const EncodedExtraLines &extraLines)
+{
+  command::TransactionArgs args;
+
+  args.encodedId = &id;
+  args.extraLines = &extraLines;
+  args.cashIn = cashIn;
+  args.total = total;
+  args.discountType = discountType;
+  args.discountValue = discountValue;
+
+  return discountType != TDT_0
+    ? command::serialize<command::ConfirmTransactionWithDiscount>(args)
+    : !extraLines.isEmpty()
+    ? command::serialize<command::ConfirmTransactionWithLines>(args)
+    : command::serialize<command::ConfirmTransaction>(args);
+}
+
+
+Frame paymentForms1(const EncodedId &id, const PaymentFormsInfo1 &info, float total,
+  TRANSACTION_DISCOUNT_TYPE discountType, float discountValue, const EncodedExtraLines &extraLines)
+{
+  command::PaymentForms1Args args;
+
+  args.id = &id;
+  args.info = &info;
+  args.total = total;
+  args.discountType = discountType;
+  args.discountValue = discountValue;
+  args.extraLines = &extraLines;
+
+  return command::serialize<command::ConfirmTransactionWithPaymentForms1>(args);
+}
+
+
+Frame paymentForms2(const EncodedId &id, const PaymentFormsInfo2 &info, float total, DISCOUNT_TYPE discountType,
+  float discountValue, const string &sysNr, bool summary, const EncodedExtraLines &extraLines)
+{
+  command::PaymentForms2Args args;
+
+  args.id = &id;
+  args.info = &info;
+  args.total = total;
+  args.discountType = discountType;
+  args.discountValue = discountValue;
+  args.sysNr = &sysNr;
+  args.summary = summary;
+  args.extraLines = &extraLines;
+
+  return command::serialize<command::ConfirmTransactionWithPaymentForms2>(args);
+}
+
+
+Frame setVatRates(const Id &id, int count, const float *rates)
+{
+  command::VatRatesArgs args;
+
+  args.count = count;
+  args.id = &id;
+
+  int n = count >= 1 && count <= VatTable::SIZE ? count : 4;
+
+  for (int i = 0; i < n; ++i)
+  {
+    args.rates.push_back(rates[i]);
+  }
+
+  return id.isEmpty()
+    ? command::serialize<command::SetVatRates>(args)
+    : command::serialize<command::SetVatRatesWithId>(args);
+}
+
+
+Frame finishInvoice(const Id &id, const FinishInvoiceData &data)
+{
+  EncodedId encodedId(id, false);
+
+  command::FinishInvoiceArgs args;
+
+  args.id = &encodedId;
+  args.data = &data;
+
+  return command::serialize<command::FinishInvoice>(args);
+}
+
+
+Frame beginNonFiscal(int printNr, int headerNr)
+{
+  command::NonFiscalArgs args;
+
+  args.printNr = printNr;
+  args.headerNr = headerNr;
+
+  return command::serialize<command::BeginNonFiscal>(args);
+}
+
+
+Frame finishNonFiscal(int printNr, const string &sysNr, const ExtraLines &extraLines)
+{
+  command::NonFiscalArgs args;
+
+  args.printNr = printNr;
+  args.sysNr = &sysNr;
+  args.extraLines = &extraLines;
+
+  return command::serialize<command::FinishNonFiscal>(args);
+}
+
+
+// Dane testowe
+
+
+ExtraLines extraLines(int n)
+{
+  ExtraLines result;
+
+  if (n > 0) result.line1 = "Zażółć gęślą";
+  if (n > 1) result.line2 = "b";
+  if (n > 2) result.line3 = "Ćma";
+
+  return result;
+}
+
+
+Id id(int n)
+{
+  return n == 0 ? Id() : n == 1 ? Id("KASA1", "Łukasz") : Id("", "Kasjer");
+}
+
+
+void checkTransactions()
+{
+  const CLIENT_ID_TYPE clientIdTypes[] = { CIDT_NONE, (CLIENT_ID_TYPE)1 };
+
+  for (int e = 0; e < 4; ++e)
+  {
+    EncodedExtraLines el(extraLines(e));
+
+    for (int c = 0; c < 2; ++c)
+    {
+      check("$h transaction", handBeginTransaction(3, el, clientIdTypes[c], "1234567890"),
+        beginTransaction(3, el, clientIdTypes[c], "1234567890"));
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+      check("$e cancel", handCancelTransaction(id(i)), cancelTransaction(id(i)));
+
+      EncodedId encodedId = id(i).isEmpty() ? EncodedId() : EncodedId(id(i));
+
+      for (int d = 0; d < 3; ++d)
+      {
+        check("$e confirm", handConfirmTransaction(encodedId, 10.5, 9.99, (TRANSACTION_DISCOUNT_TYPE)d, 2.5, el),
+          confirmTransaction(encodedId, 10.5, 9.99, (TRANSACTION_DISCOUNT_TYPE)d, 2.5, el));
+      }
+
+      PaymentFormsInfo1 info1;
+
+      for (int k = 0; k < 2; ++k)
+      {
+        check("$x", handPaymentForms1(encodedId, info1, 12.34, (TRANSACTION_DISCOUNT_TYPE)k, 1.5, el),
+          paymentForms1(encodedId, info1, 12.34, (TRANSACTION_DISCOUNT_TYPE)k, 1.5, el));
+
+        info1.cashFlag = true;
+        info1.cardFlag = true;
+        info1.changeFlag = true;
+        info1.cashIn = 20.0;
+        info1.cardIn = 5.25;
+        info1.checkOut = 1.01;
+        info1.cardName = "Karta płatnicza";
+        info1.couponName = "Bon";
+      }
+
+      PaymentFormsInfo2 info2;
+
+      info2.cashFlag = true;
+      info2.cashIn = 20.0;
+      info2.changeOut = 1.25;
+
+      for (int k = 0; k < 3; ++k)
+      {
+        string sysNr = k % 2 ? "#123" : "";
+
+        check("$y", handPaymentForms2(encodedId, info2, 12.34, (DISCOUNT_TYPE)1, 1.5, sysNr, k == 1, el),
+          paymentForms2(encodedId, info2, 12.34, (DISCOUNT_TYPE)1, 1.5, sysNr, k == 1, el));
+
+        PaymentForm form;
+
+        form.type = (PAYMENT_TYPE)(k + 1);
+        form.name = "Karta ś";
+        form.amount = 3.5 + k;
+
+        info2.paymentForms.push_back(form);
+
+        Deposit deposit;
+
+        deposit.nr = "K1";
+        deposit.quantity = "2";
+        deposit.amount = 0.5;
+
+        info2.depositCollected.push_back(deposit);
+
+        if (k > 0)
+        {
+          info2.depositReturned.push_back(deposit);
+        }
+      }
+    }
+  }
+}
+
+
+void checkVatRates()
+{
+  const float rates[] = { 23.0, 8.0, 5.0, 0.0, 101.0, 100.0, 7.5 };
+
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int count = -1; count <= 9; ++count)
+    {
+      check("$p", handSetVatRates(id(i), count, rates), setVatRates(id(i), count, rates));
+    }
+  }
+}
+
+
+void checkInvoices()
+{
+  BeginInvoiceData begin;
+
+  InvoiceOptions options;
+
+  for (int k = 0; k < 3; ++k)
+  {
+    check("$h invoice", handBeginInvoice(begin), command::serialize<command::BeginInvoice>(begin));
+    check("@c", handSetInvoiceOption(options), command::serialize<command::SetInvoiceOption>(options));
+
+    begin.items = 4 + k;
+    begin.printCopy = true;
+    begin.signature = k == 1;
+    begin.additionalCopies = k == 2 ? 255 : k;
+    begin.invoiceNr = "FV/1/2014";
+    begin.nip = "123-456-78-90";
+    begin.timeout = "14 dni";
+    begin.paymentForm = "Przelew";
+    begin.client = "Łódź sp. z o.o.";
+    begin.systemNr = "#42";
+    begin.clientLines.push_back("Ulica Źródlana " + fromInt(k));
+
+    options.additionalCopies = k;
+    options.client = (CLIENT_SELLER_OPTION)k;
+    options.payedFlag = k == 1;
+    options.year = 14;
+    options.month = 3;
+    options.day = 10 + k;
+    options.clientIdType = (CLIENT_ID_TYPE)k;
+    options.clientName = "Żaneta";
+    options.systemNr = "#9";
+  }
+
+  FinishInvoiceData finish;
+
+  for (int k = 0; k < 4; ++k)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      check("$e invoice", handFinishInvoice(id(i), finish), finishInvoice(id(i), finish));
+    }
+
+    finish.payedFlag = true;
+    finish.payed = "Zapłacono";
+    finish.client = (CLIENT_SELLER_OPTION)1;
+    finish.cashIn = 100.0;
+    finish.total = 99.99;
+    finish.discountValue = k;
+    finish.clientName = "Józef";
+    finish.sellerName = "Sklep";
+    finish.extraLines = extraLines(k);
+  }
+}
+
+
+void checkNonFiscal()
+{
+  check("$w begin", handBeginNonFiscal(2, 0), beginNonFiscal(2, 0));
+  check("$w begin", handBeginNonFiscal(255, 17), beginNonFiscal(255, 17));
+
+  NonFiscalLine line;
+
+  for (int k = 0; k < 3; ++k)
+  {
+    check("$w line", handPrintNonFiscal(line), command::serialize<command::PrintNonFiscal>(line));
+
+    line.printNr = 2;
+    line.lineNr = k;
+    line.bold = k == 1;
+    line.center = true;
+    line.font = 1;
+    line.attrs = (FONT_ATTRS)k;
+    line.lines.push_back("Pozycja ąę " + fromInt(k));
+  }
+
+  for (int e = 0; e < 4; ++e)
+  {
+    check("$w finish", handFinishNonFiscal(2, "", extraLines(e)), finishNonFiscal(2, "", extraLines(e)));
+    check("$w finish", handFinishNonFiscal(7, "#1", extraLines(e)), finishNonFiscal(7, "#1", extraLines(e)));
+  }
+}
+
+
+void checkCashier()
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    check("#p", handCashier("#p", id(i)), command::serialize<command::Login>(id(i)));
+    check("#q", handCashier("#q", id(i)), command::serialize<command::Logout>(id(i)));
+  }
+}
+
+} // namespace
+
+
+int main()
+{
+  checkTransactions();
+  checkVatRates();
+  checkInvoices();
+  checkNonFiscal();
+  checkCashier();
+
+  cout << checks - failures << "/" << checks << " frames identical" << endl;
+
+  return failures == 0 ? 0 : 1;
+}
@@ -236,22 +236,22 @@ void MainWindow::on_getCashRegisterInfo1Button_clicked()
 
   ui->cashRegisterInfo1LastWriteDate->setText(QString("%1-%2-%3").arg(info.day).arg(info.month).arg(info.year));
 
-  ui->cashRegisterInfo1VatA->setText(QString::number(info.vatA, 'f', 2));
-  ui->cashRegisterInfo1VatB->setText(QString::number(info.vatB, 'f', 2));
-  ui->cashRegisterInfo1VatC->setText(QString::number(info.vatC, 'f', 2));
-  ui->cashRegisterInfo1VatD->setText(QString::number(info.vatD, 'f', 2));
-  ui->cashRegisterInfo1VatE->setText(QString::number(info.vatE, 'f', 2));
-  ui->cashRegisterInfo1VatF->setText(QString::number(info.vatF, 'f', 2));
+  ui->cashRegisterInfo1VatA->setText(QString::number(info.vat.get(0), 'f', 2));
+  ui->cashRegisterInfo1VatB->setText(QString::number(info.vat.get(1), 'f', 2));
+  ui->cashRegisterInfo1VatC->setText(QString::number(info.vat.get(2), 'f', 2));
+  ui->cashRegisterInfo1VatD->setText(QString::number(info.vat.get(3), 'f', 2));
+  ui->cashRegisterInfo1VatE->setText(QString::number(info.vat.get(4), 'f', 2));
+  ui->cashRegisterInfo1VatF->setText(QString::number(info.vat.get(5), 'f', 2));
 
   ui->cashRegisterInfo1Reciepts->setText(QString::number(info.reciepts));
 
-  ui->cashRegisterInfo1TotA->setText(QString::number(info.totA, 'f', 2));
-  ui->cashRegisterInfo1TotB->setText(QString::number(info.totB, 'f', 2));
-  ui->cashRegisterInfo1TotC->setText(QString::number(info.totC, 'f', 2));
-  ui->cashRegisterInfo1TotD->setText(QString::number(info.totD, 'f', 2));
-  ui->cashRegisterInfo1TotE->setText(QString::number(info.totE, 'f', 2));
-  ui->cashRegisterInfo1TotF->setText(QString::number(info.totF, 'f', 2));
-  ui->cashRegisterInfo1TotG->setText(QString::number(info.totG, 'f', 2));
+  ui->cashRegisterInfo1TotA->setText(QString::number(info.totals.get(0), 'f', 2));
+  ui->cashRegisterInfo1TotB->setText(QString::number(info.totals.get(1), 'f', 2));
+  ui->cashRegisterInfo1TotC->setText(QString::number(info.totals.get(2), 'f', 2));
+  ui->cashRegisterInfo1TotD->setText(QString::number(info.totals.get(3), 'f', 2));
+  ui->cashRegisterInfo1TotE->setText(QString::number(info.totals.get(4), 'f', 2));
+  ui->cashRegisterInfo1TotF->setText(QString::number(info.totals.get(5), 'f', 2));
+  ui->cashRegisterInfo1TotG->setText(QString::number(info.totals.get(6), 'f', 2));
 
   ui->cashRegisterInfo1Cash->setText(QString::number(info.cash, 'f', 2));
 
@@ -274,23 +274,23 @@ void MainWindow::on_getCashRegisterInfo2Button_clicked()
 
   ui->cashRegisterInfo2LastWrite->setText(QString("%1-%2-%3").arg(info.day).arg(info.month).arg(info.year));
 
-  ui->cashRegisterInfo2VatA->setText(QString::number(info.vatA, 'f', 2));
-  ui->cashRegisterInfo2VatB->setText(QString::number(info.vatB, 'f', 2));
-  ui->cashRegisterInfo2VatC->setText(QString::number(info.vatC, 'f', 2));
-  ui->cashRegisterInfo2VatD->setText(QString::number(info.vatD, 'f', 2));
-  ui->cashRegisterInfo2VatE->setText(QString::number(info.vatE, 'f', 2));
-  ui->cashRegisterInfo2VatF->setText(QString::number(info.vatF, 'f', 2));
-  ui->cashRegisterInfo2VatG->setText(QString::number(info.vatG, 'f', 2));
+  ui->cashRegisterInfo2VatA->setText(QString::number(info.vat.get(0), 'f', 2));
+  ui->cashRegisterInfo2VatB->setText(QString::number(info.vat.get(1), 'f', 2));
+  ui->cashRegisterInfo2VatC->setText(QString::number(info.vat.get(2), 'f', 2));
+  ui->cashRegisterInfo2VatD->setText(QString::number(info.vat.get(3), 'f', 2));
+  ui->cashRegisterInfo2VatE->setText(QString::number(info.vat.get(4), 'f', 2));
+  ui->cashRegisterInfo2VatF->setText(QString::number(info.vat.get(5), 'f', 2));
+  ui->cashRegisterInfo2VatG->setText(QString::number(info.vat.get(6), 'f', 2));
 
   ui->cashRegisterInfo2Reciepts->setText(QString::number(info.reciepts));
 
-  ui->cashRegisterInfo2TotA->setText(QString::number(info.totA, 'f', 2));
-  ui->cashRegisterInfo2TotB->setText(QString::number(info.totB, 'f', 2));
-  ui->cashRegisterInfo2TotC->setText(QString::number(info.totC, 'f', 2));
-  ui->cashRegisterInfo2TotD->setText(QString::number(info.totD, 'f', 2));
-  ui->cashRegisterInfo2TotE->setText(QString::number(info.totE, 'f', 2));
-  ui->cashRegisterInfo2TotF->setText(QString::number(info.totF, 'f', 2));
-  ui->cashRegisterInfo2TotG->setText(QString::number(info.totG, 'f', 2));
+  ui->cashRegisterInfo2TotA->setText(QString::number(info.totals.get(0), 'f', 2));
+  ui->cashRegisterInfo2TotB->setText(QString::number(info.totals.get(1), 'f', 2));
+  ui->cashRegisterInfo2TotC->setText(QString::number(info.totals.get(2), 'f', 2));
+  ui->cashRegisterInfo2TotD->setText(QString::number(info.totals.get(3), 'f', 2));
+  ui->cashRegisterInfo2TotE->setText(QString::number(info.totals.get(4), 'f', 2));
+  ui->cashRegisterInfo2TotF->setText(QString::number(info.totals.get(5), 'f', 2));
+  ui->cashRegisterInfo2TotG->setText(QString::number(info.totals.get(6), 'f', 2));
 
   ui->cashRegisterInfo2Cash->setText(QString::number(info.cash, 'f', 2));
 
@@ -308,13 +308,13 @@ void MainWindow::on_getCashRegisterInfo3Button_clicked()
   ui->cashRegisterInfo3UsedReports->setText(QString::number(info.usedReports));
   ui->cashRegisterInfo3Locked->setText(QString::number(info.locked));
 
-  ui->cashRegisterInfo3TotA->setText(QString::number(info.totA, 'f', 2));
-  ui->cashRegisterInfo3TotB->setText(QString::number(info.totB, 'f', 2));
-  ui->cashRegisterInfo3TotC->setText(QString::number(info.totC, 'f', 2));
-  ui->cashRegisterInfo3TotD->setText(QString::number(info.totD, 'f', 2));
-  ui->cashRegisterInfo3TotE->setText(QString::number(info.totE, 'f', 2));
-  ui->cashRegisterInfo3TotF->setText(QString::number(info.totF, 'f', 2));
-  ui->cashRegisterInfo3TotG->setText(QString::number(info.totG, 'f', 2));
+  ui->cashRegisterInfo3TotA->setText(QString::number(info.totals.get(0), 'f', 2));
+  ui->cashRegisterInfo3TotB->setText(QString::number(info.totals.get(1), 'f', 2));
+  ui->cashRegisterInfo3TotC->setText(QString::number(info.totals.get(2), 'f', 2));
+  ui->cashRegisterInfo3TotD->setText(QString::number(info.totals.get(3), 'f', 2));
+  ui->cashRegisterInfo3TotE->setText(QString::number(info.totals.get(4), 'f', 2));
+  ui->cashRegisterInfo3TotF->setText(QString::number(info.totals.get(5), 'f', 2));
+  ui->cashRegisterInfo3TotG->setText(QString::number(info.totals.get(6), 'f', 2));
 }
 
 
@@ -354,13 +354,13 @@ void MainWindow::on_getCashRegisterInfo6Button_clicked()
 
   ui->cashRegisterInfo6Total->setText(QString::number(info.total, 'f', 2));
 
-  ui->cashRegisterInfo6TotA->setText(QString::number(info.totA, 'f', 2));
-  ui->cashRegisterInfo6TotB->setText(QString::number(info.totB, 'f', 2));
-  ui->cashRegisterInfo6TotC->setText(QString::number(info.totC, 'f', 2));
-  ui->cashRegisterInfo6TotD->setText(QString::number(info.totD, 'f', 2));
-  ui->cashRegisterInfo6TotE->setText(QString::number(info.totE, 'f', 2));
-  ui->cashRegisterInfo6TotF->setText(QString::number(info.totF, 'f', 2));
-  ui->cashRegisterInfo6TotG->setText(QString::number(info.totG, 'f', 2));
+  ui->cashRegisterInfo6TotA->setText(QString::number(info.totals.get(0), 'f', 2));
+  ui->cashRegisterInfo6TotB->setText(QString::number(info.totals.get(1), 'f', 2));
+  ui->cashRegisterInfo6TotC->setText(QString::number(info.totals.get(2), 'f', 2));
+  ui->cashRegisterInfo6TotD->setText(QString::number(info.totals.get(3), 'f', 2));
+  ui->cashRegisterInfo6TotE->setText(QString::number(info.totals.get(4), 'f', 2));
+  ui->cashRegisterInfo6TotF->setText(QString::number(info.totals.get(5), 'f', 2));
+  ui->cashRegisterInfo6TotG->setText(QString::number(info.totals.get(6), 'f', 2));
 }
 
 
@@ -475,13 +475,13 @@ void MainWindow::on_getFiscalMemoryRecordButton_clicked()
 
       ui->recordDailyReportCancelledReceiptsValue->setText(QString::number(dailyReport->cancelledReceiptsValue, 'f', 2));
 
-      ui->recordDailyReportTotA->setText(QString::number(dailyReport->totA, 'f', 2));
-      ui->recordDailyReportTotB->setText(QString::number(dailyReport->totB, 'f', 2));
-      ui->recordDailyReportTotC->setText(QString::number(dailyReport->totC, 'f', 2));
-      ui->recordDailyReportTotD->setText(QString::number(dailyReport->totD, 'f', 2));
-      ui->recordDailyReportTotE->setText(QString::number(dailyReport->totE, 'f', 2));
-      ui->recordDailyReportTotF->setText(QString::number(dailyReport->totF, 'f', 2));
-      ui->recordDailyReportTotG->setText(QString::number(dailyReport->totG, 'f', 2));
+      ui->recordDailyReportTotA->setText(QString::number(dailyReport->totals.get(0), 'f', 2));
+      ui->recordDailyReportTotB->setText(QString::number(dailyReport->totals.get(1), 'f', 2));
+      ui->recordDailyReportTotC->setText(QString::number(dailyReport->totals.get(2), 'f', 2));
+      ui->recordDailyReportTotD->setText(QString::number(dailyReport->totals.get(3), 'f', 2));
+      ui->recordDailyReportTotE->setText(QString::number(dailyReport->totals.get(4), 'f', 2));
+      ui->recordDailyReportTotF->setText(QString::number(dailyReport->totals.get(5), 'f', 2));
+      ui->recordDailyReportTotG->setText(QString::number(dailyReport->totals.get(6), 'f', 2));
 
       ui->recordType->setCurrentIndex(1);
       ui->recordsStackedWidget->setCurrentIndex(1);
@@ -496,13 +496,13 @@ void MainWindow::on_getFiscalMemoryRecordButton_clicked()
       ui->recordVatChangeDate->setText(QString("%1-%2-%3 %4:%5:%6").arg(vatChange->day).arg(vatChange->month).arg(vatChange->year)
                                        .arg(vatChange->hour).arg(vatChange->minute).arg(vatChange->second));
 
-      ui->recordVatChangeVatA->setText(QString::number(vatChange->vatA, 'f', 2));
-      ui->recordVatChangeVatB->setText(QString::number(vatChange->vatB, 'f', 2));
-      ui->recordVatChangeVatC->setText(QString::number(vatChange->vatC, 'f', 2));
-      ui->recordVatChangeVatD->setText(QString::number(vatChange->vatD, 'f', 2));
-      ui->recordVatChangeVatE->setText(QString::number(vatChange->vatE, 'f', 2));
-      ui->recordVatChangeVatF->setText(QString::number(vatChange->vatF, 'f', 2));
-      ui->recordVatChangeVatG->setText(QString::number(vatChange->vatG, 'f', 2));
+      ui->recordVatChangeVatA->setText(QString::number(vatChange->vat.get(0), 'f', 2));
+      ui->recordVatChangeVatB->setText(QString::number(vatChange->vat.get(1), 'f', 2));
+      ui->recordVatChangeVatC->setText(QString::number(vatChange->vat.get(2), 'f', 2));
+      ui->recordVatChangeVatD->setText(QString::number(vatChange->vat.get(3), 'f', 2));
+      ui->recordVatChangeVatE->setText(QString::number(vatChange->vat.get(4), 'f', 2));
+      ui->recordVatChangeVatF->setText(QString::number(vatChange->vat.get(5), 'f', 2));
+      ui->recordVatChangeVatG->setText(QString::number(vatChange->vat.get(6), 'f', 2));
 
       ui->recordType->setCurrentIndex(2);
       ui->recordsStackedWidget->setCurrentIndex(2);
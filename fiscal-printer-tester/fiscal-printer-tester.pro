@@ -10,4 +10,4 @@ HEADERS += MainWindow.hpp
 
 FORMS += MainWindow.ui
 
-LIBS += -L../fiscal-printer -lfiscal-printer -lboost_regex -lboost_system
+LIBS += -L../fiscal-printer -lfiscal-printer -lboost_regex -lboost_system -lboost_thread -lboost_coroutine -lboost_context
@@ -2,4 +2,4 @@ TEMPLATE = subdirs
 
 CONFIG += ordered
 
-SUBDIRS = fiscal-printer fiscal-printer-tester
+SUBDIRS = fiscal-printer fiscal-printer-tester fiscal-printerd fiscal-printer-bench fiscal-printer-check
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/Client.hpp>
+
+#include <boost/bind.hpp>
+
+
+using namespace fp;
+using namespace fp::protocol;
+using namespace std;
+using namespace boost;
+
+
+Client::Client() : socket(io), nextId(0), connected(false), thread(NULL)
+{
+}
+
+
+Client::~Client()
+{
+  close();
+}
+
+
+void Client::connect(const string &path)
+{
+  if (connected)
+  {
+    return;
+  }
+
+  socket.connect(boost::asio::local::stream_protocol::endpoint(path));
+
+  connected = true;
+
+  thread = new boost::thread(boost::bind(&Client::run, this));
+}
+
+
+void Client::close()
+{
+  if (thread == NULL)
+  {
+    return;
+  }
+
+  boost::system::error_code ec;
+
+  socket.shutdown(boost::asio::local::stream_protocol::socket::shutdown_both, ec);
+
+  thread->join();
+
+  delete thread;
+  thread = NULL;
+
+  socket.close(ec);
+}
+
+
+bool Client::isConnected() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return connected;
+}
+
+
+uint32_t Client::submit(Request &request, const CompletionHandler &handler)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    if (!connected)
+    {
+      throw boost::system::system_error(boost::asio::error::not_connected);
+    }
+
+    request.requestId = ++nextId;
+
+    handlers[request.requestId] = handler;
+  }
+
+  string data = encodeRequest(request);
+
+  try
+  {
+    boost::lock_guard<boost::mutex> lock(writeMutex);
+
+    boost::asio::write(socket, boost::asio::buffer(data));
+  }
+  catch (const std::exception &)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    handlers.erase(request.requestId);
+
+    throw;
+  }
+
+  return request.requestId;
+}
+
+
+uint32_t Client::printReceipt(const string &printer, const Receipt &receipt, const CompletionHandler &handler)
+{
+  Command command;
+
+  command.type = CT_RECEIPT;
+  command.receipt = receipt;
+
+  return submit(printer, SP_NORMAL, command, handler);
+}
+
+
+uint32_t Client::printNonFiscal(const string &printer, const NonFiscalDocument &document,
+  const CompletionHandler &handler)
+{
+  Command command;
+
+  command.type = CT_NON_FISCAL;
+  command.nonFiscal = document;
+
+  return submit(printer, SP_BULK, command, handler);
+}
+
+
+uint32_t Client::openDrawer(const string &printer, const CompletionHandler &handler)
+{
+  Command command;
+
+  command.type = CT_OPEN_DRAWER;
+
+  return submit(printer, SP_INTERACTIVE, command, handler);
+}
+
+
+uint32_t Client::setDisplayMessage(const string &printer, const string &message, const CompletionHandler &handler)
+{
+  Command command;
+
+  command.type = CT_DISPLAY_MESSAGE;
+  command.message = message;
+
+  return submit(printer, SP_INTERACTIVE, command, handler);
+}
+
+
+uint32_t Client::submit(const string &printer, SCHEDULER_PRIORITY priority, const Command &command,
+  const CompletionHandler &handler)
+{
+  Request request;
+
+  request.printer = printer;
+  request.priority = priority;
+  request.commands.push_back(command);
+
+  return submit(request, handler);
+}
+
+
+void Client::run()
+{
+  try
+  {
+    while (true)
+    {
+      char header[4];
+
+      boost::asio::read(socket, boost::asio::buffer(header, sizeof(header)));
+
+      uint32_t size = decodeLength(header);
+
+      if (size > MAX_MESSAGE_SIZE)
+      {
+        break;
+      }
+
+      string body(size, '\0');
+
+      if (size > 0)
+      {
+        boost::asio::read(socket, boost::asio::buffer(&body[0], size));
+      }
+
+      Completion completion;
+
+      if (!decodeCompletion(body, completion))
+      {
+        continue; // nieznana wiadomość
+      }
+
+      CompletionHandler handler;
+
+      {
+        boost::lock_guard<boost::mutex> lock(mutex);
+
+        std::map<uint32_t, CompletionHandler>::iterator i = handlers.find(completion.requestId);
+
+        if (i == handlers.end())
+        {
+          continue;
+        }
+
+        handler = i->second;
+
+        handlers.erase(i);
+      }
+
+      if (handler)
+      {
+        handler(completion);
+      }
+    }
+  }
+  catch (const std::exception &)
+  {
+    // rozłączenie
+  }
+
+  failPending("connection closed");
+}
+
+
+void Client::failPending(const string &error)
+{
+  std::map<uint32_t, CompletionHandler> pending;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    connected = false;
+
+    pending.swap(handlers);
+  }
+
+  for (std::map<uint32_t, CompletionHandler>::iterator i = pending.begin(); i != pending.end(); ++i)
+  {
+    if (i->second)
+    {
+      Completion completion;
+
+      completion.requestId = i->first;
+      completion.error = error;
+
+      i->second(completion);
+    }
+  }
+}
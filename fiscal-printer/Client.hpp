@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_CLIENT_HPP__
+#define __FP_CLIENT_HPP__
+
+
+#include <fiscal-printer/Protocol.hpp>
+
+#include <map>
+
+#include <boost/asio.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+
+namespace fp
+{
+
+
+/// Klient demona fiscal-printerd.
+/**
+    Zlecenia są wysyłane przez gniazdo Unix, wyniki przychodzą asynchronicznie
+    i są przekazywane do funkcji podanych przy zleceniu.
+
+    @note Funkcje obsługi wyników są wołane z wątku klienta.
+ */
+class Client
+{
+
+public:
+
+  typedef boost::function<void (const fp::protocol::Completion &)> CompletionHandler;
+
+  Client();
+  ~Client();
+
+  /// Połączenie z demonem.
+  /**
+      @param path Ścieżka gniazda demona (n.p. "/run/fiscal-printerd.sock")
+   */
+  void connect(const std::string &path);
+
+  /// Rozłączenie.
+  /**
+      @note Metoda wołana w destruktorze. Zlecenia bez wyniku kończą się błędem.
+   */
+  void close();
+
+  /// Czy klient jest połączony.
+  bool isConnected() const;
+
+  /// Wysłanie zlecenia.
+  /**
+      @param request Zlecenie (pole requestId jest nadawane przez klienta)
+      @param handler Funkcja wołana po otrzymaniu wyniku
+
+      @return Identyfikator zlecenia
+   */
+  boost::uint32_t submit(fp::protocol::Request &request, const CompletionHandler &handler = CompletionHandler());
+
+  /// Wydruk paragonu.
+  boost::uint32_t printReceipt(const std::string &printer, const fp::Receipt &receipt,
+    const CompletionHandler &handler = CompletionHandler());
+
+  /// Wydruk niefiskalny.
+  boost::uint32_t printNonFiscal(const std::string &printer, const fp::NonFiscalDocument &document,
+    const CompletionHandler &handler = CompletionHandler());
+
+  /// Otwarcie szuflady.
+  boost::uint32_t openDrawer(const std::string &printer, const CompletionHandler &handler = CompletionHandler());
+
+  /// Napis na wyświetlaczu.
+  boost::uint32_t setDisplayMessage(const std::string &printer, const std::string &message,
+    const CompletionHandler &handler = CompletionHandler());
+
+private:
+
+  boost::uint32_t submit(const std::string &printer, fp::SCHEDULER_PRIORITY priority,
+    const fp::protocol::Command &command, const CompletionHandler &handler);
+
+  void run();
+
+  void failPending(const std::string &error);
+
+  boost::asio::io_service io;
+  boost::asio::local::stream_protocol::socket socket;
+
+  boost::uint32_t nextId;
+
+  std::map<boost::uint32_t, CompletionHandler> handlers;
+
+  bool connected;
+
+  mutable boost::mutex mutex;
+  boost::mutex writeMutex;
+
+  boost::thread *thread;
+
+}; // class Client
+
+
+} // namespace fp
+
+
+#endif // __FP_CLIENT_HPP__
@@ -0,0 +1,902 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+#ifndef __FP_COMMAND_HPP__
+#define __FP_COMMAND_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+#include <fiscal-printer/Frame.hpp>
+#include <fiscal-printer/StaticVector.hpp>
+
+#include <boost/static_assert.hpp>
+
+#include <boost/mpl/begin_end.hpp>
+#include <boost/mpl/deref.hpp>
+#include <boost/mpl/next.hpp>
+#include <boost/mpl/vector.hpp>
+#include <boost/mpl/vector/vector30.hpp>
+
+
+namespace fp
+{
+
+
+/// Opisy rozkazów protokołu POSNET.
+/**
+    Rozkaz jest opisywany typem: mnemonik, bajt kontrolny i lista pól (boost::mpl::vector) w kolejności
+    z dokumentacji. Każde pole wie, skąd wziąć wartość z argumentów rozkazu (struktura), a ramka jest
+    zapisywana przez serializer rozwijany w czasie kompilacji (bez pośrednich wektorów, bezpośrednio
+    przez fp::Frame).
+
+    @code
+    typedef Descriptor<'$', 'h', boost::mpl::vector<
+      Number<TransactionArgs::Items>,
+      Number<Count<TransactionArgs::ExtraLines> >,
+      Lines<TransactionArgs::ExtraLines>
+      > > BeginTransactionWithLines;
+
+    fp::Frame frame = fp::command::serialize<fp::command::BeginTransactionWithLines>(args);
+    @endcode
+
+    @note Parametry liczbowe po polu tekstowym są błędem kompilacji.
+
+    @note Program fiscal-printer-check porównuje ramki z opisów z ramkami składanymi ręcznie.
+ */
+namespace command
+{
+
+
+// Wartości pól (statyczna metoda 'get' z argumentów rozkazu)
+
+
+/// Składowa argumentów.
+template <class A, class T, T A::*M>
+struct Member
+{
+  typedef T value_type;
+
+  static const T &get(const A &a) { return a.*M; }
+
+}; // struct Member
+
+
+/// Obiekt wskazywany przez składowaną w argumentach wskaźnik (obiekt nie jest kopiowany).
+template <class A, class T, const T *A::*M>
+struct Pointee
+{
+  typedef T value_type;
+
+  static const T &get(const A &a) { return *(a.*M); }
+
+}; // struct Pointee
+
+
+/// Wartość 'Inner' z obiektu zwracanego przez 'Outer'.
+template <class Outer, class Inner>
+struct Compose
+{
+  template <class A>
+  static const typename Inner::value_type &get(const A &a) { return Inner::get(Outer::get(a)); }
+
+}; // struct Compose
+
+
+/// Ilość linii (count()) wartości.
+template <class Get>
+struct Count
+{
+  template <class A>
+  static int get(const A &a) { return Get::get(a).count(); }
+
+}; // struct Count
+
+
+/// Ilość elementów (size()) wartości.
+template <class Get>
+struct Size
+{
+  template <class A>
+  static int get(const A &a) { return (int)Get::get(a).size(); }
+
+}; // struct Size
+
+
+/// 1, jeśli wartość nie jest pusta (empty()), 0 w przeciwnym razie.
+template <class Get>
+struct NotEmpty
+{
+  template <class A>
+  static int get(const A &a) { return Get::get(a).empty() ? 0 : 1; }
+
+}; // struct NotEmpty
+
+
+/// Numer kasy i kasjer w jednym polu (EncodedId::joined).
+template <class Get>
+struct Joined
+{
+  template <class A>
+  static const fp::EncodedText &get(const A &a) { return Get::get(a).joined(); }
+
+}; // struct Joined
+
+
+/// Numer kasy i kasjer w osobnych polach (EncodedId::split).
+template <class Get>
+struct Split
+{
+  template <class A>
+  static const fp::EncodedText &get(const A &a) { return Get::get(a).split(); }
+
+}; // struct Split
+
+
+/// Sam element (pola Each dla sekwencji wartości, n.p. linii tekstu).
+template <class T>
+struct Value
+{
+  typedef T value_type;
+
+  static const T &get(const T &t) { return t; }
+
+}; // struct Value
+
+
+// Pola ramki (TEXT - pole tekstowe, statyczna metoda 'write' zapisuje pole do ramki)
+
+
+/// Parametr liczbowy.
+template <class Get>
+struct Number
+{
+  enum { TEXT = 0 };
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &a) { frame.number((int)Get::get(a)); }
+
+}; // struct Number
+
+
+/// Stały parametr liczbowy.
+template <int N>
+struct Constant
+{
+  enum { TEXT = 0 };
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &) { frame.number(N); }
+
+}; // struct Constant
+
+
+/// Pole tekstowe zakończone znakiem CR.
+template <class Get>
+struct Line
+{
+  enum { TEXT = 1 };
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &a) { frame.line(Get::get(a)); }
+
+}; // struct Line
+
+
+/// Stała liczba zakończona znakiem '/'.
+template <int N>
+struct ConstantValue
+{
+  enum { TEXT = 1 };
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &) { frame.value(fp::fromInt(N)); }
+
+}; // struct ConstantValue
+
+
+/// Kwota zakończona znakiem '/'.
+template <class Get>
+struct Amount
+{
+  enum { TEXT = 1 };
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &a) { frame.amount(Get::get(a)); }
+
+}; // struct Amount
+
+
+/// Zakodowane pola tekstowe (fp::EncodedText).
+template <class Get>
+struct Encoded
+{
+  enum { TEXT = 1 };
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &a) { frame.encoded(Get::get(a)); }
+
+}; // struct Encoded
+
+
+/// Linie dodatkowe (jak Frame::lines, 'N' - ilość pól z uzupełnieniem pustymi liniami).
+template <class Get, int N = 0>
+struct Lines
+{
+  enum { TEXT = 1 };
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &a) { frame.lines(Get::get(a), N); }
+
+}; // struct Lines
+
+
+/// Pole 'Field' dla każdego elementu sekwencji (wartość 'Field' jest pobierana z elementu).
+template <class Get, class Field>
+struct Each
+{
+  enum { TEXT = Field::TEXT };
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &a)
+  {
+    for (size_t i = 0; i < Get::get(a).size(); ++i)
+    {
+      Field::write(frame, Get::get(a)[i]);
+    }
+  }
+
+}; // struct Each
+
+
+/// Opis rozkazu.
+/**
+    @param C1 Pierwszy znak mnemonika
+    @param C2 Drugi znak mnemonika
+    @param Fields Pola w kolejności z dokumentacji (boost::mpl::vector)
+    @param Ctrl Ramka z bajtem kontrolnym
+ */
+template <char C1, char C2, class Fields, bool Ctrl = true>
+struct Descriptor
+{
+  typedef Fields fields;
+
+  enum { CTRL = Ctrl };
+
+  static const char *mnemonic()
+  {
+    static const char m[] = { C1, C2, '\0' };
+
+    return m;
+  }
+
+}; // struct Descriptor
+
+
+/// Zapis pól od 'Iter' do 'End' ('Text' - zapisano już pole tekstowe).
+template <class Iter, class End, bool Text>
+struct Writer
+{
+  typedef typename boost::mpl::deref<Iter>::type Field;
+
+  BOOST_STATIC_ASSERT(Field::TEXT || !Text); // parametry liczbowe muszą być przed polami tekstowymi
+
+  template <class A>
+  static void write(fp::Frame &frame, const A &a)
+  {
+    Field::write(frame, a);
+
+    Writer<typename boost::mpl::next<Iter>::type, End, Text || Field::TEXT>::write(frame, a);
+  }
+
+}; // struct Writer
+
+
+template <class End, bool Text>
+struct Writer<End, End, Text>
+{
+  template <class A>
+  static void write(fp::Frame &, const A &) {}
+
+}; // struct Writer
+
+
+/// Ramka rozkazu 'D' z wartościami pól z argumentów 'a'.
+template <class D, class A>
+fp::Frame serialize(const A &a)
+{
+  fp::Frame frame(D::mnemonic(), D::CTRL != 0);
+
+  Writer<typename boost::mpl::begin<typename D::fields>::type,
+    typename boost::mpl::end<typename D::fields>::type, false>::write(frame, a);
+
+  return frame;
+}
+
+
+// Rozkazy $h, $e, $x, $y (paragon)
+
+
+/// Argumenty rozpoczęcia, anulowania i zatwierdzenia transakcji.
+struct TransactionArgs
+{
+  int items;                                  ///< Ilość linii paragonu.
+
+  const fp::EncodedExtraLines *extraLines;    ///< Linie dodatkowe.
+
+  int clientIdType;                           ///< Typ identyfikatora nabywcy (CLIENT_ID_TYPE).
+  const std::string *clientId;                ///< Identyfikator nabywcy.
+
+  const fp::Id *id;                           ///< Numer kasy i kasjer (anulowanie).
+  const fp::EncodedId *encodedId;             ///< Numer kasy i kasjer (zatwierdzenie).
+
+  float cashIn;                               ///< Wpłata.
+  float total;                                ///< Razem.
+
+  int discountType;                           ///< Rabat lub dopłata (TRANSACTION_DISCOUNT_TYPE).
+  float discountValue;                        ///< Wartość rabatu lub dopłaty.
+
+  TransactionArgs() : items(0), extraLines(NULL), clientIdType(0), clientId(NULL), id(NULL), encodedId(NULL),
+    cashIn(0.0), total(0.0), discountType(0), discountValue(0.0) {}
+
+  typedef Member<TransactionArgs, int, &TransactionArgs::items> Items;
+  typedef Pointee<TransactionArgs, fp::EncodedExtraLines, &TransactionArgs::extraLines> ExtraLines;
+  typedef Member<TransactionArgs, int, &TransactionArgs::clientIdType> ClientIdType;
+  typedef Pointee<TransactionArgs, std::string, &TransactionArgs::clientId> ClientId;
+  typedef Pointee<TransactionArgs, fp::Id, &TransactionArgs::id> PlainId;
+  typedef Pointee<TransactionArgs, fp::EncodedId, &TransactionArgs::encodedId> Id;
+  typedef Member<TransactionArgs, float, &TransactionArgs::cashIn> CashIn;
+  typedef Member<TransactionArgs, float, &TransactionArgs::total> Total;
+  typedef Member<TransactionArgs, int, &TransactionArgs::discountType> DiscountType;
+  typedef Member<TransactionArgs, float, &TransactionArgs::discountValue> DiscountValue;
+
+}; // struct TransactionArgs
+
+
+/// Numer kasy (fp::Id::printerId).
+struct PrinterId
+{
+  typedef std::string value_type;
+
+  static const std::string &get(const fp::Id &id) { return id.printerId; }
+
+}; // struct PrinterId
+
+
+/// Kasjer (fp::Id::operatorId).
+struct OperatorId
+{
+  typedef std::string value_type;
+
+  static const std::string &get(const fp::Id &id) { return id.operatorId; }
+
+}; // struct OperatorId
+
+
+/// $h: rozpoczęcie transakcji (pierwsza wersja).
+typedef Descriptor<'$', 'h', boost::mpl::vector<
+  Number<TransactionArgs::Items>
+  > > BeginTransaction;
+
+/// $h: rozpoczęcie transakcji z liniami dodatkowymi (druga wersja).
+typedef Descriptor<'$', 'h', boost::mpl::vector<
+  Number<TransactionArgs::Items>,
+  Number<Count<TransactionArgs::ExtraLines> >,
+  Lines<TransactionArgs::ExtraLines>
+  > > BeginTransactionWithLines;
+
+/// $h: rozpoczęcie transakcji z identyfikatorem nabywcy (trzecia wersja).
+typedef Descriptor<'$', 'h', boost::mpl::vector<
+  Number<TransactionArgs::Items>,
+  Number<Count<TransactionArgs::ExtraLines> >,
+  Constant<0>,
+  Number<TransactionArgs::ClientIdType>,
+  Lines<TransactionArgs::ExtraLines>,
+  Line<TransactionArgs::ClientId>
+  > > BeginTransactionWithClientId;
+
+/// $e: anulowanie transakcji.
+typedef Descriptor<'$', 'e', boost::mpl::vector<
+  Constant<0>
+  > > CancelTransaction;
+
+/// $e: anulowanie transakcji z numerem kasy i kasjerem.
+typedef Descriptor<'$', 'e', boost::mpl::vector<
+  Constant<0>,
+  Line<Compose<TransactionArgs::PlainId, PrinterId> >,
+  Line<Compose<TransactionArgs::PlainId, OperatorId> >
+  > > CancelTransactionWithId;
+
+/// $e: zatwierdzenie transakcji.
+typedef Descriptor<'$', 'e', boost::mpl::vector<
+  Constant<1>,
+  Encoded<Joined<TransactionArgs::Id> >,
+  Amount<TransactionArgs::CashIn>,
+  Amount<TransactionArgs::Total>
+  > > ConfirmTransaction;
+
+/// $e: zatwierdzenie transakcji z liniami dodatkowymi (bez rabatu).
+typedef Descriptor<'$', 'e', boost::mpl::vector<
+  Constant<1>,
+  Constant<0>,                              // rabat 0
+  Number<Count<TransactionArgs::ExtraLines> >,
+  Constant<0>,                              // zakończenie
+  Encoded<Joined<TransactionArgs::Id> >,
+  Lines<TransactionArgs::ExtraLines>,
+  Amount<TransactionArgs::CashIn>,
+  Amount<TransactionArgs::Total>
+  > > ConfirmTransactionWithLines;
+
+/// $e: zatwierdzenie transakcji z rabatem lub dopłatą.
+typedef Descriptor<'$', 'e', boost::mpl::vector<
+  Constant<1>,
+  Number<Count<TransactionArgs::ExtraLines> >,
+  Constant<0>,                              // zakończenie
+  Number<TransactionArgs::DiscountType>,
+  Constant<1>,                              // stała wartość
+  Encoded<Joined<TransactionArgs::Id> >,
+  Lines<TransactionArgs::ExtraLines>,
+  Amount<TransactionArgs::CashIn>,
+  Amount<TransactionArgs::Total>,
+  Amount<TransactionArgs::DiscountValue>
+  > > ConfirmTransactionWithDiscount;
+
+
+/// Argumenty zatwierdzenia transakcji z formami płatności (2).
+struct PaymentForms2Args
+{
+  const fp::EncodedId *id;                    ///< Numer kasy i kasjer.
+
+  const fp::PaymentFormsInfo2 *info;          ///< Formy płatności i kaucje.
+
+  float total;                                ///< Razem.
+
+  int discountType;                           ///< Rabat lub narzut (DISCOUNT_TYPE).
+  float discountValue;                        ///< Wartość rabatu lub narzutu.
+
+  const std::string *sysNr;                   ///< Numer systemowy.
+
+  bool summary;                               ///< Wydruk podsumowania.
+
+  const fp::EncodedExtraLines *extraLines;    ///< Linie dodatkowe.
+
+  PaymentForms2Args() : id(NULL), info(NULL), total(0.0), discountType(0), discountValue(0.0), sysNr(NULL),
+    summary(false), extraLines(NULL) {}
+
+  typedef Pointee<PaymentForms2Args, fp::EncodedId, &PaymentForms2Args::id> Id;
+  typedef Pointee<PaymentForms2Args, fp::PaymentFormsInfo2, &PaymentForms2Args::info> Info;
+  typedef Member<PaymentForms2Args, float, &PaymentForms2Args::total> Total;
+  typedef Member<PaymentForms2Args, int, &PaymentForms2Args::discountType> DiscountType;
+  typedef Member<PaymentForms2Args, float, &PaymentForms2Args::discountValue> DiscountValue;
+  typedef Pointee<PaymentForms2Args, std::string, &PaymentForms2Args::sysNr> SysNr;
+  typedef Member<PaymentForms2Args, bool, &PaymentForms2Args::summary> Summary;
+  typedef Pointee<PaymentForms2Args, fp::EncodedExtraLines, &PaymentForms2Args::extraLines> ExtraLines;
+
+  typedef Compose<Info, Member<fp::PaymentFormsInfo2, bool, &fp::PaymentFormsInfo2::cashFlag> > CashFlag;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo2, bool, &fp::PaymentFormsInfo2::changeFlag> > ChangeFlag;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo2, float, &fp::PaymentFormsInfo2::cashIn> > CashIn;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo2, float, &fp::PaymentFormsInfo2::changeOut> > ChangeOut;
+
+  typedef Compose<Info, Member<fp::PaymentFormsInfo2, fp::PaymentFormsInfo2::PaymentForms,
+    &fp::PaymentFormsInfo2::paymentForms> > PaymentForms;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo2, fp::PaymentFormsInfo2::Deposits,
+    &fp::PaymentFormsInfo2::depositCollected> > DepositCollected;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo2, fp::PaymentFormsInfo2::Deposits,
+    &fp::PaymentFormsInfo2::depositReturned> > DepositReturned;
+
+  typedef Member<fp::PaymentForm, fp::PAYMENT_TYPE, &fp::PaymentForm::type> FormType;
+  typedef Member<fp::PaymentForm, std::string, &fp::PaymentForm::name> FormName;
+  typedef Member<fp::PaymentForm, float, &fp::PaymentForm::amount> FormAmount;
+
+  typedef Member<fp::Deposit, std::string, &fp::Deposit::nr> DepositNr;
+  typedef Member<fp::Deposit, std::string, &fp::Deposit::quantity> DepositQuantity;
+  typedef Member<fp::Deposit, float, &fp::Deposit::amount> DepositAmount;
+
+}; // struct PaymentForms2Args
+
+
+/// $y: zatwierdzenie transakcji z formami płatności (2).
+typedef Descriptor<'$', 'y', boost::mpl::vector28<
+  Number<Count<PaymentForms2Args::ExtraLines> >,
+  Constant<0>,                              // zakończenie
+  Number<PaymentForms2Args::Summary>,
+  Constant<0>,                              // znak DSP (ignorowane)
+  Number<PaymentForms2Args::DiscountType>,
+  Number<Size<PaymentForms2Args::DepositCollected> >,
+  Number<Size<PaymentForms2Args::DepositReturned> >,
+  Number<NotEmpty<PaymentForms2Args::SysNr> >,
+  Number<Size<PaymentForms2Args::PaymentForms> >,
+  Number<PaymentForms2Args::ChangeFlag>,
+  Number<PaymentForms2Args::CashFlag>,
+  Each<PaymentForms2Args::PaymentForms, Number<PaymentForms2Args::FormType> >,
+  Encoded<Split<PaymentForms2Args::Id> >,
+  Line<PaymentForms2Args::SysNr>,
+  Lines<PaymentForms2Args::ExtraLines>,
+  Each<PaymentForms2Args::PaymentForms, Line<PaymentForms2Args::FormName> >,
+  Each<PaymentForms2Args::DepositCollected, Line<PaymentForms2Args::DepositNr> >,
+  Each<PaymentForms2Args::DepositCollected, Line<PaymentForms2Args::DepositQuantity> >,
+  Each<PaymentForms2Args::DepositReturned, Line<PaymentForms2Args::DepositNr> >,
+  Each<PaymentForms2Args::DepositReturned, Line<PaymentForms2Args::DepositQuantity> >,
+  Amount<PaymentForms2Args::Total>,
+  ConstantValue<0>,                         // DSP (ignorowane)
+  Amount<PaymentForms2Args::DiscountValue>,
+  Amount<PaymentForms2Args::CashIn>,
+  Each<PaymentForms2Args::PaymentForms, Amount<PaymentForms2Args::FormAmount> >,
+  Amount<PaymentForms2Args::ChangeOut>,
+  Each<PaymentForms2Args::DepositCollected, Amount<PaymentForms2Args::DepositAmount> >,
+  Each<PaymentForms2Args::DepositReturned, Amount<PaymentForms2Args::DepositAmount> >
+  > > ConfirmTransactionWithPaymentForms2;
+
+
+/// Argumenty zatwierdzenia transakcji z formami płatności (1).
+struct PaymentForms1Args
+{
+  const fp::EncodedId *id;                    ///< Numer kasy i kasjer.
+
+  const fp::PaymentFormsInfo1 *info;          ///< Formy płatności.
+
+  float total;                                ///< Razem.
+
+  int discountType;                           ///< Rabat lub dopłata (TRANSACTION_DISCOUNT_TYPE).
+  float discountValue;                        ///< Wartość rabatu lub dopłaty.
+
+  const fp::EncodedExtraLines *extraLines;    ///< Linie dodatkowe.
+
+  PaymentForms1Args() : id(NULL), info(NULL), total(0.0), discountType(0), discountValue(0.0), extraLines(NULL) {}
+
+  typedef Pointee<PaymentForms1Args, fp::EncodedId, &PaymentForms1Args::id> Id;
+  typedef Pointee<PaymentForms1Args, fp::PaymentFormsInfo1, &PaymentForms1Args::info> Info;
+  typedef Member<PaymentForms1Args, float, &PaymentForms1Args::total> Total;
+  typedef Member<PaymentForms1Args, int, &PaymentForms1Args::discountType> DiscountType;
+  typedef Member<PaymentForms1Args, float, &PaymentForms1Args::discountValue> DiscountValue;
+  typedef Pointee<PaymentForms1Args, fp::EncodedExtraLines, &PaymentForms1Args::extraLines> ExtraLines;
+
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, bool, &fp::PaymentFormsInfo1::cashFlag> > CashFlag;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, bool, &fp::PaymentFormsInfo1::cardFlag> > CardFlag;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, bool, &fp::PaymentFormsInfo1::chequeFlag> > ChequeFlag;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, bool, &fp::PaymentFormsInfo1::couponFlag> > CouponFlag;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, bool,
+    &fp::PaymentFormsInfo1::depositCollectedFlag> > DepositCollectedFlag;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, bool,
+    &fp::PaymentFormsInfo1::depositReturnedFlag> > DepositReturnedFlag;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, bool, &fp::PaymentFormsInfo1::changeFlag> > ChangeFlag;
+
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, std::string, &fp::PaymentFormsInfo1::cardName> > CardName;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, std::string, &fp::PaymentFormsInfo1::chequeName> > ChequeName;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, std::string, &fp::PaymentFormsInfo1::couponName> > CouponName;
+
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, float, &fp::PaymentFormsInfo1::cashIn> > CashIn;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, float, &fp::PaymentFormsInfo1::cardIn> > CardIn;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, float, &fp::PaymentFormsInfo1::chequeIn> > ChequeIn;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, float, &fp::PaymentFormsInfo1::couponIn> > CouponIn;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, float,
+    &fp::PaymentFormsInfo1::depositCollected> > DepositCollected;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, float,
+    &fp::PaymentFormsInfo1::depositReturned> > DepositReturned;
+  typedef Compose<Info, Member<fp::PaymentFormsInfo1, float, &fp::PaymentFormsInfo1::checkOut> > CheckOut;
+
+}; // struct PaymentForms1Args
+
+
+/// $x: zatwierdzenie transakcji z formami płatności (1).
+typedef Descriptor<'$', 'x', boost::mpl::vector25<
+  Number<Count<PaymentForms1Args::ExtraLines> >,
+  Constant<0>,                              // zakończenie
+  Constant<0>,                              // parametr ignorowany
+  Number<PaymentForms1Args::DiscountType>,
+  Number<PaymentForms1Args::CashFlag>,
+  Number<PaymentForms1Args::CardFlag>,
+  Number<PaymentForms1Args::ChequeFlag>,
+  Number<PaymentForms1Args::CouponFlag>,
+  Number<PaymentForms1Args::DepositCollectedFlag>,
+  Number<PaymentForms1Args::DepositReturnedFlag>,
+  Number<PaymentForms1Args::ChangeFlag>,
+  Encoded<Joined<PaymentForms1Args::Id> >,
+  Lines<PaymentForms1Args::ExtraLines, 5>,  // pięć pól, puste uzupełniają brakujące linie
+  Line<PaymentForms1Args::CardName>,
+  Line<PaymentForms1Args::ChequeName>,
+  Line<PaymentForms1Args::CouponName>,
+  Amount<PaymentForms1Args::Total>,
+  Amount<PaymentForms1Args::DiscountValue>,
+  Amount<PaymentForms1Args::CashIn>,
+  Amount<PaymentForms1Args::CardIn>,
+  Amount<PaymentForms1Args::ChequeIn>,
+  Amount<PaymentForms1Args::CouponIn>,
+  Amount<PaymentForms1Args::DepositCollected>,
+  Amount<PaymentForms1Args::DepositReturned>,
+  Amount<PaymentForms1Args::CheckOut>
+  > > ConfirmTransactionWithPaymentForms1;
+
+
+// Rozkazy $h, $e, @c (faktura)
+
+
+/// Pola fp::BeginInvoiceData (argumentem rozkazu jest sama struktura).
+struct BeginInvoiceArgs
+{
+  typedef fp::BeginInvoiceData Data;
+
+  typedef Member<Data, int, &Data::items> Items;
+  typedef Member<Data, bool, &Data::printCopy> PrintCopy;
+  typedef Member<Data, bool, &Data::topMargin> TopMargin;
+  typedef Member<Data, bool, &Data::signature> Signature;
+  typedef Member<Data, int, &Data::additionalCopies> AdditionalCopies;
+  typedef Member<Data, std::string, &Data::invoiceNr> InvoiceNr;
+  typedef Member<Data, std::string, &Data::nip> Nip;
+  typedef Member<Data, std::string, &Data::timeout> Timeout;
+  typedef Member<Data, std::string, &Data::paymentForm> PaymentFormName;
+  typedef Member<Data, std::string, &Data::client> Client;
+  typedef Member<Data, std::string, &Data::seller> Seller;
+  typedef Member<Data, std::string, &Data::systemNr> SystemNr;
+  typedef Member<Data, Data::ClientLines, &Data::clientLines> ClientLines;
+
+}; // struct BeginInvoiceArgs
+
+
+/// $h: rozpoczęcie faktury.
+typedef Descriptor<'$', 'h', boost::mpl::vector18<
+  Number<BeginInvoiceArgs::Items>,
+  Number<Size<BeginInvoiceArgs::ClientLines> >,
+  Constant<1>,                              // stała
+  Number<BeginInvoiceArgs::PrintCopy>,
+  Number<BeginInvoiceArgs::TopMargin>,
+  Constant<0>,                              // parametr ignorowany
+  Number<BeginInvoiceArgs::AdditionalCopies>,
+  Constant<0>,                              // parametr ignorowany
+  Constant<0>,                              // parametr ignorowany
+  Number<BeginInvoiceArgs::Signature>,
+  Line<BeginInvoiceArgs::InvoiceNr>,
+  Each<BeginInvoiceArgs::ClientLines, Line<Value<std::string> > >,
+  Line<BeginInvoiceArgs::Nip>,
+  Line<BeginInvoiceArgs::Timeout>,
+  Line<BeginInvoiceArgs::PaymentFormName>,
+  Line<BeginInvoiceArgs::Client>,
+  Line<BeginInvoiceArgs::Seller>,
+  Line<BeginInvoiceArgs::SystemNr>
+  > > BeginInvoice;
+
+
+/// Argumenty zakończenia faktury.
+struct FinishInvoiceArgs
+{
+  const fp::EncodedId *id;                    ///< Numer kasy i kasjer.
+
+  const fp::FinishInvoiceData *data;          ///< Dane zakończenia faktury.
+
+  FinishInvoiceArgs() : id(NULL), data(NULL) {}
+
+  typedef fp::FinishInvoiceData Data;
+
+  typedef Pointee<FinishInvoiceArgs, fp::EncodedId, &FinishInvoiceArgs::id> Id;
+  typedef Pointee<FinishInvoiceArgs, Data, &FinishInvoiceArgs::data> Info;
+
+  typedef Compose<Info, Member<Data, bool, &Data::payedFlag> > PayedFlag;
+  typedef Compose<Info, Member<Data, std::string, &Data::payed> > Payed;
+  typedef Compose<Info, Member<Data, fp::CLIENT_SELLER_OPTION, &Data::client> > Client;
+  typedef Compose<Info, Member<Data, fp::CLIENT_SELLER_OPTION, &Data::seller> > Seller;
+  typedef Compose<Info, Member<Data, float, &Data::cashIn> > CashIn;
+  typedef Compose<Info, Member<Data, float, &Data::total> > Total;
+  typedef Compose<Info, Member<Data, float, &Data::discountValue> > DiscountValue;
+  typedef Compose<Info, Member<Data, std::string, &Data::clientName> > ClientName;
+  typedef Compose<Info, Member<Data, std::string, &Data::sellerName> > SellerName;
+  typedef Compose<Info, Member<Data, fp::ExtraLines, &Data::extraLines> > ExtraLines;
+
+}; // struct FinishInvoiceArgs
+
+
+/// $e: zakończenie faktury.
+typedef Descriptor<'$', 'e', boost::mpl::vector17<
+  Constant<1>,                              // zatwierdzenie
+  Constant<0>,                              // parametr ignorowany
+  Number<Count<FinishInvoiceArgs::ExtraLines> >,
+  Constant<0>,                              // parametr ignorowany
+  Constant<0>,                              // parametr ignorowany
+  Constant<1>,                              // stała wartość
+  Number<FinishInvoiceArgs::PayedFlag>,
+  Number<FinishInvoiceArgs::Client>,
+  Number<FinishInvoiceArgs::Seller>,
+  Encoded<Joined<FinishInvoiceArgs::Id> >,
+  Lines<FinishInvoiceArgs::ExtraLines>,
+  Line<FinishInvoiceArgs::Payed>,
+  Line<FinishInvoiceArgs::ClientName>,
+  Line<FinishInvoiceArgs::SellerName>,
+  Amount<FinishInvoiceArgs::CashIn>,
+  Amount<FinishInvoiceArgs::Total>,
+  Amount<FinishInvoiceArgs::DiscountValue>
+  > > FinishInvoice;
+
+
+/// Pola fp::InvoiceOptions (argumentem rozkazu jest sama struktura).
+struct InvoiceOptionsArgs
+{
+  typedef fp::InvoiceOptions Data;
+
+  typedef Member<Data, int, &Data::additionalCopies> AdditionalCopies;
+  typedef Member<Data, fp::CLIENT_SELLER_OPTION, &Data::client> Client;
+  typedef Member<Data, fp::CLIENT_SELLER_OPTION, &Data::seller> Seller;
+  typedef Member<Data, bool, &Data::payedFlag> PayedFlag;
+  typedef Member<Data, int, &Data::year> Year;
+  typedef Member<Data, int, &Data::month> Month;
+  typedef Member<Data, int, &Data::day> Day;
+  typedef Member<Data, int, &Data::summaryOption> SummaryOption;
+  typedef Member<Data, int, &Data::invoiceOptions2> InvoiceOptions2;
+  typedef Member<Data, fp::CLIENT_ID_TYPE, &Data::clientIdType> ClientIdType;
+  typedef Member<Data, int, &Data::invoiceOptions3> InvoiceOptions3;
+  typedef Member<Data, std::string, &Data::timeout> Timeout;
+  typedef Member<Data, std::string, &Data::paymentForm> PaymentFormName;
+  typedef Member<Data, std::string, &Data::clientName> ClientName;
+  typedef Member<Data, std::string, &Data::sellerName> SellerName;
+  typedef Member<Data, std::string, &Data::systemNr> SystemNr;
+
+}; // struct InvoiceOptionsArgs
+
+
+/// @c: opcje faktury.
+typedef Descriptor<'@', 'c', boost::mpl::vector16<
+  Number<InvoiceOptionsArgs::AdditionalCopies>,
+  Number<InvoiceOptionsArgs::Client>,
+  Number<InvoiceOptionsArgs::Seller>,
+  Number<InvoiceOptionsArgs::PayedFlag>,
+  Number<InvoiceOptionsArgs::Year>,
+  Number<InvoiceOptionsArgs::Month>,
+  Number<InvoiceOptionsArgs::Day>,
+  Number<InvoiceOptionsArgs::SummaryOption>,
+  Number<InvoiceOptionsArgs::InvoiceOptions2>,
+  Number<InvoiceOptionsArgs::ClientIdType>,
+  Number<InvoiceOptionsArgs::InvoiceOptions3>,
+  Line<InvoiceOptionsArgs::Timeout>,
+  Line<InvoiceOptionsArgs::PaymentFormName>,
+  Line<InvoiceOptionsArgs::ClientName>,
+  Line<InvoiceOptionsArgs::SellerName>,
+  Line<InvoiceOptionsArgs::SystemNr>
+  > > SetInvoiceOption;
+
+
+// Rozkazy $w (wydruk niefiskalny)
+
+
+/// Argumenty rozpoczęcia i zakończenia wydruku niefiskalnego.
+struct NonFiscalArgs
+{
+  int printNr;                                ///< Numer wydruku.
+  int headerNr;                               ///< Numer nagłówka (rozpoczęcie).
+
+  const std::string *sysNr;                   ///< Numer systemowy (zakończenie).
+  const fp::ExtraLines *extraLines;           ///< Linie dodatkowe (zakończenie).
+
+  NonFiscalArgs() : printNr(0), headerNr(0), sysNr(NULL), extraLines(NULL) {}
+
+  typedef Member<NonFiscalArgs, int, &NonFiscalArgs::printNr> PrintNr;
+  typedef Member<NonFiscalArgs, int, &NonFiscalArgs::headerNr> HeaderNr;
+  typedef Pointee<NonFiscalArgs, std::string, &NonFiscalArgs::sysNr> SysNr;
+  typedef Pointee<NonFiscalArgs, fp::ExtraLines, &NonFiscalArgs::extraLines> ExtraLines;
+
+}; // struct NonFiscalArgs
+
+
+/// Pola fp::NonFiscalLine (argumentem rozkazu jest sama struktura).
+struct NonFiscalLineArgs
+{
+  typedef fp::NonFiscalLine Data;
+
+  typedef Member<Data, int, &Data::printNr> PrintNr;
+  typedef Member<Data, int, &Data::lineNr> LineNr;
+  typedef Member<Data, bool, &Data::bold> Bold;
+  typedef Member<Data, bool, &Data::inverse> Inverse;
+  typedef Member<Data, int, &Data::font> Font;
+  typedef Member<Data, bool, &Data::center> Center;
+  typedef Member<Data, fp::FONT_ATTRS, &Data::attrs> Attrs;
+  typedef Member<Data, std::vector<std::string>, &Data::lines> Lines;
+
+}; // struct NonFiscalLineArgs
+
+
+/// $w: rozpoczęcie wydruku niefiskalnego.
+typedef Descriptor<'$', 'w', boost::mpl::vector<
+  Constant<0>,                              // stała
+  Number<NonFiscalArgs::PrintNr>,
+  Number<NonFiscalArgs::HeaderNr>
+  > > BeginNonFiscal;
+
+/// $w: linia wydruku niefiskalnego.
+typedef Descriptor<'$', 'w', boost::mpl::vector<
+  Number<NonFiscalLineArgs::PrintNr>,
+  Number<NonFiscalLineArgs::LineNr>,
+  Number<NonFiscalLineArgs::Bold>,
+  Number<NonFiscalLineArgs::Inverse>,
+  Number<NonFiscalLineArgs::Font>,
+  Number<NonFiscalLineArgs::Center>,
+  Number<NonFiscalLineArgs::Attrs>,
+  Each<NonFiscalLineArgs::Lines, Line<Value<std::string> > >
+  > > PrintNonFiscal;
+
+/// $w: zakończenie wydruku niefiskalnego.
+typedef Descriptor<'$', 'w', boost::mpl::vector<
+  Constant<1>,                              // stała
+  Number<NonFiscalArgs::PrintNr>,
+  Number<NotEmpty<NonFiscalArgs::SysNr> >,
+  Number<Count<NonFiscalArgs::ExtraLines> >,
+  Line<NonFiscalArgs::SysNr>,
+  Lines<NonFiscalArgs::ExtraLines>
+  > > FinishNonFiscal;
+
+
+// Rozkazy $p, #p, #q (konfiguracja i kasjer)
+
+
+/// Argumenty ustawienia stawek PTU.
+struct VatRatesArgs
+{
+  typedef fp::StaticVector<float, fp::VatTable::SIZE> Values;
+
+  int count;                                  ///< Ilość stawek (parametr rozkazu).
+
+  const fp::Id *id;                           ///< Numer kasy i kasjer.
+
+  Values rates;                               ///< Stawki wysyłane w ramce.
+
+  VatRatesArgs() : count(0), id(NULL) {}
+
+  typedef Member<VatRatesArgs, int, &VatRatesArgs::count> RateCount;
+  typedef Pointee<VatRatesArgs, fp::Id, &VatRatesArgs::id> Id;
+  typedef Member<VatRatesArgs, Values, &VatRatesArgs::rates> Rates;
+
+}; // struct VatRatesArgs
+
+
+/// $p: ustawienie stawek PTU.
+typedef Descriptor<'$', 'p', boost::mpl::vector<
+  Number<VatRatesArgs::RateCount>,
+  Each<VatRatesArgs::Rates, Amount<Value<float> > >
+  > > SetVatRates;
+
+/// $p: ustawienie stawek PTU z numerem kasy i kasjerem.
+typedef Descriptor<'$', 'p', boost::mpl::vector<
+  Number<VatRatesArgs::RateCount>,
+  Line<Compose<VatRatesArgs::Id, PrinterId> >,
+  Line<Compose<VatRatesArgs::Id, OperatorId> >,
+  Each<VatRatesArgs::Rates, Amount<Value<float> > >
+  > > SetVatRatesWithId;
+
+/// #p: logowanie kasjera (argumentem rozkazu jest fp::Id).
+typedef Descriptor<'#', 'p', boost::mpl::vector<
+  Constant<0>,                              // parametr ignorowany
+  Line<OperatorId>,
+  Line<PrinterId>
+  > > Login;
+
+/// #q: wylogowanie kasjera (argumentem rozkazu jest fp::Id).
+typedef Descriptor<'#', 'q', boost::mpl::vector<
+  Constant<0>,                              // parametr ignorowany
+  Line<OperatorId>,
+  Line<PrinterId>
+  > > Logout;
+
+
+} // namespace command
+
+
+} // namespace fp
+
+
+#endif // __FP_COMMAND_HPP__
@@ -32,8 +32,11 @@
 #include <iomanip>
 #include <exception>
 
+#include <boost/cstdint.hpp>
+
 #include <boost/asio.hpp>
 #include <boost/asio/serial_port.hpp>
+#include <boost/asio/spawn.hpp>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/foreach.hpp>
@@ -43,6 +46,8 @@
 #include <boost/spirit/include/classic_common.hpp>
 #include <boost/spirit/include/classic_core.hpp>
 
+#include <fiscal-printer/StaticVector.hpp>
+
 
 namespace fp
 {
@@ -326,6 +331,18 @@ enum CASH_REGISTER_INFO_2_MODE
 }; // enum CASH_REGISTER_INFO_2_MODE
 
 
+/// Stan drukarki śledzony przez bibliotekę (FiscalPrinter::setStateTracking).
+enum TRANSACTION_STATE
+{
+  TS_UNKNOWN    = 0, ///< Nieznany (po otwarciu portu lub po błędzie), ustalany z CashRegisterInfo6::transaction.
+  TS_IDLE       = 1, ///< Brak transakcji.
+  TS_RECEIPT    = 2, ///< Paragon.
+  TS_INVOICE    = 3, ///< Faktura VAT.
+  TS_NON_FISCAL = 4  ///< Wydruk niefiskalny.
+
+}; // enum TRANSACTION_STATE
+
+
 enum CASH_REGISTER_INFO_6_MODE
 {
   CRI6M_0 = 0, ///< Odsyłane kwoty brutto.
@@ -629,6 +646,55 @@ struct Id
 }; // struct Id
 
 
+/// Ustawienia portu szeregowego zmniejszające opóźnienia (konwertery USB/RS232).
+struct SerialOptions
+{
+  bool lowLatency;  ///< Ustawienie flagi ASYNC_LOW_LATENCY sterownika (TIOCSSERIAL).
+
+  int latencyTimer; ///< Opóźnienie konwertera FTDI w milisekundach <1;255> (sysfs 'latency_timer'), 0 - bez zmian.
+                    ///< Domyślnie konwerter FTDI czeka 16 ms przed wysłaniem niepełnego pakietu.
+
+  bool userFlowControl; ///< XON/XOFF obsługiwane przez bibliotekę zamiast sterownika (FiscalPrinter::isFlowStopped).
+
+  int stallTimeout; ///< Maksymalny czas wstrzymania nadawania przez XOFF w milisekundach, 0 - bez ograniczenia.
+                    ///< Po przekroczeniu zapis kończy się wyjątkiem boost::system::system_error (ETIMEDOUT).
+                    ///< Działa tylko w trybie blokującym (nie we współprogramie).
+
+  SerialOptions() : lowLatency(false), latencyTimer(0), userFlowControl(false), stallTimeout(0) {}
+
+  /// Zalecane ustawienia: ASYNC_LOW_LATENCY, opóźnienie FTDI 1 ms.
+  static SerialOptions lowLatencyDefaults()
+  {
+    SerialOptions options;
+
+    options.lowLatency = true;
+    options.latencyTimer = 1;
+
+    return options;
+  }
+
+}; // struct SerialOptions
+
+
+/// Ustawienia portu szeregowego zastosowane przy otwarciu.
+struct SerialSettings
+{
+  bool lowLatency;              ///< Flaga ASYNC_LOW_LATENCY jest ustawiona.
+
+  int latencyTimer;             ///< Opóźnienie konwertera FTDI w milisekundach (-1, jeśli nie dotyczy lub nieznane).
+  std::string latencyTimerPath; ///< Plik sysfs opóźnienia konwertera (pusty, jeśli nie dotyczy).
+
+  bool userFlowControl;         ///< XON/XOFF obsługiwane przez bibliotekę.
+  int stallTimeout;             ///< Maksymalny czas wstrzymania nadawania w milisekundach.
+
+  std::vector<std::string> errors; ///< Ustawienia, których nie udało się zastosować.
+
+  SerialSettings() : lowLatency(false), latencyTimer(-1), userFlowControl(false),
+    stallTimeout(0) {}
+
+}; // struct SerialSettings
+
+
 /// Informacje o wersji oprogramowania.
 struct VersionInfo
 {
@@ -727,6 +793,144 @@ struct ServiceDate
 }; // struct ServiceDate
 
 
+/// Wartości dla stawek PTU A - G (stawki podatkowe lub stany totalizerów).
+/**
+    Wartości są przechowywane w setnych częściach (grosze, setne części procenta), więc sumy
+    i różnice totalizerów (n.p. między dwoma odczytami) są dokładne.
+
+    VatTable::size to ilość wartości odesłanych przez drukarkę (od stawki A), a VatTable::mask
+    określa, które stawki są używane (dla stawek podatkowych stawka VAT_DISABLED nie jest używana,
+    patrz VatTable::excludeDisabled).
+ */
+struct VatTable
+{
+  enum { SIZE = 7 }; ///< Ilość stawek PTU (A - G).
+
+  boost::int64_t values[SIZE]; ///< Wartości w setnych częściach (indeks 0 - stawka A).
+
+  unsigned int mask;           ///< Bit 'i' - stawka 'i' jest używana.
+
+  int size;                    ///< Ilość wartości odesłanych przez drukarkę.
+
+  VatTable() : mask(0), size(0) { std::fill(values, values + SIZE, 0); }
+
+  /// Indeks stawki ('A' - 0, ..., 'G' - 6), -1 dla nieprawidłowej litery.
+  static int index(char letter) { return letter >= 'A' && letter < 'A' + SIZE ? letter - 'A' : -1; }
+
+  /// Litera stawki o danym indeksie.
+  static char letter(int i) { return (char)('A' + i); }
+
+  /// Wartość w setnych częściach.
+  static boost::int64_t toFixed(double value) { return (boost::int64_t)(value < 0.0 ? value * 100.0 - 0.5 : value * 100.0 + 0.5); }
+
+  /// Stawka o danym indeksie jest używana.
+  bool isUsed(int i) const { return i >= 0 && i < SIZE && (mask & (1U << i)) != 0; }
+
+  /// Ilość używanych stawek.
+  int count() const
+  {
+    int n = 0;
+
+    for (int i = 0; i < SIZE; ++i)
+    {
+      n += isUsed(i) ? 1 : 0;
+    }
+
+    return n;
+  }
+
+  /// Wartość dla stawki o danym indeksie (0.0 poza zakresem).
+  double get(int i) const { return i >= 0 && i < SIZE ? values[i] / 100.0 : 0.0; }
+
+  /// Ustawienie wartości dla stawki o danym indeksie (stawka staje się używana).
+  void set(int i, double value)
+  {
+    if (i < 0 || i >= SIZE)
+    {
+      throw std::out_of_range("VatTable::set");
+    }
+
+    values[i] = toFixed(value);
+    mask |= 1U << i;
+
+    size = std::max(size, i + 1);
+  }
+
+  /// Dopisanie wartości dla kolejnej stawki (akcja parsera push_back_a).
+  void push_back(double value)
+  {
+    if (size >= SIZE)
+    {
+      throw std::length_error("VatTable::push_back");
+    }
+
+    set(size, value);
+  }
+
+  /// Oznaczenie stawek VAT_DISABLED jako nieużywanych (dla tablic stawek podatkowych).
+  void excludeDisabled()
+  {
+    for (int i = 0; i < SIZE; ++i)
+    {
+      if (values[i] == toFixed(VAT_DISABLED))
+      {
+        mask &= ~(1U << i);
+      }
+    }
+  }
+
+  /// Suma wartości w setnych częściach.
+  boost::int64_t sum() const
+  {
+    boost::int64_t total = 0;
+
+    for (int i = 0; i < SIZE; ++i)
+    {
+      total += values[i];
+    }
+
+    return total;
+  }
+
+  /// Suma wartości.
+  double total() const { return sum() / 100.0; }
+
+  VatTable &operator+=(const VatTable &other)
+  {
+    for (int i = 0; i < SIZE; ++i)
+    {
+      values[i] += other.values[i];
+    }
+
+    mask |= other.mask;
+    size = std::max(size, other.size);
+
+    return *this;
+  }
+
+  VatTable &operator-=(const VatTable &other)
+  {
+    for (int i = 0; i < SIZE; ++i)
+    {
+      values[i] -= other.values[i];
+    }
+
+    mask |= other.mask;
+    size = std::max(size, other.size);
+
+    return *this;
+  }
+
+  VatTable operator+(const VatTable &other) const { VatTable result = *this; return result += other; }
+  VatTable operator-(const VatTable &other) const { VatTable result = *this; return result -= other; }
+
+  /// Porównanie wartości i maski.
+  bool operator==(const VatTable &other) const { return mask == other.mask && std::equal(values, values + SIZE, other.values); }
+  bool operator!=(const VatTable &other) const { return !(*this == other); }
+
+}; // struct VatTable
+
+
 /// Informacje kasowe (tryb 0-21).
 struct CashRegisterInfo1
 {
@@ -742,32 +946,19 @@ struct CashRegisterInfo1
   int month;          ///< Data ostatniego zapisu do pamięci fiskalnej: miesiąc.
   int day;            ///< Data ostatniego zapisu do pamięci fiskalnej: dzień.
 
-  float vatA;         ///< Stawka podatkowa PTU A.
-  float vatB;         ///< Stawka podatkowa PTU B.
-  float vatC;         ///< Stawka podatkowa PTU C.
-  float vatD;         ///< Stawka podatkowa PTU D.
-  float vatE;         ///< Stawka podatkowa PTU E.
-  float vatF;         ///< Stawka podatkowa PTU F.
+  VatTable vat;       ///< Stawki podatkowe PTU A - F.
 
   int reciepts;       ///< Ilość wydrukowanych paragonów fiskalnych (licznik jest zerowany
                       ///< w trakcie zerowania RAM).
 
-  float totA;         ///< Stan totalizera dla stawki PTU A (kwota brutto).
-  float totB;         ///< Stan totalizera dla stawki PTU B (kwota brutto).
-  float totC;         ///< Stan totalizera dla stawki PTU C (kwota brutto).
-  float totD;         ///< Stan totalizera dla stawki PTU D (kwota brutto).
-  float totE;         ///< Stan totalizera dla stawki PTU E (kwota brutto).
-  float totF;         ///< Stan totalizera dla stawki PTU F (kwota brutto).
-  float totG;         ///< Stan totalizera dla stawki PTU G (kwota brutto).
+  VatTable totals;    ///< Stany totalizerów dla stawek PTU A - G (kwoty brutto).
 
   float cash;         ///< Stan gotówki w kasie (w PLN lub w EURO).
 
   std::string number; ///< Numer unikatowy w formacie ABCNNNNNNNN.
 
   CashRegisterInfo1() : lastError(0), fiscal(false), transaction(false), transactionOk(false),
-    ramResets(0), year(0), month(0), day(0), vatA(0.0), vatB(0.0), vatC(0.0), vatD(0.0), vatE(0.0),
-    vatF(0.0), totA(0.0), totB(0.0), totC(0.0), totD(0.0), totE(0.0), totF(0.0), totG(0.0),
-    cash(0.0) {}
+    ramResets(0), year(0), month(0), day(0), reciepts(0), cash(0.0) {}
 
 }; // struct CashRegisterInfo1
 
@@ -787,33 +978,19 @@ struct CashRegisterInfo2
   int month;          ///< Data ostatniego zapisu do pamięci fiskalnej: miesiąc.
   int day;            ///< Data ostatniego zapisu do pamięci fiskalnej: dzień.
 
-  float vatA;         ///< Stawka podatkowa PTU A.
-  float vatB;         ///< Stawka podatkowa PTU B.
-  float vatC;         ///< Stawka podatkowa PTU C.
-  float vatD;         ///< Stawka podatkowa PTU D.
-  float vatE;         ///< Stawka podatkowa PTU E.
-  float vatF;         ///< Stawka podatkowa PTU F.
-  float vatG;         ///< Stawka podatkowa PTU G.
+  VatTable vat;       ///< Stawki podatkowe PTU A - G.
 
   int reciepts;       ///< Ilość wydrukowanych paragonów fiskalnych (licznik jest zerowany
                       ///< w trakcie zerowania RAM).
 
-  float totA;         ///< Stan totalizera dla stawki PTU A (kwota brutto).
-  float totB;         ///< Stan totalizera dla stawki PTU B (kwota brutto).
-  float totC;         ///< Stan totalizera dla stawki PTU C (kwota brutto).
-  float totD;         ///< Stan totalizera dla stawki PTU D (kwota brutto).
-  float totE;         ///< Stan totalizera dla stawki PTU E (kwota brutto).
-  float totF;         ///< Stan totalizera dla stawki PTU F (kwota brutto).
-  float totG;         ///< Stan totalizera dla stawki PTU G (kwota brutto).
+  VatTable totals;    ///< Stany totalizerów dla stawek PTU A - G (kwoty brutto).
 
   float cash;         ///< Stan gotówki w kasie (w PLN lub w EURO).
 
   std::string number; ///< Numer unikatowy w formacie ABCNNNNNNNN.
 
   CashRegisterInfo2() : lastError(0), fiscal(false), transaction(false), transactionOk(false),
-    resets(0), year(0), month(0), day(0), vatA(0.0), vatB(0.0), vatC(0.0), vatD(0.0), vatE(0.0),
-    vatF(0.0), vatG(0.0), totA(0.0), totB(0.0), totC(0.0), totD(0.0), totE(0.0), totF(0.0), totG(0.0),
-    cash(0.0) {}
+    resets(0), year(0), month(0), day(0), reciepts(0), cash(0.0) {}
 
 }; // struct CashRegisterInfo2
 
@@ -830,16 +1007,9 @@ struct CashRegisterInfo3
 
   int locked;      ///< Ilość towarów zablokowanych.
 
-  float totA;      ///< Stan totalizera _ostatniego_ _paragonu_ dla stawki PTU A (kwota brutto).
-  float totB;      ///< Stan totalizera _ostatniego_ _paragonu_ dla stawki PTU B (kwota brutto).
-  float totC;      ///< Stan totalizera _ostatniego_ _paragonu_ dla stawki PTU C (kwota brutto).
-  float totD;      ///< Stan totalizera _ostatniego_ _paragonu_ dla stawki PTU D (kwota brutto).
-  float totE;      ///< Stan totalizera _ostatniego_ _paragonu_ dla stawki PTU E (kwota brutto).
-  float totF;      ///< Stan totalizera _ostatniego_ _paragonu_ dla stawki PTU F (kwota brutto).
-  float totG;      ///< Stan totalizera _ostatniego_ _paragonu_ dla stawki PTU G (kwota brutto).
+  VatTable totals; ///< Stany totalizerów _ostatniego_ _paragonu_ dla stawek PTU A - G (kwoty brutto).
 
-  CashRegisterInfo3() : year(0), month(0), day(0), usedReports(0), freeReports(0), locked(),
-    totA(0.0), totB(0.0), totC(0.0), totD(0.0), totE(0.0), totF(0.0), totG(0.0) {}
+  CashRegisterInfo3() : year(0), month(0), day(0), usedReports(0), freeReports(0), locked() {}
 
 }; // struct CashRegisterInfo3
 
@@ -884,16 +1054,9 @@ struct CashRegisterInfo6
 
   float total;     ///< Suma wartości totalizarów.
 
-  float totA;      ///< Stan totalizera dla stawki PTU A.
-  float totB;      ///< Stan totalizera dla stawki PTU B.
-  float totC;      ///< Stan totalizera dla stawki PTU C.
-  float totD;      ///< Stan totalizera dla stawki PTU D.
-  float totE;      ///< Stan totalizera dla stawki PTU E.
-  float totF;      ///< Stan totalizera dla stawki PTU F.
-  float totG;      ///< Stan totalizera dla stawki PTU G.
+  VatTable totals; ///< Stany totalizerów dla stawek PTU A - G.
 
-  CashRegisterInfo6() : type(0), transaction(0), total(0.0), totA(0.0), totB(0.0), totC(0.0),
-    totD(0.0), totE(0.0), totF(0.0), totG(0.0) {}
+  CashRegisterInfo6() : type(0), transaction(0), total(0.0) {}
 
 }; // struct CashRegisterInfo6
 
@@ -908,6 +1071,30 @@ struct CashRegisterInfo7
 }; // struct CashRegisterInfo7
 
 
+/// Stan drukarki odczytany w jednej wymianie (FiscalPrinter::getSnapshot).
+struct PrinterSnapshot
+{
+  boost::posix_time::ptime timestamp;    ///< Czas wysłania rozkazów (UTC).
+
+  long duration;                         ///< Czas od wysłania rozkazów do odczytania ostatniej odpowiedzi w mikrosekundach.
+
+  CashRegisterInfo1 cashRegisterInfo1;   ///< Informacje kasowe (1).
+  CashRegisterInfo2 cashRegisterInfo2;   ///< Informacje kasowe (2).
+  CashRegisterInfo3 cashRegisterInfo3;   ///< Informacje kasowe (3).
+  CashRegisterInfo4 cashRegisterInfo4;   ///< Informacje kasowe (4).
+  CashRegisterInfo6 cashRegisterInfo6;   ///< Informacje kasowe (6).
+
+  ClockInfo clock;                       ///< Zegar.
+
+  VersionInfo versionInfo;               ///< Typ i wersja oprogramowania.
+
+  DeviceInfo2 deviceInfo2;               ///< Informacje o urządzeniu (2).
+
+  PrinterSnapshot() : duration(0) {}
+
+}; // struct PrinterSnapshot
+
+
 /// Rekord pamięci fiskalnej
 struct FiscalMemoryRecord
 {
@@ -948,16 +1135,9 @@ struct DailyReportRecord : public FiscalMemoryRecord
   int databaseChanges;          ///< Ilość zmian w bazie towarowej.
   float cancelledReceiptsValue; ///< Wartość anulowanych paragonów.
 
-  float totA;                   ///< Stan totalizera dla stawki PTU A.
-  float totB;                   ///< Stan totalizera dla stawki PTU B.
-  float totC;                   ///< Stan totalizera dla stawki PTU C.
-  float totD;                   ///< Stan totalizera dla stawki PTU D.
-  float totE;                   ///< Stan totalizera dla stawki PTU E.
-  float totF;                   ///< Stan totalizera dla stawki PTU F.
-  float totG;                   ///< Stan totalizera dla stawki PTU G.
+  VatTable totals;              ///< Stany totalizerów dla stawek PTU A - G.
 
-  DailyReportRecord() : receipts(0), cancelledReceipts(0), databaseChanges(0), cancelledReceiptsValue(0.0),
-    totA(0.0), totB(0.0), totC(0.0), totD(0.0), totE(0.0), totF(0.0), totG(0.0) {}
+  DailyReportRecord() : receipts(0), cancelledReceipts(0), databaseChanges(0), cancelledReceiptsValue(0.0) {}
   virtual ~DailyReportRecord() {}
 
 }; // struct DailyReportRecord
@@ -968,15 +1148,9 @@ struct VatChangeRecord : public FiscalMemoryRecord
 {
   virtual RECORD_TYPE getType() const { return FiscalMemoryRecord::RT_VAT_CHANGE_REPORT; }
 
-  float vatA; ///< Stawka podatkowa PTU A.
-  float vatB; ///< Stawka podatkowa PTU B.
-  float vatC; ///< Stawka podatkowa PTU C.
-  float vatD; ///< Stawka podatkowa PTU D.
-  float vatE; ///< Stawka podatkowa PTU E.
-  float vatF; ///< Stawka podatkowa PTU F.
-  float vatG; ///< Stawka podatkowa PTU G.
+  VatTable vat; ///< Stawki podatkowe PTU A - G.
 
-  VatChangeRecord() : vatA(0.0), vatB(0.0), vatC(0.0), vatD(0.0), vatE(0.0), vatF(0.0), vatG(0.0) {}
+  VatChangeRecord() {}
   virtual ~VatChangeRecord() {}
 
 }; // struct VatChangeRecord
@@ -1063,6 +1237,52 @@ struct Item
 }; // struct Item
 
 
+/// Kompletny paragon (rozpoczęcie, linie, zatwierdzenie).
+struct Receipt
+{
+  std::string receiptId;   ///< Identyfikator paragonu nadany przez aplikację (n.p. numer w bazie POS).
+
+  Id id;                   ///< Identyfikator kasy/kasjera.
+
+  std::vector<Item> items; ///< Linie paragonu.
+
+  ExtraLines extraLines;   ///< Dodatkowe linie w stopce paragonu.
+
+  float cashIn;            ///< Kwota wpłacona przez klienta (jeżeli 0, to napisy 'wpłata/reszta' nie będą drukowane).
+  float total;             ///< Łączna należność.
+
+  Receipt() : cashIn(0.0), total(0.0) {}
+
+}; // struct Receipt
+
+
+/// Zakodowana linia paragonu (rozkaz $l lub ^l) bez numeru linii, ilości i kwoty brutto.
+/**
+    Ramka linii ma postać: <numer linii> head <ilość> middle <kwota brutto> tail <bajt kontrolny>.
+    Części stałe są zakodowane (Mazovia) przy tworzeniu szablonu, ich XOR jest policzony z góry.
+
+    @see FiscalPrinter::makeItemTemplate
+ */
+struct ItemTemplate
+{
+  std::string head;   ///< Bajty po numerze linii, przed ilością.
+  std::string middle; ///< Bajty po ilości, przed kwotą brutto.
+  std::string tail;   ///< Bajty po kwocie brutto.
+
+  char ctrl;          ///< XOR części stałych.
+
+  float price;        ///< Cena jednostkowa zakodowana w szablonie.
+
+  int vat;            ///< Indeks stawki PTU (VatTable::index), -1 dla nieprawidłowej stawki.
+
+  ITEM_DISCOUNT_TYPE discountType; ///< Rodzaj rabatu zakodowanego w szablonie.
+  float discountValue;             ///< Kwota lub procent rabatu/dopłaty zakodowanego w szablonie.
+
+  ItemTemplate() : ctrl(0), price(0.0), vat(-1), discountType(IDT_0), discountValue(0.0) {}
+
+}; // struct ItemTemplate
+
+
 /// Dane form płatności (1).
 struct PaymentFormsInfo1
 {
@@ -1114,6 +1334,11 @@ struct Deposit
 
 
 /// Dane form płatności (2).
+/**
+    @note Formy płatności i kaucje są przechowywane wewnątrz obiektu (fp::StaticVector), konstruktor
+          tworzy wszystkie 80 elementów (z pustymi napisami). Dodawanie nie alokuje kontenera,
+          ale napisy nazw i numerów kaucji mogą alokować pamięć.
+ */
 struct PaymentFormsInfo2
 {
   bool cashFlag;                         ///< Flaga 'Wpłata'.
@@ -1122,10 +1347,16 @@ struct PaymentFormsInfo2
   float cashIn;                          ///< Wpłata.
   float changeOut;                       ///< Reszta.
 
-  std::vector<PaymentForm> paymentForms; ///< Formy płatności (maksymalnie 16).
+  static const std::size_t MAX_PAYMENT_FORMS = 16; ///< Maksymalna ilość form płatności.
+  static const std::size_t MAX_DEPOSITS = 32;      ///< Maksymalna ilość kaucji pobranych (i osobno zwróconych).
 
-  std::vector<Deposit> depositCollected;   ///< Kaucje pobrane (maksymalnie 32).
-  std::vector<Deposit> depositReturned;    ///< Kaucje zwrócone (maksymalnie 32).
+  typedef fp::StaticVector<PaymentForm, MAX_PAYMENT_FORMS> PaymentForms;
+  typedef fp::StaticVector<Deposit, MAX_DEPOSITS> Deposits;
+
+  PaymentForms paymentForms;             ///< Formy płatności (maksymalnie 16).
+
+  Deposits depositCollected;             ///< Kaucje pobrane (maksymalnie 32).
+  Deposits depositReturned;              ///< Kaucje zwrócone (maksymalnie 32).
 
   PaymentFormsInfo2() : cashFlag(false), changeFlag(false), cashIn(0.0), changeOut(0.0) {}
 
@@ -1159,7 +1390,11 @@ struct BeginInvoiceData
 
   std::string systemNr;                 ///< Numer systemowy, rozpoczyna się znakiem # (maksymalnie 30 znaków).
 
-  std::vector<std::string> clientLines; ///< Linie danych odbiorcy (maksymalnie 8). Linie powinny zawierać dane odbiorcy faktury.
+  static const std::size_t MAX_CLIENT_LINES = 8; ///< Maksymalna ilość linii danych odbiorcy.
+
+  typedef fp::StaticVector<std::string, MAX_CLIENT_LINES> ClientLines;
+
+  ClientLines clientLines;              ///< Linie danych odbiorcy (maksymalnie 8). Linie powinny zawierać dane odbiorcy faktury.
 
   BeginInvoiceData() : items(0), printCopy(false), topMargin(false), signature(false), additionalCopies(0) {}
 
@@ -1293,6 +1528,23 @@ struct NonFiscalLine
 }; // struct NonFiscalLine
 
 
+/// Kompletny wydruk niefiskalny (rozpoczęcie, linie, zakończenie).
+struct NonFiscalDocument
+{
+  int printNr;                        ///< Numer wydruku (z dokumentacji).
+  int headerNr;                       ///< Numer nagłówka (z dokumentacji).
+
+  std::vector<NonFiscalLine> lines;   ///< Linie wydruku.
+
+  std::string sysNr;                  ///< Numer systemowy.
+
+  ExtraLines extraLines;              ///< Dodatkowe linie.
+
+  NonFiscalDocument() : printNr(0), headerNr(0) {}
+
+}; // struct NonFiscalDocument
+
+
 } // namespace fp
 
 
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/DisplayChannel.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+#include <boost/bind.hpp>
+
+
+using namespace fp;
+using namespace std;
+using namespace boost;
+
+
+DisplayChannel::DisplayChannel(Scheduler &s, int i, SCHEDULER_PRIORITY p) : scheduler(s), minInterval(i),
+  priority(p), hasPending(false), hasShown(false), inFlight(false), running(false), sent(0), skipped(0),
+  thread(NULL)
+{
+}
+
+
+DisplayChannel::~DisplayChannel()
+{
+  stop();
+}
+
+
+void DisplayChannel::start()
+{
+  if (thread != NULL)
+  {
+    return;
+  }
+
+  running = true;
+
+  thread = new boost::thread(boost::bind(&DisplayChannel::run, this));
+}
+
+
+void DisplayChannel::stop()
+{
+  if (thread == NULL)
+  {
+    return;
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    running = false;
+  }
+
+  condition.notify_all();
+
+  thread->join();
+
+  delete thread;
+  thread = NULL;
+
+  // rozkaz w kolejce Scheduler'a odwołuje się do kanału
+
+  boost::unique_lock<boost::mutex> lock(mutex);
+
+  while (inFlight)
+  {
+    condition.wait(lock);
+  }
+}
+
+
+void DisplayChannel::setMessage(const string &message)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    if (hasPending)
+    {
+      ++skipped; // poprzedni napis nie zdążył zostać wysłany
+    }
+
+    pending = message;
+    hasPending = true;
+  }
+
+  condition.notify_all();
+}
+
+
+string DisplayChannel::getShown() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return shown;
+}
+
+
+unsigned long DisplayChannel::getSent() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return sent;
+}
+
+
+unsigned long DisplayChannel::getSkipped() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return skipped;
+}
+
+
+void DisplayChannel::run()
+{
+  boost::unique_lock<boost::mutex> lock(mutex);
+
+  while (running)
+  {
+    if (!hasPending || inFlight)
+    {
+      condition.wait(lock);
+
+      continue;
+    }
+
+    if (hasShown && pending == shown)
+    {
+      ++skipped;
+
+      hasPending = false;
+
+      continue;
+    }
+
+    // ograniczenie częstotliwości odświeżania wyświetlacza
+
+    boost::system_time next = lastSent + boost::posix_time::milliseconds(minInterval);
+
+    if (hasShown && boost::get_system_time() < next)
+    {
+      condition.timed_wait(lock, next);
+
+      continue;
+    }
+
+    inFlight = true;
+
+    lock.unlock();
+
+    scheduler.submit(priority, Scheduler::Step(boost::bind(&DisplayChannel::send, this, _1)),
+      boost::bind(&DisplayChannel::finished, this, _1, _2));
+
+    lock.lock();
+  }
+}
+
+
+void DisplayChannel::send(FiscalPrinter &printer)
+{
+  string message;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    // napis pobierany w chwili wysyłania, więc wysyłany jest zawsze najnowszy
+
+    if (!hasPending || (hasShown && pending == shown))
+    {
+      if (hasPending)
+      {
+        ++skipped;
+      }
+
+      hasPending = false;
+
+      return;
+    }
+
+    message = pending;
+    hasPending = false;
+  }
+
+  printer.setDisplayMessage(message);
+
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  shown = message;
+  hasShown = true;
+
+  ++sent;
+}
+
+
+void DisplayChannel::finished(bool ok, const string &error)
+{
+  (void)ok;
+  (void)error;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    inFlight = false;
+
+    lastSent = boost::get_system_time();
+  }
+
+  condition.notify_all();
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_DISPLAY_CHANNEL_HPP__
+#define __FP_DISPLAY_CHANNEL_HPP__
+
+
+#include <fiscal-printer/Scheduler.hpp>
+
+#include <boost/thread.hpp>
+
+
+namespace fp
+{
+
+
+/// Kanał wyświetlacza klienta.
+/**
+    Przechowuje tylko ostatni napis zlecony do wyświetlenia. Napis jest wysyłany przez
+    Scheduler nie częściej niż co 'minInterval' milisekund, napisy nadpisane przed wysłaniem
+    są pomijane. Napis równy aktualnie wyświetlanemu nie jest wysyłany.
+
+    @note Kanał należy zatrzymać przed zatrzymaniem Scheduler'a.
+ */
+class DisplayChannel
+{
+
+public:
+
+  /// Konstruktor.
+  /**
+      @param scheduler Scheduler drukarki
+      @param minInterval Minimalny odstęp między rozkazami wyświetlacza (w milisekundach)
+      @param priority Klasa priorytetu rozkazów wyświetlacza
+   */
+  DisplayChannel(fp::Scheduler &scheduler, int minInterval = 200, fp::SCHEDULER_PRIORITY priority = fp::SP_NORMAL);
+  ~DisplayChannel();
+
+  /// Uruchomienie wątku kanału.
+  void start();
+
+  /// Zatrzymanie wątku kanału.
+  /**
+      @note Metoda czeka na wykonanie rozkazu przekazanego do Scheduler'a.
+   */
+  void stop();
+
+  /// Zlecenie wyświetlenia napisu.
+  /**
+      @note Metoda nie czeka na drukarkę.
+   */
+  void setMessage(const std::string &message);
+
+  /// Napis aktualnie wyświetlany (ostatnio wysłany do drukarki).
+  std::string getShown() const;
+
+  /// Ilość napisów wysłanych do drukarki.
+  unsigned long getSent() const;
+
+  /// Ilość napisów pominiętych (nadpisanych przed wysłaniem lub równych wyświetlanemu).
+  unsigned long getSkipped() const;
+
+private:
+
+  void run();
+
+  void send(fp::FiscalPrinter &printer);
+  void finished(bool ok, const std::string &error);
+
+  fp::Scheduler &scheduler;
+
+  int minInterval;
+
+  fp::SCHEDULER_PRIORITY priority;
+
+  std::string pending;
+  std::string shown;
+
+  bool hasPending;
+  bool hasShown;
+  bool inFlight;
+  bool running;
+
+  unsigned long sent;
+  unsigned long skipped;
+
+  boost::system_time lastSent;
+
+  mutable boost::mutex mutex;
+  boost::condition_variable condition;
+
+  boost::thread *thread;
+
+}; // class DisplayChannel
+
+
+} // namespace fp
+
+
+#endif // __FP_DISPLAY_CHANNEL_HPP__
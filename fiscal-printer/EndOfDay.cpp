@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#include <fiscal-printer/EndOfDay.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+#include <fiscal-printer/Validator.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+
+using namespace fp;
+using namespace std;
+
+
+namespace
+{
+
+/// Kroki, od których zależy dany krok (bit 'i' - krok 'i').
+const unsigned int DEPENDENCIES[END_OF_DAY_STEPS] =
+{
+  0,                                                 // EODS_LOGOUT
+  0,                                                 // EODS_TOTALS
+  1U << EODS_LOGOUT,                                 // EODS_SHIFT_REPORT
+  (1U << EODS_SHIFT_REPORT) | (1U << EODS_TOTALS),   // EODS_DAILY_REPORT
+  1U << EODS_DAILY_REPORT,                           // EODS_FISCAL_MEMORY
+  (1U << EODS_FISCAL_MEMORY) | (1U << EODS_TOTALS)   // EODS_RECONCILE
+};
+
+
+long elapsed(const boost::posix_time::ptime &start)
+{
+  return (long)(boost::posix_time::microsec_clock::universal_time() - start).total_milliseconds();
+}
+
+} // namespace
+
+
+EndOfDay::EndOfDay() : attempts(3), delay(1000)
+{
+}
+
+
+void EndOfDay::addPrinter(const string &name, FiscalPrinter &printer, const Id &id, const string &shift,
+  const Recovery &recovery)
+{
+  Entry entry;
+
+  entry.printer = &printer;
+  entry.id = id;
+  entry.shift = shift;
+  entry.recovery = recovery;
+
+  entry.report.name = name;
+
+  entries.push_back(entry);
+}
+
+
+void EndOfDay::setRetries(int a, int d)
+{
+  attempts = a < 1 ? 1 : a;
+  delay = d;
+}
+
+
+vector<EndOfDayReport> EndOfDay::run()
+{
+  boost::thread_group threads;
+
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    threads.create_thread(boost::bind(&EndOfDay::runPrinter, this, boost::ref(entries[i])));
+  }
+
+  threads.join_all();
+
+  return getReports();
+}
+
+
+vector<EndOfDayReport> EndOfDay::getReports() const
+{
+  vector<EndOfDayReport> reports;
+
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    reports.push_back(entries[i].report);
+  }
+
+  return reports;
+}
+
+
+bool EndOfDay::isComplete() const
+{
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    if (!entries[i].report.isComplete())
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+void EndOfDay::reset()
+{
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    EndOfDayReport report;
+
+    report.name = entries[i].report.name;
+
+    entries[i].report = report;
+  }
+}
+
+
+const char *EndOfDay::getStepName(END_OF_DAY_STEP step)
+{
+  switch (step)
+  {
+  case EODS_LOGOUT:        return "Wylogowanie kasjera";
+  case EODS_TOTALS:        return "Odczyt totalizerów";
+  case EODS_SHIFT_REPORT:  return "Raport zmiany";
+  case EODS_DAILY_REPORT:  return "Raport dobowy";
+  case EODS_FISCAL_MEMORY: return "Odczyt pamięci fiskalnej";
+  case EODS_RECONCILE:     return "Uzgodnienie totalizerów";
+  }
+
+  return "";
+}
+
+
+void EndOfDay::runPrinter(Entry &entry)
+{
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+  // kroki są ponumerowane w kolejności zależności
+
+  for (int i = 0; i < END_OF_DAY_STEPS; ++i)
+  {
+    EndOfDayStepResult &result = entry.report.steps[i];
+
+    if (result.state == EODSS_DONE)
+    {
+      continue;
+    }
+
+    bool ready = true;
+
+    for (int j = 0; j < END_OF_DAY_STEPS; ++j)
+    {
+      if ((DEPENDENCIES[i] & (1U << j)) && entry.report.steps[j].state != EODSS_DONE)
+      {
+        ready = false;
+
+        result.state = EODSS_SKIPPED;
+        result.error = PrinterError();
+        result.message = string("Nie wykonano kroku: ") + getStepName((END_OF_DAY_STEP)j);
+
+        break;
+      }
+    }
+
+    if (ready)
+    {
+      runStep(entry, (END_OF_DAY_STEP)i);
+    }
+  }
+
+  entry.report.duration = elapsed(start);
+}
+
+
+void EndOfDay::runStep(Entry &entry, END_OF_DAY_STEP step)
+{
+  EndOfDayStepResult &result = entry.report.steps[step];
+
+  for (int attempt = 0; attempt < attempts; ++attempt)
+  {
+    if (attempt > 0 && delay > 0)
+    {
+      boost::this_thread::sleep(boost::posix_time::milliseconds(delay));
+    }
+
+    boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+    ++result.attempts;
+
+    bool ioError = false;
+
+    try
+    {
+      int code = perform(entry, step);
+
+      result.error = PrinterError(code);
+      result.message = code == 0 ? string() : result.error.toString();
+    }
+    catch (const PrinterException &e)
+    {
+      result.error = e.getError();
+      result.message = e.what();
+    }
+    catch (const boost::system::system_error &e)
+    {
+      result.error = PrinterError();
+      result.message = e.what();
+
+      ioError = true;
+    }
+    catch (const std::exception &e)
+    {
+      result.error = PrinterError();
+      result.message = e.what();
+    }
+
+    result.duration = elapsed(start);
+
+    if (result.message.empty())
+    {
+      result.state = EODSS_DONE;
+
+      return;
+    }
+
+    result.state = EODSS_FAILED;
+
+    if (ioError && entry.recovery && !entry.recovery(*entry.printer))
+    {
+      return; // połączenie nie zostało odtworzone
+    }
+  }
+}
+
+
+int EndOfDay::perform(Entry &entry, END_OF_DAY_STEP step)
+{
+  FiscalPrinter &printer = *entry.printer;
+
+  EndOfDayReport &report = entry.report;
+
+  switch (step)
+  {
+  case EODS_LOGOUT:
+  {
+    printer.logout(entry.id);
+
+    return printer.getLastError().code;
+  }
+
+  case EODS_TOTALS:
+  {
+    report.totals = printer.getCashRegisterInfo2(CRI2M_23, false);
+
+    return 0;
+  }
+
+  case EODS_SHIFT_REPORT:
+  {
+    printer.printShiftReport(entry.id, true, entry.shift);
+
+    return printer.getLastError().code;
+  }
+
+  case EODS_DAILY_REPORT:
+  {
+    printer.printDailyReport(entry.id);
+
+    return printer.getLastError().code;
+  }
+
+  case EODS_FISCAL_MEMORY:
+  {
+    // ostatni rekord raportu dobowego z dzisiejszą datą
+
+    ClockInfo clock = printer.getClock();
+
+    printer.beginFiscalMemoryReadByDate(clock.year, clock.month, clock.day, 0, 0, 0);
+
+    report.dailyReportFound = false;
+
+    FiscalMemoryRecord *record;
+
+    while ((record = printer.getFiscalMemoryRecord()) != NULL)
+    {
+      if (record->getType() == FiscalMemoryRecord::RT_DAILY_REPORT)
+      {
+        report.dailyReport = *static_cast<DailyReportRecord *>(record);
+        report.dailyReportFound = true;
+      }
+
+      delete record;
+    }
+
+    return report.dailyReportFound ? 0 : 1025; // brak danych raportu w podanym zakresie
+  }
+
+  case EODS_RECONCILE:
+  {
+    report.difference = report.dailyReport.totals - report.totals.totals;
+
+    report.reconciled = true;
+
+    for (int i = 0; i < VatTable::SIZE; ++i)
+    {
+      report.reconciled = report.reconciled && report.difference.values[i] == 0;
+    }
+
+    return 0;
+  }
+  }
+
+  return 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#ifndef __FP_END_OF_DAY_HPP__
+#define __FP_END_OF_DAY_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+#include <boost/function.hpp>
+
+
+namespace fp
+{
+
+
+class FiscalPrinter;
+
+
+/// Krok zamknięcia dnia (w kolejności wykonywania).
+enum END_OF_DAY_STEP
+{
+  EODS_LOGOUT        = 0, ///< Wylogowanie kasjera (FiscalPrinter::logout).
+  EODS_TOTALS        = 1, ///< Odczyt totalizerów od ostatniego raportu dobowego (CRI2M_23).
+  EODS_SHIFT_REPORT  = 2, ///< Raport zmiany zerujący (FiscalPrinter::printShiftReport), po EODS_LOGOUT.
+  EODS_DAILY_REPORT  = 3, ///< Raport dobowy (FiscalPrinter::printDailyReport), po EODS_SHIFT_REPORT i EODS_TOTALS.
+  EODS_FISCAL_MEMORY = 4, ///< Odczyt rekordu raportu dobowego z pamięci fiskalnej, po EODS_DAILY_REPORT.
+  EODS_RECONCILE     = 5  ///< Porównanie rekordu raportu dobowego z totalizerami, po EODS_FISCAL_MEMORY i EODS_TOTALS.
+
+}; // enum END_OF_DAY_STEP
+
+
+const int END_OF_DAY_STEPS = 6; ///< Ilość kroków zamknięcia dnia.
+
+
+/// Stan kroku zamknięcia dnia.
+enum END_OF_DAY_STEP_STATE
+{
+  EODSS_PENDING = 0, ///< Krok nie był wykonywany.
+  EODSS_DONE    = 1, ///< Krok został wykonany.
+  EODSS_FAILED  = 2, ///< Krok zakończył się błędem (po wszystkich próbach).
+  EODSS_SKIPPED = 3  ///< Krok nie został wykonany, bo nie wykonano kroku, od którego zależy.
+
+}; // enum END_OF_DAY_STEP_STATE
+
+
+/// Wynik kroku zamknięcia dnia.
+struct EndOfDayStepResult
+{
+  fp::END_OF_DAY_STEP_STATE state; ///< Stan.
+
+  int attempts;                    ///< Ilość prób (łącznie z poprzednimi wywołaniami EndOfDay::run).
+
+  fp::PrinterError error;          ///< Kod błędu drukarki (0, jeśli krok zakończył się wyjątkiem bez kodu).
+  std::string message;             ///< Opis błędu.
+
+  long duration;                   ///< Czas ostatniej próby w milisekundach.
+
+  EndOfDayStepResult() : state(EODSS_PENDING), attempts(0), duration(0) {}
+
+}; // struct EndOfDayStepResult
+
+
+/// Wynik zamknięcia dnia jednej drukarki.
+struct EndOfDayReport
+{
+  std::string name;                            ///< Nazwa drukarki (EndOfDay::addPrinter).
+
+  fp::EndOfDayStepResult steps[END_OF_DAY_STEPS]; ///< Wyniki kroków (indeks - END_OF_DAY_STEP).
+
+  fp::CashRegisterInfo2 totals;                ///< Informacje kasowe (CRI2M_23) odczytane przed raportem dobowym.
+
+  fp::DailyReportRecord dailyReport;           ///< Rekord raportu dobowego z pamięci fiskalnej.
+  bool dailyReportFound;                       ///< Rekord raportu dobowego został odczytany.
+
+  fp::VatTable difference;                     ///< Różnica totalizerów: raport dobowy - CRI2M_23.
+  bool reconciled;                             ///< Totalizery raportu dobowego są zgodne z CRI2M_23.
+
+  long duration;                               ///< Czas ostatniego wywołania EndOfDay::run w milisekundach.
+
+  EndOfDayReport() : dailyReportFound(false), reconciled(false), duration(0) {}
+
+  /// Wszystkie kroki zostały wykonane.
+  bool isComplete() const
+  {
+    for (int i = 0; i < END_OF_DAY_STEPS; ++i)
+    {
+      if (steps[i].state != EODSS_DONE)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+}; // struct EndOfDayReport
+
+
+/// Zamknięcie dnia na wielu drukarkach.
+/**
+    Kroki (END_OF_DAY_STEP) są wykonywane dla każdej drukarki w osobnym wątku, więc czas zamknięcia
+    dnia zależy od najwolniejszej drukarki, a nie od sumy czasów. Krok, który zakończył się błędem,
+    jest powtarzany (EndOfDay::setRetries), a kroki od niego zależne są pomijane (EODSS_SKIPPED).
+    Kolejne wywołanie EndOfDay::run wykonuje tylko kroki, które nie zostały wykonane.
+
+    @code
+    fp::EndOfDay endOfDay;
+
+    endOfDay.addPrinter("kasa 1", printer1, id1, "ZMIANA1");
+    endOfDay.addPrinter("kasa 2", printer2, id2, "ZMIANA1",
+      boost::bind(&fp::ReconnectSupervisor::recover, &supervisor2, _1));
+
+    std::vector<fp::EndOfDayReport> reports = endOfDay.run();
+
+    if (!endOfDay.isComplete())
+    {
+      // usunięcie przyczyny (n.p. brak papieru) i wykonanie pozostałych kroków
+      reports = endOfDay.run();
+    }
+    @endcode
+
+    @note Totalizery CRI2M_23 są odczytywane przed raportem dobowym, który je zeruje.
+
+    @note Raport dobowy przerwany błędem wejścia/wyjścia mógł zostać wydrukowany. Ponowna próba
+          kończy się wtedy błędem drukarki (n.p. 35 - zerowe totalizery sprzedaży).
+
+    @note W czasie EndOfDay::run wątki zamknięcia dnia mają wyłączny dostęp do drukarek (n.p.
+          Scheduler i Spool powinny być zatrzymane).
+ */
+class EndOfDay
+{
+
+public:
+
+  typedef boost::function<bool (fp::FiscalPrinter &)> Recovery;
+
+  EndOfDay();
+
+  /// Dodanie drukarki.
+  /**
+      @param name Nazwa drukarki w raporcie
+      @param printer Drukarka (port musi być otwarty)
+      @param id Identyfikator kasy/kasjera
+      @param shift Nazwa zmiany dla raportu zmiany
+      @param recovery Funkcja odtwarzająca połączenie po błędzie wejścia/wyjścia (n.p. ReconnectSupervisor::recover)
+   */
+  void addPrinter(const std::string &name, fp::FiscalPrinter &printer, const fp::Id &id, const std::string &shift,
+    const Recovery &recovery = Recovery());
+
+  /// Ustawienie ilości prób każdego kroku.
+  /**
+      @param attempts Ilość prób w jednym wywołaniu EndOfDay::run (co najmniej 1)
+      @param delay Przerwa między próbami w milisekundach
+   */
+  void setRetries(int attempts, int delay = 1000);
+
+  /// Wykonanie (lub dokończenie) zamknięcia dnia na wszystkich drukarkach.
+  /**
+      @return Wyniki w kolejności dodania drukarek
+
+      @note Metoda czeka na zakończenie wszystkich wątków.
+   */
+  std::vector<fp::EndOfDayReport> run();
+
+  /// Wyniki ostatniego wywołania EndOfDay::run.
+  std::vector<fp::EndOfDayReport> getReports() const;
+
+  /// Wszystkie kroki zostały wykonane na wszystkich drukarkach.
+  bool isComplete() const;
+
+  /// Rozpoczęcie zamknięcia dnia od początku (wszystkie kroki oczekują na wykonanie).
+  void reset();
+
+  /// Nazwa kroku.
+  static const char *getStepName(fp::END_OF_DAY_STEP step);
+
+private:
+
+  struct Entry
+  {
+    fp::FiscalPrinter *printer;
+
+    fp::Id id;
+    std::string shift;
+
+    Recovery recovery;
+
+    fp::EndOfDayReport report;
+
+  }; // struct Entry
+
+  void runPrinter(Entry &entry);
+
+  void runStep(Entry &entry, fp::END_OF_DAY_STEP step);
+
+  static int perform(Entry &entry, fp::END_OF_DAY_STEP step);
+
+  std::vector<Entry> entries;
+
+  int attempts;
+  int delay;
+
+}; // class EndOfDay
+
+
+} // namespace fp
+
+
+#endif // __FP_END_OF_DAY_HPP__
@@ -23,6 +23,25 @@
 
 
 #include <fiscal-printer/FiscalPrinter.hpp>
+#include <fiscal-printer/Command.hpp>
+#include <fiscal-printer/Journal.hpp>
+#include <fiscal-printer/SalesJournal.hpp>
+#include <fiscal-printer/Validator.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <linux/serial.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
 
 
 using namespace fp;
@@ -32,7 +51,16 @@ using namespace boost::asio;
 using namespace boost::spirit::classic;
 
 
-FiscalPrinter::FiscalPrinter() : io(NULL), port(NULL)
+FiscalPrinter::FiscalPrinter() : io(NULL), port(NULL), ownIo(true), yield(NULL), stallTime(0),
+  transactionStallStart(0), extraLinesCheck(false), extraLinesStored(false), validation(false), stateTracking(false),
+  state(TS_UNKNOWN), nonFiscal(false), cashierLoggedIn(false), journal(NULL), salesJournal(NULL)
+{
+}
+
+
+FiscalPrinter::FiscalPrinter(io_service &i) : io(&i), port(NULL), ownIo(false), yield(NULL), stallTime(0),
+  transactionStallStart(0), extraLinesCheck(false), extraLinesStored(false), validation(false), stateTracking(false),
+  state(TS_UNKNOWN), nonFiscal(false), cashierLoggedIn(false), journal(NULL), salesJournal(NULL)
 {
 }
 
@@ -45,9 +73,12 @@ FiscalPrinter::~FiscalPrinter()
 
 void FiscalPrinter::open(const string &device, int baudRate)
 {
-  if (io == NULL && port == NULL)
+  if (port == NULL)
   {
-    io = new io_service();
+    if (io == NULL)
+    {
+      io = new io_service();
+    }
 
     port = new serial_port(*io, device);
 
@@ -56,7 +87,182 @@ void FiscalPrinter::open(const string &device, int baudRate)
     port->set_option<>(serial_port::stop_bits(serial_port::stop_bits::one));
     port->set_option<>(serial_port::flow_control(serial_port::flow_control::software));
     port->set_option<>(serial_port::character_size(8));
+
+    serialSettings = SerialSettings();
+
+    state = TS_UNKNOWN; // ustalany z CashRegisterInfo6 przed pierwszym sprawdzanym rozkazem
+    cashierLoggedIn = false;
+  }
+}
+
+
+void FiscalPrinter::open(const string &device, int baudRate, const SerialOptions &options)
+{
+  if (port == NULL)
+  {
+    open(device, baudRate);
+
+    applySerialOptions(device, options);
+  }
+}
+
+
+int FiscalPrinter::openAutoBaud(const string &device, const vector<int> &baudRates, int timeout,
+  const SerialOptions &options)
+{
+  vector<int> rates = baudRates.empty() ? defaultBaudRates() : baudRates;
+
+  if (rates.empty())
+  {
+    return 0;
+  }
+
+  close();
+
+  open(device, rates[0], options);
+
+  for (size_t i = 0; i < rates.size(); ++i)
+  {
+    port->set_option<>(serial_port::baud_rate(rates[i]));
+
+    if (probe(timeout))
+    {
+      return rates[i];
+    }
   }
+
+  close();
+
+  return 0;
+}
+
+
+vector<int> FiscalPrinter::defaultBaudRates()
+{
+  vector<int> rates;
+
+  rates.push_back(115200);
+  rates.push_back(57600);
+  rates.push_back(38400);
+  rates.push_back(19200);
+  rates.push_back(9600);
+
+  return rates;
+}
+
+
+bool FiscalPrinter::probe(int timeout)
+{
+  if (!isOpen())
+  {
+    return false;
+  }
+
+  int fd = port->native_handle();
+
+  resetDecoder();
+
+  ::tcflush(fd, TCIOFLUSH);
+
+  // przy niezgodnej prędkości odbierane są przypadkowe bajty, które mogą trafić w zakres statusu,
+  // dlatego wymagane są dwie czyste odpowiedzi z rzędu
+
+  return probeEnq(fd, timeout) && probeEnq(fd, timeout);
+}
+
+
+bool FiscalPrinter::probeEnq(int fd, int timeout)
+{
+  const long QUIET_TIME = 20; // ms ciszy po bajcie statusu
+
+  writeOneByte('\x05');
+
+  boost::posix_time::ptime deadline = boost::posix_time::microsec_clock::universal_time() +
+    boost::posix_time::milliseconds(timeout);
+
+  bool status = false;
+
+  while (true)
+  {
+    long left = (long)(deadline - boost::posix_time::microsec_clock::universal_time()).total_milliseconds();
+
+    if (left <= 0)
+    {
+      return status;
+    }
+
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int r = ::poll(&pfd, 1, status ? (int)std::min(left, QUIET_TIME) : (int)left);
+
+    if (r < 0 && errno == EINTR)
+    {
+      continue;
+    }
+
+    if (r == 0 && status)
+    {
+      return true; // pojedynczy bajt statusu, po nim cisza
+    }
+
+    if (r <= 0)
+    {
+      return false;
+    }
+
+    char buffer[16];
+
+    ssize_t n = ::read(fd, buffer, sizeof(buffer));
+
+    if (n < 0 && (errno == EAGAIN || errno == EINTR))
+    {
+      continue;
+    }
+
+    if (n <= 0)
+    {
+      return false;
+    }
+
+    // odpowiedź na ENQ to dokładnie jeden bajt statusu, każdy inny bajt oznacza zakłócenia
+
+    if (status || n != 1 || buffer[0] < 0x60 || buffer[0] > 0x6F)
+    {
+      return false;
+    }
+
+    status = true;
+  }
+}
+
+
+SerialSettings FiscalPrinter::getSerialSettings() const
+{
+  return serialSettings;
+}
+
+
+long FiscalPrinter::measureEnqRoundTrip(int probes)
+{
+  if (probes <= 0)
+  {
+    return 0;
+  }
+
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+  for (int i = 0; i < probes; ++i)
+  {
+    getEnqStatus();
+  }
+
+  boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - start;
+
+  return (long)(elapsed.total_microseconds() / probes);
 }
 
 
@@ -73,8 +279,244 @@ void FiscalPrinter::close()
   delete port;
   port = NULL;
 
-  delete io;
-  io = NULL;
+  resetDecoder();
+
+  state = TS_UNKNOWN;
+
+  if (ownIo)
+  {
+    delete io;
+    io = NULL;
+  }
+}
+
+
+FiscalPrinter::AsyncScope::AsyncScope(FiscalPrinter &p, yield_context y) : printer(p), yield(y),
+  previous(p.yield)
+{
+  printer.yield = &yield;
+}
+
+
+FiscalPrinter::AsyncScope::~AsyncScope()
+{
+  printer.yield = previous;
+}
+
+
+io_service &FiscalPrinter::getIoService()
+{
+  return *io;
+}
+
+
+bool FiscalPrinter::isOpen() const
+{
+  return port != NULL && port->is_open();
+}
+
+
+void FiscalPrinter::setJournal(Journal *j)
+{
+  journal = j;
+}
+
+
+void FiscalPrinter::setSalesJournal(SalesJournal *j)
+{
+  salesJournal = j;
+}
+
+
+void FiscalPrinter::setSalesJournalErrorHandler(const SalesJournalErrorHandler &handler)
+{
+  salesJournalErrorHandler = handler;
+}
+
+
+FrameDecoderStats FiscalPrinter::getFrameDecoderStats() const
+{
+  return decoder.getStats();
+}
+
+
+bool FiscalPrinter::isFlowStopped() const
+{
+  return decoder.isStopped();
+}
+
+
+void FiscalPrinter::pollFlowControl()
+{
+  if (!isOpen())
+  {
+    return;
+  }
+
+  struct pollfd pfd;
+
+  pfd.fd = port->native_handle();
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  while (::poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN))
+  {
+    receive();
+  }
+}
+
+
+void FiscalPrinter::setFlowControlHandler(const FlowControlHandler &handler)
+{
+  flowControlHandler = handler;
+}
+
+
+long FiscalPrinter::getStallTime() const
+{
+  long result = stallTime;
+
+  if (decoder.isStopped())
+  {
+    result += (long)(boost::posix_time::microsec_clock::universal_time() - stallStart).total_microseconds();
+  }
+
+  return result;
+}
+
+
+long FiscalPrinter::getTransactionStallTime() const
+{
+  return getStallTime() - transactionStallStart;
+}
+
+
+void FiscalPrinter::setValidation(bool enabled)
+{
+  validation = enabled;
+}
+
+
+void FiscalPrinter::setStateTracking(bool enabled)
+{
+  stateTracking = enabled;
+  state = TS_UNKNOWN;
+  nonFiscal = false;
+}
+
+
+TRANSACTION_STATE FiscalPrinter::getState() const
+{
+  return stateTracking ? state : TS_UNKNOWN;
+}
+
+
+bool FiscalPrinter::isCashierLoggedIn() const
+{
+  return cashierLoggedIn;
+}
+
+
+TRANSACTION_STATE FiscalPrinter::syncState()
+{
+  getCashRegisterInfo6(CRI6M_0);
+
+  return state;
+}
+
+
+void FiscalPrinter::updateState(const CashRegisterInfo6 &info)
+{
+  if (nonFiscal && info.transaction == 0) // wydruk niefiskalny nie jest widoczny w odpowiedzi
+  {
+    state = TS_NON_FISCAL;
+  }
+  else
+  {
+    state = transactionState(info.transaction);
+    nonFiscal = false;
+  }
+}
+
+
+void FiscalPrinter::addSale(const string &vat, boost::int64_t amount)
+{
+  addSale(vat.size() == 1 ? VatTable::index(vat[0]) : -1, amount);
+}
+
+
+void FiscalPrinter::addSale(int vat, boost::int64_t amount)
+{
+  if (vat < 0 || vat >= VatTable::SIZE)
+  {
+    return;
+  }
+
+  sale.values[vat] += amount;
+  sale.mask |= 1U << vat;
+  sale.size = VatTable::SIZE;
+}
+
+
+void FiscalPrinter::recordSale()
+{
+  VatTable totals = sale;
+
+  sale = VatTable();
+
+  if (salesJournal == NULL)
+  {
+    return;
+  }
+
+  // odrzucone zatwierdzenie (n.p. błędna suma) nie może trafić do dziennika
+
+  EnqStatus status = getEnqStatus();
+
+  if (status.transaction || !status.transactionOk)
+  {
+    return;
+  }
+
+  // paragon jest już wydrukowany, błąd zapisu nie może wyglądać jak błąd zatwierdzenia
+
+  try
+  {
+    salesJournal->append(totals);
+  }
+  catch (const boost::system::system_error &e)
+  {
+    salesJournalError(e);
+  }
+}
+
+
+void FiscalPrinter::salesJournalError(const boost::system::system_error &e)
+{
+  if (salesJournalErrorHandler)
+  {
+    salesJournalErrorHandler(e);
+  }
+}
+
+
+TRANSACTION_STATE FiscalPrinter::transactionState(int transaction)
+{
+  switch (transaction)
+  {
+  case 0:  return TS_IDLE;
+  case 1:  return TS_RECEIPT;
+  case 17: return TS_RECEIPT; // paragon w trybie blokowym off-line
+  case 19: return TS_INVOICE;
+  default: return TS_UNKNOWN;
+  }
+}
+
+
+void FiscalPrinter::setExtraLinesCheck(bool enabled)
+{
+  extraLinesCheck = enabled;
+  extraLinesStored = false;
 }
 
 
@@ -92,6 +534,8 @@ void FiscalPrinter::cancel()
 
 EnqStatus FiscalPrinter::getEnqStatus()
 {
+  decoder.clearStatus(); // status odebrany przed wysłaniem ENQ nie jest odpowiedzią
+
   writeOneByte('\x05');
 
   EnqStatus status;
@@ -119,6 +563,8 @@ EnqStatus FiscalPrinter::getEnqStatus()
 
 DleStatus FiscalPrinter::getDleStatus()
 {
+  decoder.clearStatus(); // status odebrany przed wysłaniem DLE nie jest odpowiedzią
+
   writeOneByte('\x10');
 
   DleStatus status;
@@ -145,21 +591,21 @@ DleStatus FiscalPrinter::getDleStatus()
 
 void FiscalPrinter::setErrorHandlingMode(ERROR_HANDLING_MODE mode)
 {
-  vector<int> intParams;
+  Frame frame("#e");
 
-  intParams.push_back((int)mode);
+  frame.number((int)mode);
 
-  execute(intParams, "#e", true);
+  execute(frame);
 }
 
 
 PrinterError FiscalPrinter::getLastError()
 {
-  vector<int> intParams;
+  Frame frame("#n", false);
 
-  intParams.push_back(0); // parametr ignorowany
+  frame.number(0); // parametr ignorowany
 
-  execute(intParams, "#n", false);
+  execute(frame);
 
   int code = 0;
 
@@ -169,24 +615,44 @@ PrinterError FiscalPrinter::getLastError()
 
     );
 
+  if (code != 0)
+  {
+    state = TS_UNKNOWN; // rozkaz mógł nie zmienić stanu drukarki
+  }
+
   return PrinterError(code);
 }
 
 
 CashRegisterInfo1 FiscalPrinter::getCashRegisterInfo1()
 {
-  vector<int> intParams;
+  Frame frame("#s", false);
 
-  intParams.push_back(0);
+  frame.number(0);
 
-  execute(intParams, "#s", false);
+  execute(frame);
 
-  string result = read();
+  return parseCashRegisterInfo1(read());
+}
+
+
+CashRegisterInfo1View FiscalPrinter::getCashRegisterInfo1View()
+{
+  Frame frame("#s", false);
+
+  frame.number(0);
+
+  execute(frame);
+
+  return CashRegisterInfo1View(read());
+}
 
-  CashRegisterInfo1 info;
 
-  vector<float> vat;
-  vector<float> tot;
+CashRegisterInfo1 FiscalPrinter::parseCashRegisterInfo1(const string &reply)
+{
+  string result = reply;
+
+  CashRegisterInfo1 info;
 
   int len;
 
@@ -214,16 +680,23 @@ CashRegisterInfo1 FiscalPrinter::getCashRegisterInfo1()
 
   len = parse(result.c_str(),
 
-    +(strict_real_p[push_back_a(vat)] >> ch_p('/')) >>
-    int_p[assign_a(info.reciepts)]    >> ch_p('/')
+    repeat_p(1, VatTable::SIZE)[strict_real_p[push_back_a(info.vat)] >> ch_p('/')] >>
+
+    int_p[assign_a(info.reciepts)] >> ch_p('/')
 
     ).length;
 
   result = result.substr(len);
 
+  // drukarka odsyła o jeden totalizer więcej niż stawek, nadmiarowe pola są pomijane
+
+  int totals = info.vat.size + 1;
+  int stored = std::min(totals, (int)VatTable::SIZE);
+
   len = parse(result.c_str(),
 
-    repeat_p(vat.size() + 1)[strict_real_p[push_back_a(tot)] >> ch_p('/')]
+    repeat_p(stored)[strict_real_p[push_back_a(info.totals)] >> ch_p('/')] >>
+    repeat_p(totals - stored)[strict_real_p >> ch_p('/')]
 
     ).length;
 
@@ -236,20 +709,7 @@ CashRegisterInfo1 FiscalPrinter::getCashRegisterInfo1()
 
     ).length;
 
-  if (vat.size() > 0) info.vatA = vat[0];
-  if (vat.size() > 1) info.vatB = vat[1];
-  if (vat.size() > 2) info.vatC = vat[2];
-  if (vat.size() > 3) info.vatD = vat[3];
-  if (vat.size() > 4) info.vatE = vat[4];
-  if (vat.size() > 5) info.vatF = vat[5];
-
-  if (tot.size() > 0) info.totA = tot[0];
-  if (tot.size() > 1) info.totB = tot[1];
-  if (tot.size() > 2) info.totC = tot[2];
-  if (tot.size() > 3) info.totD = tot[3];
-  if (tot.size() > 4) info.totE = tot[4];
-  if (tot.size() > 5) info.totF = tot[5];
-  if (tot.size() > 6) info.totG = tot[6];
+  info.vat.excludeDisabled();
 
   return info;
 }
@@ -257,21 +717,44 @@ CashRegisterInfo1 FiscalPrinter::getCashRegisterInfo1()
 
 CashRegisterInfo2 FiscalPrinter::getCashRegisterInfo2(CASH_REGISTER_INFO_2_MODE mode, bool invoices)
 {
-  vector<int> intParams;
+  Frame frame("$r");
 
-  intParams.push_back(243);
-  intParams.push_back((int)invoices);
+  frame.number(243);
+  frame.number((int)invoices);
 
-  execute(intParams, "$r", true);
+  execute(frame);
 
-  intParams.clear();
+  Frame request("#s", false);
 
-  intParams.push_back((int)mode);
+  request.number((int)mode);
 
-  execute(intParams, "#s", false);
+  execute(request);
 
-  string result = read();
+  return parseCashRegisterInfo2(read());
+}
+
+
+CashRegisterInfo2View FiscalPrinter::getCashRegisterInfo2View(CASH_REGISTER_INFO_2_MODE mode, bool invoices)
+{
+  Frame frame("$r");
 
+  frame.number(243);
+  frame.number((int)invoices);
+
+  execute(frame);
+
+  Frame request("#s", false);
+
+  request.number((int)mode);
+
+  execute(request);
+
+  return CashRegisterInfo2View(read());
+}
+
+
+CashRegisterInfo2 FiscalPrinter::parseCashRegisterInfo2(const string &result)
+{
   CashRegisterInfo2 info;
 
   parse(result.c_str(),
@@ -292,43 +775,37 @@ CashRegisterInfo2 FiscalPrinter::getCashRegisterInfo2(CASH_REGISTER_INFO_2_MODE
     int_p[assign_a(info.month)]         >> ch_p(';') >>
     int_p[assign_a(info.day)]           >> ch_p('/') >>
 
-    strict_real_p[assign_a(info.vatA)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.vatB)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.vatC)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.vatD)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.vatE)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.vatF)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.vatG)]  >> ch_p('/') >>
+    repeat_p(VatTable::SIZE)[strict_real_p[push_back_a(info.vat)] >> ch_p('/')] >>
 
     int_p[assign_a(info.reciepts)]      >> ch_p('/') >>
 
-    strict_real_p[assign_a(info.totA)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totB)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totC)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totD)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totE)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totF)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totG)]  >> ch_p('/') >>
+    repeat_p(VatTable::SIZE)[strict_real_p[push_back_a(info.totals)] >> ch_p('/')] >>
 
     strict_real_p[assign_a(info.cash)]  >> ch_p('/') >>
     (*print_p)[assign_a(info.number)]
 
     );
 
+  info.vat.excludeDisabled();
+
   return info;
 }
 
 
 CashRegisterInfo3 FiscalPrinter::getCashRegisterInfo3()
 {
-  vector<int> intParams;
+  Frame frame("#s", false);
 
-  intParams.push_back(24);
+  frame.number(24);
 
-  execute(intParams, "#s", false);
+  execute(frame);
+
+  return parseCashRegisterInfo3(read());
+}
 
-  string result = read();
 
+CashRegisterInfo3 FiscalPrinter::parseCashRegisterInfo3(const string &result)
+{
   CashRegisterInfo3 info;
 
   parse(result.c_str(),
@@ -343,13 +820,7 @@ CashRegisterInfo3 FiscalPrinter::getCashRegisterInfo3()
     int_p[assign_a(info.freeReports)]  >> ch_p(';') >>
     int_p[assign_a(info.locked)]       >> ch_p(';') >>
 
-    strict_real_p[assign_a(info.totA)] >> ch_p('/') >>
-    strict_real_p[assign_a(info.totB)] >> ch_p('/') >>
-    strict_real_p[assign_a(info.totC)] >> ch_p('/') >>
-    strict_real_p[assign_a(info.totD)] >> ch_p('/') >>
-    strict_real_p[assign_a(info.totE)] >> ch_p('/') >>
-    strict_real_p[assign_a(info.totF)] >> ch_p('/') >>
-    strict_real_p[assign_a(info.totG)] >> ch_p('/')
+    repeat_p(VatTable::SIZE)[strict_real_p[push_back_a(info.totals)] >> ch_p('/')]
 
     );
 
@@ -359,14 +830,18 @@ CashRegisterInfo3 FiscalPrinter::getCashRegisterInfo3()
 
 CashRegisterInfo4 FiscalPrinter::getCashRegisterInfo4()
 {
-  vector<int> intParams;
+  Frame frame("#s", false);
 
-  intParams.push_back(50);
+  frame.number(50);
 
-  execute(intParams, "#s", false);
+  execute(frame);
 
-  string result = read();
+  return parseCashRegisterInfo4(read());
+}
 
+
+CashRegisterInfo4 FiscalPrinter::parseCashRegisterInfo4(const string &result)
+{
   CashRegisterInfo4 info;
 
   parse(result.c_str(),
@@ -388,11 +863,11 @@ CashRegisterInfo4 FiscalPrinter::getCashRegisterInfo4()
 
 CashRegisterInfo5 FiscalPrinter::getCashRegisterInfo5()
 {
-  vector<int> intParams;
+  Frame frame("#s", false);
 
-  intParams.push_back(90);
+  frame.number(90);
 
-  execute(intParams, "#s", false);
+  execute(frame);
 
   string result = read();
 
@@ -419,15 +894,23 @@ CashRegisterInfo5 FiscalPrinter::getCashRegisterInfo5()
 
 CashRegisterInfo6 FiscalPrinter::getCashRegisterInfo6(CASH_REGISTER_INFO_6_MODE mode)
 {
-  vector<int> intParams;
+  Frame frame("#s");
 
-  intParams.push_back(100);
-  intParams.push_back((int)mode);
+  frame.number(100);
+  frame.number((int)mode);
 
-  execute(intParams, "#s", true);
+  execute(frame);
+
+  CashRegisterInfo6 info = parseCashRegisterInfo6(read());
+
+  updateState(info);
+
+  return info;
+}
 
-  string result = read();
 
+CashRegisterInfo6 FiscalPrinter::parseCashRegisterInfo6(const string &result)
+{
   CashRegisterInfo6 info;
 
   parse(result.c_str(),
@@ -439,13 +922,8 @@ CashRegisterInfo6 FiscalPrinter::getCashRegisterInfo6(CASH_REGISTER_INFO_6_MODE
     str_p("#X")                         >>
 
     strict_real_p[assign_a(info.total)] >> ch_p('/') >>
-    strict_real_p[assign_a(info.totA)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totB)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totC)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totD)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totE)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totF)]  >> ch_p('/') >>
-    strict_real_p[assign_a(info.totG)]  >> ch_p('/') >>
+
+    repeat_p(VatTable::SIZE)[strict_real_p[push_back_a(info.totals)] >> ch_p('/')] >>
 
     int_p                               >> ch_p('/') >>
     int_p                               >> ch_p('/') >>
@@ -459,13 +937,13 @@ CashRegisterInfo6 FiscalPrinter::getCashRegisterInfo6(CASH_REGISTER_INFO_6_MODE
 
 CashRegisterInfo7 FiscalPrinter::getCashRegisterInfo7(int item, CASH_REGISTER_INFO_7_MODE mode)
 {
-  vector<int> intParams;
+  Frame frame("#s");
 
-  intParams.push_back(200);
-  intParams.push_back((int)mode);
-  intParams.push_back(item);
+  frame.number(200);
+  frame.number((int)mode);
+  frame.number(item);
 
-  execute(intParams, "#s", true);
+  execute(frame);
 
   string result = read();
 
@@ -487,10 +965,16 @@ CashRegisterInfo7 FiscalPrinter::getCashRegisterInfo7(int item, CASH_REGISTER_IN
 
 VersionInfo FiscalPrinter::getVersionInfo()
 {
-  execute("#v", false);
+  Frame frame("#v", false);
 
-  string result = read();
+  execute(frame);
 
+  return parseVersionInfo(read());
+}
+
+
+VersionInfo FiscalPrinter::parseVersionInfo(const string &result)
+{
   VersionInfo info;
 
   parse(result.c_str(),
@@ -508,11 +992,11 @@ VersionInfo FiscalPrinter::getVersionInfo()
 
 DeviceInfo1 FiscalPrinter::getDeviceInfo1()
 {
-  vector<int> intParams;
+  Frame frame("$i", false);
 
-  intParams.push_back(0);
+  frame.number(0);
 
-  execute(intParams, "$i", false);
+  execute(frame);
 
   string result = read();
 
@@ -548,14 +1032,18 @@ DeviceInfo1 FiscalPrinter::getDeviceInfo1()
 
 DeviceInfo2 FiscalPrinter::getDeviceInfo2()
 {
-  vector<int> intParams;
+  Frame frame("$i", false);
 
-  intParams.push_back(1);
+  frame.number(1);
 
-  execute(intParams, "$i", false);
+  execute(frame);
+
+  return parseDeviceInfo2(read());
+}
 
-  string result = read();
 
+DeviceInfo2 FiscalPrinter::parseDeviceInfo2(const string &result)
+{
   DeviceInfo2 info;
 
   parse(result.c_str(),
@@ -590,48 +1078,120 @@ DeviceInfo2 FiscalPrinter::getDeviceInfo2()
 
     );
 
-  return info;
+  return info;
+}
+
+
+PrinterSnapshot FiscalPrinter::getSnapshot(CASH_REGISTER_INFO_2_MODE mode2, bool invoices,
+  CASH_REGISTER_INFO_6_MODE mode6)
+{
+  // wszystkie rozkazy są wysyłane przed odczytem pierwszej odpowiedzi, drukarka odpowiada
+  // w kolejności rozkazów
+
+  Frame invoicesSwitch("$r"); // bez odpowiedzi, dotyczy informacji kasowych (2)
+
+  invoicesSwitch.number(243);
+  invoicesSwitch.number((int)invoices);
+
+  Frame info1("#s", false);
+
+  info1.number(0);
+
+  Frame info2("#s", false);
+
+  info2.number((int)mode2);
+
+  Frame info3("#s", false);
+
+  info3.number(24);
+
+  Frame info4("#s", false);
+
+  info4.number(50);
+
+  Frame info6("#s");
+
+  info6.number(100);
+  info6.number((int)mode6);
+
+  Frame clock("#c", false);
+
+  clock.number(0); // parametr ignorowany
+
+  Frame version("#v", false);
+
+  Frame device2("$i", false);
+
+  device2.number(1);
+
+  PrinterSnapshot snapshot;
+
+  snapshot.timestamp = posix_time::microsec_clock::universal_time();
+
+  execute(invoicesSwitch);
+  execute(info1);
+  execute(info2);
+  execute(info3);
+  execute(info4);
+  execute(info6);
+  execute(clock);
+  execute(version);
+  execute(device2);
+
+  snapshot.cashRegisterInfo1 = parseCashRegisterInfo1(read());
+  snapshot.cashRegisterInfo2 = parseCashRegisterInfo2(read());
+  snapshot.cashRegisterInfo3 = parseCashRegisterInfo3(read());
+  snapshot.cashRegisterInfo4 = parseCashRegisterInfo4(read());
+  snapshot.cashRegisterInfo6 = parseCashRegisterInfo6(read());
+  snapshot.clock = parseClockInfo(read());
+  snapshot.versionInfo = parseVersionInfo(read());
+  snapshot.deviceInfo2 = parseDeviceInfo2(read());
+
+  snapshot.duration = (posix_time::microsec_clock::universal_time() - snapshot.timestamp).total_microseconds();
+
+  updateState(snapshot.cashRegisterInfo6);
+
+  return snapshot;
 }
 
 
 void FiscalPrinter::beginFiscalMemoryReadByDate(int year, int month, int day, int hour, int minute, int second)
 {
-  vector<int> intParams;
+  Frame frame("#s", false);
 
-  intParams.push_back(25);
+  frame.number(25);
 
-  intParams.push_back(year);
-  intParams.push_back(month);
-  intParams.push_back(day);
+  frame.number(year);
+  frame.number(month);
+  frame.number(day);
 
-  intParams.push_back(hour);
-  intParams.push_back(minute);
-  intParams.push_back(second);
+  frame.number(hour);
+  frame.number(minute);
+  frame.number(second);
 
-  execute(intParams, "#s", false);
+  execute(frame);
 }
 
 
 void FiscalPrinter::beginFiscalMemoryReadByRow(long row)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("#s", false);
 
-  intParams.push_back(26);
+  frame.number(26);
 
-  stringParams.push_back(fromLong(row) + "/");
+  frame.value(fromLong(row));
 
-  execute(intParams, "#s", stringParams, false);
+  execute(frame);
 }
 
 
 FiscalMemoryRecord *FiscalPrinter::getFiscalMemoryRecord()
 {
-  vector<int> intParams;
+  Frame frame("#s", false);
 
-  intParams.push_back(27);
+  frame.number(27);
 
-  execute(intParams, "#s", false);
+  execute(frame);
 
   string result = read();
 
@@ -680,13 +1240,7 @@ FiscalMemoryRecord *FiscalPrinter::getFiscalMemoryRecord()
 
       strict_real_p[assign_a(record->cancelledReceiptsValue)] >> ch_p('/') >>
 
-      strict_real_p[assign_a(record->totA)]                   >> ch_p('/') >>
-      strict_real_p[assign_a(record->totB)]                   >> ch_p('/') >>
-      strict_real_p[assign_a(record->totC)]                   >> ch_p('/') >>
-      strict_real_p[assign_a(record->totD)]                   >> ch_p('/') >>
-      strict_real_p[assign_a(record->totE)]                   >> ch_p('/') >>
-      strict_real_p[assign_a(record->totF)]                   >> ch_p('/') >>
-      strict_real_p[assign_a(record->totG)]                   >> ch_p('/')
+      repeat_p(VatTable::SIZE)[strict_real_p[push_back_a(record->totals)] >> ch_p('/')]
 
     );
 
@@ -711,16 +1265,12 @@ FiscalMemoryRecord *FiscalPrinter::getFiscalMemoryRecord()
       int_p                                 >> ch_p(';') >>
       int_p                                 >> ch_p('/') >>
 
-      strict_real_p[assign_a(record->vatA)] >> ch_p('/') >>
-      strict_real_p[assign_a(record->vatB)] >> ch_p('/') >>
-      strict_real_p[assign_a(record->vatC)] >> ch_p('/') >>
-      strict_real_p[assign_a(record->vatD)] >> ch_p('/') >>
-      strict_real_p[assign_a(record->vatE)] >> ch_p('/') >>
-      strict_real_p[assign_a(record->vatF)] >> ch_p('/') >>
-      strict_real_p[assign_a(record->vatG)] >> ch_p('/')
+      repeat_p(VatTable::SIZE)[strict_real_p[push_back_a(record->vat)] >> ch_p('/')]
 
     );
 
+    record->vat.excludeDisabled();
+
     return record;
   }
 
@@ -797,37 +1347,40 @@ FiscalMemoryRecord *FiscalPrinter::getFiscalMemoryRecord()
 
 void FiscalPrinter::setClock(const Id &id, int year, int month, int day, int hour, int minute, int second)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("$c");
 
-  intParams.push_back(year);
-  intParams.push_back(month);
-  intParams.push_back(day);
+  frame.number(year);
+  frame.number(month);
+  frame.number(day);
 
-  intParams.push_back(hour);
-  intParams.push_back(minute);
-  intParams.push_back(second);
+  frame.number(hour);
+  frame.number(minute);
+  frame.number(second);
 
   if (!id.isEmpty())
   {
-    stringParams.push_back(id.printerId + "\r");
-    stringParams.push_back(id.operatorId + "\r");
+    frame.line(id.printerId);
+    frame.line(id.operatorId);
   }
 
-  execute(intParams, "$c", stringParams, true);
+  execute(frame);
 }
 
 
 ClockInfo FiscalPrinter::getClock()
 {
-  vector<int> intParams;
+  Frame frame("#c", false);
 
-  intParams.push_back(0); // parametr ignorowany
+  frame.number(0); // parametr ignorowany
 
-  execute(intParams, "#c", false);
+  execute(frame);
 
-  string result = read();
+  return parseClockInfo(read());
+}
 
+
+ClockInfo FiscalPrinter::parseClockInfo(const string &result)
+{
   ClockInfo info;
 
   parse(result.c_str(),
@@ -850,103 +1403,61 @@ ClockInfo FiscalPrinter::getClock()
 
 void FiscalPrinter::setVatRates(const Id &id, int count, float a, float b, float c, float d, float e, float f, float g)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  const float rates[] = { a, b, c, d, e, f, g };
 
-  intParams.push_back(count);
+  command::VatRatesArgs args;
 
-  if (!id.isEmpty())
+  args.count = count;
+  args.id = &id;
+
+  int n = count >= 1 && count <= VatTable::SIZE ? count : 4; // domyślnie cztery stawki (A - D)
+
+  for (int i = 0; i < n; ++i)
   {
-    stringParams.push_back(id.printerId + "\r");
-    stringParams.push_back(id.operatorId + "\r");
-  }
-
-  switch (count)
-  {
-  case 1:
-    stringParams.push_back(fromFloat(a) + "/");
-    break;
-
-  case 2:
-    stringParams.push_back(fromFloat(a) + "/");
-    stringParams.push_back(fromFloat(b) + "/");
-    break;
-
-  case 3:
-    stringParams.push_back(fromFloat(a) + "/");
-    stringParams.push_back(fromFloat(b) + "/");
-    stringParams.push_back(fromFloat(c) + "/");
-    break;
-
-  case 4:
-    stringParams.push_back(fromFloat(a) + "/");
-    stringParams.push_back(fromFloat(b) + "/");
-    stringParams.push_back(fromFloat(c) + "/");
-    stringParams.push_back(fromFloat(d) + "/");
-    break;
-
-  case 5:
-    stringParams.push_back(fromFloat(a) + "/");
-    stringParams.push_back(fromFloat(b) + "/");
-    stringParams.push_back(fromFloat(c) + "/");
-    stringParams.push_back(fromFloat(d) + "/");
-    stringParams.push_back(fromFloat(e) + "/");
-    break;
-
-  case 6:
-    stringParams.push_back(fromFloat(a) + "/");
-    stringParams.push_back(fromFloat(b) + "/");
-    stringParams.push_back(fromFloat(c) + "/");
-    stringParams.push_back(fromFloat(d) + "/");
-    stringParams.push_back(fromFloat(e) + "/");
-    stringParams.push_back(fromFloat(f) + "/");
-    break;
-
-  case 7:
-    stringParams.push_back(fromFloat(a) + "/");
-    stringParams.push_back(fromFloat(b) + "/");
-    stringParams.push_back(fromFloat(c) + "/");
-    stringParams.push_back(fromFloat(d) + "/");
-    stringParams.push_back(fromFloat(e) + "/");
-    stringParams.push_back(fromFloat(f) + "/");
-    stringParams.push_back(fromFloat(g) + "/");
-    break;
-
-  case 0:
-  default:
-    stringParams.push_back(fromFloat(a) + "/");
-    stringParams.push_back(fromFloat(b) + "/");
-    stringParams.push_back(fromFloat(c) + "/");
-    stringParams.push_back(fromFloat(d) + "/");
-    break;
+    args.rates.push_back(rates[i]);
   }
 
-  execute(intParams, "$p", stringParams, true);
+  Frame frame = id.isEmpty()
+    ? command::serialize<command::SetVatRates>(args)
+    : command::serialize<command::SetVatRatesWithId>(args);
+
+  execute(frame);
 }
 
 
 void FiscalPrinter::setHeader(const Id &id, const string &header)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  if (validation)
+  {
+    ValidationErrors errors;
+
+    validate(id, errors);
+    validateHeader(header, errors);
+
+    require(errors);
+  }
+
+  Frame frame("$f");
 
-  intParams.push_back(0); // ustawienie nagłówka
+  frame.number(0); // ustawienie nagłówka
 
-  stringParams.push_back(header + (char)0xff);
+  frame.text(header + (char)0xff);
 
   if (!id.isEmpty())
   {
-    stringParams.push_back(id.printerId + "\r");
-    stringParams.push_back(id.operatorId + "\r");
+    frame.line(id.printerId);
+    frame.line(id.operatorId);
   }
 
-  execute(intParams, "$f", stringParams, true);
+  execute(frame);
 }
 
 
 string FiscalPrinter::getHeader()
 {
-  execute("^u", true);
+  Frame frame("^u");
+
+  execute(frame);
 
   string header;
 
@@ -964,54 +1475,53 @@ string FiscalPrinter::getHeader()
 
 void FiscalPrinter::openDrawer()
 {
-  vector<int> intParams;
+  Frame frame("$d", false);
 
-  intParams.push_back(1);
+  frame.number(1);
 
-  execute(intParams, "$d", false);
+  execute(frame);
 }
 
 
 void FiscalPrinter::setDisplayMessage(const string &message)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("$d", false);
 
-  intParams.push_back(2);
+  frame.number(2);
 
-  stringParams.push_back(message);
+  frame.text(message);
 
-  execute(intParams, "$d", stringParams, false);
+  execute(frame);
 }
 
 
 void FiscalPrinter::setDisplayMode(DISPLAY_MODE mode)
 {
-  vector<int> intParams;
+  Frame frame("$d", false);
 
-  intParams.push_back((int)mode);
+  frame.number((int)mode);
 
-  execute(intParams, "$d", false);
+  execute(frame);
 }
 
 
 void FiscalPrinter::setDiscountAlgorithm(DISCOUNT_ALGORITHM mode)
 {
-  vector<int> intParams;
+  Frame frame("$r");
 
-  intParams.push_back((int)mode);
+  frame.number((int)mode);
 
-  execute(intParams, "$r", true);
+  execute(frame);
 }
 
 
 ServiceDate FiscalPrinter::getServiceCheckDate()
 {
-  vector<int> intParams;
+  Frame frame("^t");
 
-  intParams.push_back(11);
+  frame.number(11);
 
-  execute(intParams, "^t", true);
+  execute(frame);
 
   string result = read();
 
@@ -1037,11 +1547,11 @@ ServiceDate FiscalPrinter::getServiceCheckDate()
 
 ServiceDate FiscalPrinter::getServiceLockDate()
 {
-  vector<int> intParams;
+  Frame frame("^t");
 
-  intParams.push_back(12);
+  frame.number(12);
 
-  execute(intParams, "^t", true);
+  execute(frame);
 
   string result = read();
 
@@ -1070,483 +1580,436 @@ ServiceDate FiscalPrinter::getServiceLockDate()
 void FiscalPrinter::beginTransaction(int items, const ExtraLines &extraLines,
   CLIENT_ID_TYPE clientIdType, const string &clientId)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  beginTransaction(items, EncodedExtraLines(extraLines), clientIdType, clientId);
+}
 
-  intParams.push_back(items);
 
-  if (extraLines.isEmpty() && clientIdType == CIDT_NONE) // pierwsza wersja rozkazu
+void FiscalPrinter::beginTransaction(int items, const EncodedExtraLines &extraLines,
+  CLIENT_ID_TYPE clientIdType, const string &clientId)
+{
+  if (validation)
   {
-    execute(intParams, "$h", true);
+    ValidationErrors errors;
+
+    validateClientId(clientIdType, clientId, errors);
+
+    require(errors);
   }
-  else if (!extraLines.isEmpty() && clientIdType == CIDT_NONE) // druga wersja rozkazu (z liniami dodatkowymi)
-  {
-    intParams.push_back(extraLines.count());
 
-    switch (extraLines.count())
-    {
-    case 1:
-      stringParams.push_back(extraLines.line1 + "\r");
-      break;
+  checkState(TS_IDLE, TS_IDLE, 1002); // paragon już jest rozpoczęty
 
-    case 2:
-      stringParams.push_back(extraLines.line1 + "\r");
-      stringParams.push_back(extraLines.line2 + "\r");
-      break;
+  transactionStallStart = getStallTime();
 
-    case 3:
-      stringParams.push_back(extraLines.line1 + "\r");
-      stringParams.push_back(extraLines.line2 + "\r");
-      stringParams.push_back(extraLines.line3 + "\r");
-      break;
+  checkExtraLines(extraLines);
 
-    default:
-      break;
-    }
+  command::TransactionArgs args;
+
+  args.items = items;
+  args.extraLines = &extraLines;
+  args.clientIdType = clientIdType;
+  args.clientId = &clientId;
+
+  Frame frame = extraLines.isEmpty() && clientIdType == CIDT_NONE
+    ? command::serialize<command::BeginTransaction>(args)            // pierwsza wersja rozkazu
+    : clientIdType == CIDT_NONE
+    ? command::serialize<command::BeginTransactionWithLines>(args)   // druga wersja rozkazu (z liniami dodatkowymi)
+    : command::serialize<command::BeginTransactionWithClientId>(args); // trzecia wersja (pełna)
+
+  execute(frame);
 
-    execute(intParams, "$h", stringParams, true);
+  state = TS_RECEIPT;
+
+  sale = VatTable();
+}
+
+
+void FiscalPrinter::printReceiptLine(const Item &item)
+{
+  if (validation)
+  {
+    ValidationErrors errors;
+
+    validate(item, errors);
+
+    require(errors);
   }
-  else // trzecia wersja (pełna)
+
+  checkState(TS_RECEIPT, TS_INVOICE, 21); // paragon nie został rozpoczęty
+
+  Frame frame = encodeReceiptLine(item, item.quantity, fromFloat(item.gross));
+
+  execute(frame);
+
+  addSale(item.vat, SalesJournal::lineGross(item));
+}
+
+
+ItemTemplate FiscalPrinter::makeItemTemplate(const Item &item)
+{
+  if (validation)
   {
-    intParams.push_back(extraLines.count());
+    ValidationErrors errors;
 
-    intParams.push_back(0); // stała
+    validateItemTemplate(item, errors); // numer linii, ilość i kwota brutto podawane przy wydruku
 
-    intParams.push_back((int)clientIdType);
+    require(errors);
+  }
 
-    switch (extraLines.count())
-    {
-    case 1:
-      stringParams.push_back(extraLines.line1 + "\r");
-      break;
+  // ilość i kwota brutto zastąpione znacznikami, pierwszy parametr liczbowy to zawsze numer linii
+  // (zakodowany jako '0' i pomijany)
 
-    case 2:
-      stringParams.push_back(extraLines.line1 + "\r");
-      stringParams.push_back(extraLines.line2 + "\r");
-      break;
+  Item copy = item;
 
-    case 3:
-      stringParams.push_back(extraLines.line1 + "\r");
-      stringParams.push_back(extraLines.line2 + "\r");
-      stringParams.push_back(extraLines.line3 + "\r");
-      break;
+  copy.line = 0;
 
-    default:
-      break;
-    }
+  string content = encodeReceiptLine(copy, "\x01", "\x02").content().substr(1);
+
+  size_t quantityPos = content.find('\x01');
+  size_t grossPos = content.find('\x02', quantityPos);
+
+  ItemTemplate result;
+
+  result.head = content.substr(0, quantityPos);
+  result.middle = content.substr(quantityPos + 1, grossPos - quantityPos - 1);
+  result.tail = content.substr(grossPos + 1);
+
+  result.ctrl = (char)0xff ^ xorBytes(result.head) ^ xorBytes(result.middle) ^ xorBytes(result.tail);
+
+  result.price = item.price;
+
+  result.vat = item.vat.size() == 1 ? VatTable::index(item.vat[0]) : -1;
+
+  result.discountType = item.discountType;
+  result.discountValue = item.discountValue;
+
+  return result;
+}
+
+
+void FiscalPrinter::printReceiptLine(const ItemTemplate &itemTemplate, int line, const string &quantity, float gross)
+{
+  if (validation)
+  {
+    ValidationErrors errors;
 
-    stringParams.push_back(clientId + "\r");
+    validateItemLine(line, quantity, gross, errors);
 
-    execute(intParams, "$h", stringParams, true);
+    require(errors);
   }
+
+  checkState(TS_RECEIPT, TS_INVOICE, 21); // paragon nie został rozpoczęty
+
+  string lineStr = fromInt(line);
+  string quantityStr = toMazovia(quantity);
+  string grossStr = fromFloat(gross);
+
+  string content = "";
+
+  content.reserve(lineStr.size() + itemTemplate.head.size() + quantityStr.size() + itemTemplate.middle.size() +
+    grossStr.size() + itemTemplate.tail.size() + 2);
+
+  content += lineStr;
+  content += itemTemplate.head;
+  content += quantityStr;
+  content += itemTemplate.middle;
+  content += grossStr;
+  content += itemTemplate.tail;
+
+  // bajt kontrolny: XOR części stałych policzony w szablonie, dokładane są tylko części zmienne
+
+  content += formatCtrlByte(itemTemplate.ctrl ^ xorBytes(lineStr) ^ xorBytes(quantityStr) ^ xorBytes(grossStr));
+
+  write(string("\x1bP") + content + string("\x1b\\"));
+
+  addSale(itemTemplate.vat, SalesJournal::lineGross(gross, itemTemplate.discountType, itemTemplate.discountValue, line == 0));
 }
 
 
-void FiscalPrinter::printReceiptLine(const Item &item)
+Frame FiscalPrinter::encodeReceiptLine(const Item &item, const string &quantity, const string &gross)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame(item.barcode.empty() ? "$l" : "^l");
 
   if (!item.barcode.empty()) // pozycja z kodem PLU (możliwy rabat z opisem)
   {
-    intParams.push_back(item.line);
+    frame.number(item.line);
 
-    intParams.push_back((int)item.discountType);
-    intParams.push_back((int)item.discountDesc);
+    frame.number((int)item.discountType);
+    frame.number((int)item.discountDesc);
 
-    stringParams.push_back(item.name + "\r");
-    stringParams.push_back(item.barcode + "\r");
-    stringParams.push_back(item.quantity + "\r");
+    frame.line(item.name);
+    frame.line(item.barcode);
+    frame.line(quantity);
 
-    stringParams.push_back(item.vat + "/");
-    stringParams.push_back(fromFloat(item.price) + "/");
-    stringParams.push_back(fromFloat(item.gross) + "/");
-    stringParams.push_back(fromFloat(item.discountValue) + "/");
+    frame.value(item.vat);
+    frame.amount(item.price);
+    frame.value(gross);
+    frame.amount(item.discountValue);
 
-    stringParams.push_back(item.discountName + "\r");
-
-    execute(intParams, "^l", stringParams, true);
+    frame.line(item.discountName);
   }
   else if (!item.description.empty()) // pozycja z opisem towaru (możliwy rabat z opisem)
   {
-    intParams.push_back(item.line);
+    frame.number(item.line);
 
-    intParams.push_back((int)item.discountType);
-    intParams.push_back((int)item.discountDesc);
+    frame.number((int)item.discountType);
+    frame.number((int)item.discountDesc);
 
-    intParams.push_back(1);
+    frame.number(1);
 
-    stringParams.push_back(item.name + "\r");
-    stringParams.push_back(item.quantity + "\r");
+    frame.line(item.name);
+    frame.line(quantity);
 
-    stringParams.push_back(item.vat + "/");
-    stringParams.push_back(fromFloat(item.price) + "/");
-    stringParams.push_back(fromFloat(item.gross) + "/");
+    frame.value(item.vat);
+    frame.amount(item.price);
+    frame.value(gross);
 
     if (item.discountType != IDT_0)
     {
-      stringParams.push_back(fromFloat(item.discountValue) + "/");
+      frame.amount(item.discountValue);
 
       if (item.discountName.empty())
       {
-        stringParams.push_back("brak\r");
+        frame.line("brak");
       }
       else
       {
-        stringParams.push_back(item.discountName + "\r");
+        frame.line(item.discountName);
       }
     }
 
-    stringParams.push_back(item.description + "\r");
-
-    execute(intParams, "$l", stringParams, true);
+    frame.line(item.description);
   }
   else if (!item.discountName.empty()) // pozycja z opisem rabatu
   {
-    intParams.push_back(item.line);
+    frame.number(item.line);
 
-    intParams.push_back((int)item.discountType);
-    intParams.push_back((int)item.discountDesc);
+    frame.number((int)item.discountType);
+    frame.number((int)item.discountDesc);
 
-    stringParams.push_back(item.name + "\r");
-    stringParams.push_back(item.quantity + "\r");
+    frame.line(item.name);
+    frame.line(quantity);
 
-    stringParams.push_back(item.vat + "/");
-    stringParams.push_back(fromFloat(item.price) + "/");
-    stringParams.push_back(fromFloat(item.gross) + "/");
-    stringParams.push_back(fromFloat(item.discountValue) + "/");
+    frame.value(item.vat);
+    frame.amount(item.price);
+    frame.value(gross);
+    frame.amount(item.discountValue);
 
-    stringParams.push_back(item.discountName + "\r");
-
-    execute(intParams, "$l", stringParams, true);
+    frame.line(item.discountName);
   }
   else if (item.discountType != IDT_0) // pozycja z rabatem bez opisu
   {
-    intParams.push_back(item.line);
-
-    intParams.push_back((int)item.discountType);
+    frame.number(item.line);
 
-    stringParams.push_back(item.name + "\r");
-    stringParams.push_back(item.quantity + "\r");
-    stringParams.push_back(item.vat + "/");
-    stringParams.push_back(fromFloat(item.price) + "/");
-    stringParams.push_back(fromFloat(item.gross) + "/");
+    frame.number((int)item.discountType);
 
-    stringParams.push_back(fromFloat(item.discountValue) + "/");
+    frame.line(item.name);
+    frame.line(quantity);
+    frame.value(item.vat);
+    frame.amount(item.price);
+    frame.value(gross);
 
-    execute(intParams, "$l", stringParams, true);
+    frame.amount(item.discountValue);
   }
   else // pozycja bez rabatu
   {
-    intParams.push_back(item.line);
+    frame.number(item.line);
 
-    stringParams.push_back(item.name + "\r");
-    stringParams.push_back(item.quantity + "\r");
-    stringParams.push_back(item.vat + "/");
-    stringParams.push_back(fromFloat(item.price) + "/");
-    stringParams.push_back(fromFloat(item.gross) + "/");
-
-    execute(intParams, "$l", stringParams, true);
+    frame.line(item.name);
+    frame.line(quantity);
+    frame.value(item.vat);
+    frame.amount(item.price);
+    frame.value(gross);
   }
+
+  return frame;
 }
 
 
 void FiscalPrinter::printDepositLine(DEPOSIT_TYPE type, const std::string &nr, string quantity, float price)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_RECEIPT, TS_INVOICE, 21); // paragon nie został rozpoczęty
 
-  intParams.push_back((int)type);
+  Frame frame("$l");
 
-  stringParams.push_back(nr + "\r");
+  frame.number((int)type);
 
-  stringParams.push_back(quantity + "\r");
+  frame.line(nr);
 
-  stringParams.push_back("P/"); // stała
+  frame.line(quantity);
 
-  stringParams.push_back(fromFloat(price) + "/");
+  frame.value("P"); // stała
 
-  stringParams.push_back(fromFloat(0.0) + "/"); // argument ignorowany
+  frame.amount(price);
 
-  execute(intParams, "$l", stringParams, true);
+  frame.amount(0.0); // argument ignorowany
+
+  execute(frame);
 }
 
 
 void FiscalPrinter::depositCollected(float amount, int nr, string quantity)
 {
-  vector<string> stringParams;
+  Frame frame("6$d");
 
-  stringParams.push_back(fromFloat(amount) + "/");
+  frame.amount(amount);
 
   if (nr != 0 && !quantity.empty())
   {
-    stringParams.push_back(fromInt(nr) + "\r");
-    stringParams.push_back(quantity + "\r");
+    frame.line(fromInt(nr));
+    frame.line(quantity);
   }
 
-  execute("6$d", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::correctDepositCollected(float amount, int nr, string quantity)
 {
-  vector<string> stringParams;
+  Frame frame("7$d");
 
-  stringParams.push_back(fromFloat(amount) + "/");
+  frame.amount(amount);
 
   if (nr != 0 && !quantity.empty())
   {
-    stringParams.push_back(fromInt(nr) + "\r");
-    stringParams.push_back(quantity + "\r");
+    frame.line(fromInt(nr));
+    frame.line(quantity);
   }
 
-  execute("7$d", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::depositReturned(float amount, int nr, string quantity)
 {
-  vector<string> stringParams;
+  Frame frame("10$d");
 
-  stringParams.push_back(fromFloat(amount) + "/");
+  frame.amount(amount);
 
   if (nr != 0 && !quantity.empty())
   {
-    stringParams.push_back(fromInt(nr) + "\r");
-    stringParams.push_back(quantity + "\r");
+    frame.line(fromInt(nr));
+    frame.line(quantity);
   }
 
-  execute("10$d", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::correctDepositReturned(float amount, int nr, string quantity)
 {
-  vector<string> stringParams;
+  Frame frame("11$d");
 
-  stringParams.push_back(fromFloat(amount) + "/");
+  frame.amount(amount);
 
   if (nr != 0 && !quantity.empty())
   {
-    stringParams.push_back(fromInt(nr) + "\r");
-    stringParams.push_back(quantity + "\r");
+    frame.line(fromInt(nr));
+    frame.line(quantity);
   }
 
-  execute("11$d", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::cancelTransaction(const Id &id)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_RECEIPT, TS_INVOICE, 29); // próba zakończenia nie rozpoczętego paragonu
 
-  intParams.push_back(0);
+  command::TransactionArgs args;
 
-  if (!id.isEmpty())
-  {
-    stringParams.push_back(id.printerId + "\r");
-    stringParams.push_back(id.operatorId + "\r");
-  }
+  args.id = &id;
 
-  execute(intParams, "$e", stringParams, true);
+  Frame frame = id.isEmpty()
+    ? command::serialize<command::CancelTransaction>(args)
+    : command::serialize<command::CancelTransactionWithId>(args);
+
+  execute(frame);
+
+  state = TS_IDLE;
 }
 
 
 void FiscalPrinter::confirmTransaction(const Id &id, float cashIn, float total,
   TRANSACTION_DISCOUNT_TYPE discountType, float discountValue, const ExtraLines &extraLines)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  if (discountType != TDT_0)
-  {
-    intParams.push_back(1); // zatwierdzenie
-
-    intParams.push_back(extraLines.count());
-
-    intParams.push_back(0); // zakończenie
-
-    intParams.push_back((int)discountType);
-
-    intParams.push_back(1); // stała wartość
-
-    if (id.isEmpty())
-    {
-      stringParams.push_back("000\r");
-    }
-    else
-    {
-      stringParams.push_back(id.printerId + id.operatorId + "\r");
-    }
-
-    switch (extraLines.count())
-    {
-    case 1:
-      stringParams.push_back(extraLines.line1 + "\r");
-      break;
-
-    case 2:
-      stringParams.push_back(extraLines.line1 + "\r");
-      stringParams.push_back(extraLines.line2 + "\r");
-      break;
-
-    case 3:
-      stringParams.push_back(extraLines.line1 + "\r");
-      stringParams.push_back(extraLines.line2 + "\r");
-      stringParams.push_back(extraLines.line3 + "\r");
-      break;
-
-    default:
-      break;
-    }
-
-    stringParams.push_back(fromFloat(cashIn) + "/");
-    stringParams.push_back(fromFloat(total) + "/");
-    stringParams.push_back(fromFloat(discountValue) + "/");
-
-    execute(intParams, "$e", stringParams, true);
-  }
-  else if (!extraLines.isEmpty())
-  {
-    intParams.push_back(1); // zatwierdzenie
-
-    intParams.push_back(0); // rabat 0
-
-    intParams.push_back(extraLines.count());
-
-    intParams.push_back(0); // zakończenie
+  confirmTransaction(EncodedId(id, validation), cashIn, total, discountType, discountValue, EncodedExtraLines(extraLines));
+}
 
-    if (id.isEmpty())
-    {
-      stringParams.push_back("000\r");
-    }
-    else
-    {
-      stringParams.push_back(id.printerId + id.operatorId + "\r");
-    }
 
-    switch (extraLines.count())
-    {
-    case 1:
-      stringParams.push_back(extraLines.line1 + "\r");
-      break;
+void FiscalPrinter::confirmTransaction(const EncodedId &id, float cashIn, float total,
+  TRANSACTION_DISCOUNT_TYPE discountType, float discountValue, const EncodedExtraLines &extraLines)
+{
+  checkState(TS_RECEIPT, TS_RECEIPT, 29); // próba zakończenia nie rozpoczętego paragonu
 
-    case 2:
-      stringParams.push_back(extraLines.line1 + "\r");
-      stringParams.push_back(extraLines.line2 + "\r");
-      break;
+  checkExtraLines(extraLines);
 
-    case 3:
-      stringParams.push_back(extraLines.line1 + "\r");
-      stringParams.push_back(extraLines.line2 + "\r");
-      stringParams.push_back(extraLines.line3 + "\r");
-      break;
+  command::TransactionArgs args;
 
-    default:
-      break;
-    }
+  args.encodedId = &id;
+  args.extraLines = &extraLines;
+  args.cashIn = cashIn;
+  args.total = total;
+  args.discountType = discountType;
+  args.discountValue = discountValue;
 
-    stringParams.push_back(fromFloat(cashIn) + "/");
-    stringParams.push_back(fromFloat(total) + "/");
+  Frame frame = discountType != TDT_0
+    ? command::serialize<command::ConfirmTransactionWithDiscount>(args)
+    : !extraLines.isEmpty()
+    ? command::serialize<command::ConfirmTransactionWithLines>(args)
+    : command::serialize<command::ConfirmTransaction>(args);
 
-    execute(intParams, "$e", stringParams, true);
-  }
-  else
-  {
-    intParams.push_back(1); // zatwierdzenie
+  execute(frame);
 
-    if (id.isEmpty())
-    {
-      stringParams.push_back("000\r");
-    }
-    else
-    {
-      stringParams.push_back(id.printerId + id.operatorId + "\r");
-    }
+  state = TS_IDLE;
 
-    stringParams.push_back(fromFloat(cashIn) + "/");
-    stringParams.push_back(fromFloat(total) + "/");
+  SalesJournal::applyDiscount(sale, discountType, discountValue);
 
-    execute(intParams, "$e", stringParams, true);
-  }
+  recordSale();
 }
 
 
 void FiscalPrinter::confirmTransactionWithPaymentForms1(const Id &id, const PaymentFormsInfo1 &info,
   float total, TRANSACTION_DISCOUNT_TYPE discountType, float discountValue, const ExtraLines &extraLines)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  intParams.push_back(extraLines.count());
-
-  intParams.push_back(0); // zakończenie
+  confirmTransactionWithPaymentForms1(EncodedId(id, validation), info, total, discountType, discountValue,
+    EncodedExtraLines(extraLines));
+}
 
-  intParams.push_back(0); // parametr ignorowany
 
-  intParams.push_back((int)discountType);
+void FiscalPrinter::confirmTransactionWithPaymentForms1(const EncodedId &id, const PaymentFormsInfo1 &info,
+  float total, TRANSACTION_DISCOUNT_TYPE discountType, float discountValue, const EncodedExtraLines &extraLines)
+{
+  if (validation)
+  {
+    ValidationErrors errors;
 
-  intParams.push_back((int)info.cashFlag);
-  intParams.push_back((int)info.cardFlag);
-  intParams.push_back((int)info.chequeFlag);
-  intParams.push_back((int)info.couponFlag);
-  intParams.push_back((int)info.depositCollectedFlag);
-  intParams.push_back((int)info.depositReturnedFlag);
-  intParams.push_back((int)info.changeFlag);
+    validate(info, errors);
 
-  if (id.isEmpty())
-  {
-    stringParams.push_back("000\r");
-  }
-  else
-  {
-    stringParams.push_back(id.printerId + id.operatorId + "\r");
+    require(errors);
   }
 
-  switch (extraLines.count())
-  {
-  case 1:
-    stringParams.push_back(extraLines.line1 + "\r");
-    stringParams.push_back("\r\r\r\r");
-    break;
-
-  case 2:
-    stringParams.push_back(extraLines.line1 + "\r");
-    stringParams.push_back(extraLines.line2 + "\r");
-    stringParams.push_back("\r\r\r");
-    break;
+  checkState(TS_RECEIPT, TS_RECEIPT, 29); // próba zakończenia nie rozpoczętego paragonu
 
-  case 3:
-    stringParams.push_back(extraLines.line1 + "\r");
-    stringParams.push_back(extraLines.line2 + "\r");
-    stringParams.push_back(extraLines.line3 + "\r");
-    stringParams.push_back("\r\r");
-    break;
+  checkExtraLines(extraLines);
 
-  default:
-    stringParams.push_back("\r\r\r\r\r");
-    break;
-  }
+  command::PaymentForms1Args args;
 
-  stringParams.push_back(info.cardName + "\r");
-  stringParams.push_back(info.chequeName + "\r");
-  stringParams.push_back(info.couponName + "\r");
+  args.id = &id;
+  args.info = &info;
+  args.total = total;
+  args.discountType = discountType;
+  args.discountValue = discountValue;
+  args.extraLines = &extraLines;
 
-  stringParams.push_back(fromFloat(total) + "/");
-  stringParams.push_back(fromFloat(discountValue) + "/");
+  Frame frame = command::serialize<command::ConfirmTransactionWithPaymentForms1>(args);
 
-  stringParams.push_back(fromFloat(info.cashIn) + "/");
-  stringParams.push_back(fromFloat(info.cardIn) + "/");
-  stringParams.push_back(fromFloat(info.chequeIn) + "/");
-  stringParams.push_back(fromFloat(info.couponIn) + "/");
+  execute(frame);
 
-  stringParams.push_back(fromFloat(info.depositCollected) + "/");
-  stringParams.push_back(fromFloat(info.depositReturned) + "/");
+  state = TS_IDLE;
 
-  stringParams.push_back(fromFloat(info.checkOut) + "/");
+  SalesJournal::applyDiscount(sale, discountType, discountValue);
 
-  execute(intParams, "$x", stringParams, true);
+  recordSale();
 }
 
 
@@ -1554,596 +2017,433 @@ void FiscalPrinter::confirmTransactionWithPaymentForms2(const Id &id, const Paym
   float total, DISCOUNT_TYPE discountType, float discountValue, string sysNr, bool summary,
   const ExtraLines &extraLines)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  intParams.push_back(extraLines.count());
-
-  intParams.push_back(0); // zakończenie
-
-  intParams.push_back((int)summary);
-
-  intParams.push_back(0); // znak DSP (ignorowane)
-
-  intParams.push_back((int)discountType);
-
-  intParams.push_back((int)info.depositCollected.size());
-  intParams.push_back((int)info.depositReturned.size());
-
-  intParams.push_back(sysNr.size() > 0 ? 1 : 0);
-
-  intParams.push_back((int)info.paymentForms.size());
-
-  intParams.push_back((int)info.changeFlag);
-  intParams.push_back((int)info.cashFlag);
-
-  for (size_t i = 0; i < info.paymentForms.size(); ++i)
-  {
-    intParams.push_back((int)info.paymentForms[i].type);
-  }
-
-  stringParams.push_back(id.printerId + "\r");
-  stringParams.push_back(id.operatorId + "\r");
-
-  stringParams.push_back(sysNr + "\r");
-
-  switch (extraLines.count())
-  {
-  case 1:
-    stringParams.push_back(extraLines.line1 + "\r");
-    break;
-
-  case 2:
-    stringParams.push_back(extraLines.line1 + "\r");
-    stringParams.push_back(extraLines.line2 + "\r");
-    break;
-
-  case 3:
-    stringParams.push_back(extraLines.line1 + "\r");
-    stringParams.push_back(extraLines.line2 + "\r");
-    stringParams.push_back(extraLines.line3 + "\r");
-    break;
-
-  default:
-    break;
-  }
-
-  for (size_t i = 0; i < info.paymentForms.size(); ++i)
-  {
-    stringParams.push_back(info.paymentForms[i].name + "\r");
-  }
-
-  for (size_t i = 0; i < info.depositCollected.size(); ++i)
-  {
-    stringParams.push_back(info.depositCollected[i].nr + "\r");
-  }
-
-  for (size_t i = 0; i < info.depositCollected.size(); ++i)
-  {
-    stringParams.push_back(info.depositCollected[i].quantity + "\r");
-  }
-
-  for (size_t i = 0; i < info.depositReturned.size(); ++i)
-  {
-    stringParams.push_back(info.depositReturned[i].nr + "\r");
-  }
+  confirmTransactionWithPaymentForms2(EncodedId(id, validation), info, total, discountType, discountValue, sysNr, summary,
+    EncodedExtraLines(extraLines));
+}
 
-  for (size_t i = 0; i < info.depositReturned.size(); ++i)
-  {
-    stringParams.push_back(info.depositReturned[i].quantity + "\r");
-  }
 
-  stringParams.push_back(fromFloat(total) + "/");
+void FiscalPrinter::confirmTransactionWithPaymentForms2(const EncodedId &id, const PaymentFormsInfo2 &info,
+  float total, DISCOUNT_TYPE discountType, float discountValue, string sysNr, bool summary,
+  const EncodedExtraLines &extraLines)
+{
+  checkState(TS_RECEIPT, TS_RECEIPT, 29); // próba zakończenia nie rozpoczętego paragonu
 
-  stringParams.push_back("0/"); // DSP (ignorowane)
+  checkExtraLines(extraLines);
 
-  stringParams.push_back(fromFloat(discountValue) + "/");
+  command::PaymentForms2Args args;
 
-  stringParams.push_back(fromFloat(info.cashIn) + "/");
+  args.id = &id;
+  args.info = &info;
+  args.total = total;
+  args.discountType = discountType;
+  args.discountValue = discountValue;
+  args.sysNr = &sysNr;
+  args.summary = summary;
+  args.extraLines = &extraLines;
 
-  for (size_t i = 0; i < info.paymentForms.size(); ++i)
-  {
-    stringParams.push_back(fromFloat(info.paymentForms[i].amount) + "/");
-  }
+  Frame frame = command::serialize<command::ConfirmTransactionWithPaymentForms2>(args);
 
-  stringParams.push_back(fromFloat(info.changeOut) + "/");
+  execute(frame);
 
-  for (size_t i = 0; i < info.depositCollected.size(); ++i)
-  {
-    stringParams.push_back(fromFloat(info.depositCollected[i].amount) + "/");
-  }
+  state = TS_IDLE;
 
-  for (size_t i = 0; i < info.depositReturned.size(); ++i)
-  {
-    stringParams.push_back(fromFloat(info.depositReturned[i].amount) + "/");
-  }
+  SalesJournal::applyDiscount(sale, discountType, discountValue);
 
-  execute(intParams, "$y", stringParams, true);
+  recordSale();
 }
 
 
 void FiscalPrinter::paymentFormService(SERVICE_TYPE serviceType,
  PAYMENT_TYPE paymentType, float amount, const string &name)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("$b");
 
-  intParams.push_back((int)serviceType);
-  intParams.push_back((int)paymentType);
+  frame.number((int)serviceType);
+  frame.number((int)paymentType);
 
-  stringParams.push_back(fromFloat(amount) + "/");
-  stringParams.push_back(name + "\r");
+  frame.amount(amount);
+  frame.line(name);
 
-  execute(intParams, "$b", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::addDiscount(DISCOUNT_TYPE discountType, const string &name, float value)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_RECEIPT, TS_INVOICE, 21); // paragon nie został rozpoczęty
+
+  Frame frame("$n");
+
+  frame.number((int)discountType);
 
-  intParams.push_back((int)discountType);
+  frame.line(name);
+  frame.amount(value);
 
-  stringParams.push_back(name + "\r");
-  stringParams.push_back(fromFloat(value) + "/");
+  execute(frame);
 
-  execute(intParams, "$n", stringParams, true);
+  SalesJournal::applyDiscount(sale, discountType, value);
 }
 
 
 void FiscalPrinter::addVatRateDiscount(int vat, DISCOUNT_TYPE discountType,  DISCOUNT_DESCRIPTION_TYPE discountDescription,
   float amount, float discountValue, const string &discountName)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_RECEIPT, TS_INVOICE, 21); // paragon nie został rozpoczęty
+
+  Frame frame("$L");
+
+  frame.number(vat);
+  frame.number((int)discountType);
+  frame.number((int)discountDescription);
+
+  frame.amount(amount);
+  frame.amount(discountValue);
+
+  frame.line(discountName);
 
-  intParams.push_back(vat);
-  intParams.push_back((int)discountType);
-  intParams.push_back((int)discountDescription);
+  execute(frame);
 
-  stringParams.push_back(fromFloat(amount) + "/");
-  stringParams.push_back(fromFloat(discountValue) + "/");
+  // rabat liczony od podanej wartości sprzedaży w stawce, do sprzedaży dodawana jest tylko zmiana
 
-  stringParams.push_back(discountName + "\r");
+  VatTable rate;
 
-  execute(intParams, "$L", stringParams, true);
+  rate.set(0, amount);
+
+  SalesJournal::applyDiscount(rate, discountType, discountValue);
+
+  addSale(vat, rate.values[0] - VatTable::toFixed(amount));
 }
 
 
 void FiscalPrinter::addSubtotalDiscount(DISCOUNT_TYPE discountType, DISCOUNT_DESCRIPTION_TYPE discountDescription,
   float subtotal, float discount, string discountName)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_RECEIPT, TS_INVOICE, 21); // paragon nie został rozpoczęty
+
+  Frame frame("$Y");
+
+  frame.number((int)discountType);
+  frame.number((int)discountDescription);
 
-  intParams.push_back((int)discountType);
-  intParams.push_back((int)discountDescription);
+  frame.amount(subtotal);
+  frame.amount(discount);
 
-  stringParams.push_back(fromFloat(subtotal) + "/");
-  stringParams.push_back(fromFloat(discount) + "/");
+  frame.line(discountName);
 
-  stringParams.push_back(discountName + "\r");
+  execute(frame);
 
-  execute(intParams, "$Y", stringParams, true);
+  SalesJournal::applyDiscount(sale, discountType, discount);
 }
 
 
 void FiscalPrinter::extraLineContainerReturned(string name, const string &quantity, float amount)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("$z");
 
-  intParams.push_back(8); // stała
+  frame.number(8); // stała
 
-  stringParams.push_back(name + "\r");
-  stringParams.push_back(quantity + "\r");
+  frame.line(name);
+  frame.line(quantity);
 
-  stringParams.push_back(fromFloat(amount) + "/");
+  frame.amount(amount);
 
-  execute(intParams, "$z", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::extraLineContainerReceived(string name, const string &quantity, float amount)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("$z");
 
-  intParams.push_back(4); // stała
+  frame.number(4); // stała
 
-  stringParams.push_back(name + "\r");
-  stringParams.push_back(quantity + "\r");
+  frame.line(name);
+  frame.line(quantity);
 
-  stringParams.push_back(fromFloat(amount) + "/");
+  frame.amount(amount);
 
-  execute(intParams, "$z", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::formsOfPaymentClearing()
 {
-  vector<int> intParams;
+  Frame frame("$z");
 
-  intParams.push_back(12); // stała
+  frame.number(12); // stała
 
-  execute(intParams, "$z", true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::extraLine(EXTRA_LINE_TYPE footerType, const string &text)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("$z");
 
-  intParams.push_back(20); // stała
+  frame.number(20); // stała
 
-  intParams.push_back((int)footerType);
+  frame.number((int)footerType);
 
-  stringParams.push_back(text + "\r");
+  frame.line(text);
 
-  execute(intParams, "$z", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::defineInfoLines(const ExtraLines &lines)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  intParams.push_back(24); // stała
-
-  intParams.push_back(lines.count());
-
-  switch (lines.count())
-  {
-  case 1:
-    stringParams.push_back(lines.line1 + "\r");
-    break;
+  Frame frame("$z");
 
-  case 2:
-    stringParams.push_back(lines.line1 + "\r");
-    stringParams.push_back(lines.line2 + "\r");
-    break;
+  frame.number(24); // stała
 
-  case 3:
-    stringParams.push_back(lines.line1 + "\r");
-    stringParams.push_back(lines.line2 + "\r");
-    stringParams.push_back(lines.line3 + "\r");
-    break;
+  frame.number(lines.count());
 
-  default:
-    break;
-  }
+  frame.lines(lines);
 
-  execute(intParams, "$z", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::euroPayment(float exchange, float amount, float cashIn, float checkEuro, float checkPln)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("$z");
 
-  intParams.push_back(99); // stała
-  intParams.push_back(5); // stała
+  frame.number(99); // stała
+  frame.number(5); // stała
 
-  stringParams.push_back(fromFloat(exchange) + "\r");
-  stringParams.push_back(fromFloat(amount) + "\r");
-  stringParams.push_back(fromFloat(cashIn) + "\r");
-  stringParams.push_back(fromFloat(checkEuro) + "\r");
-  stringParams.push_back(fromFloat(checkPln) + "\r");
+  frame.line(fromFloat(exchange));
+  frame.line(fromFloat(amount));
+  frame.line(fromFloat(cashIn));
+  frame.line(fromFloat(checkEuro));
+  frame.line(fromFloat(checkPln));
 
-  execute(intParams, "$z", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::finish(bool nextHeader)
 {
-  vector<int> intParams;
-
-  intParams.push_back(28); // stała
-
-  intParams.push_back(nextHeader ? 2 : 0);
-
-  execute(intParams, "$z", true);
-}
-
-
-void FiscalPrinter::beginInvoice(const BeginInvoiceData &data)
-{
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  intParams.push_back(data.items);
-  intParams.push_back(data.clientLines.size());
-
-  intParams.push_back(1); // stała
-
-  intParams.push_back((int)data.printCopy);
-  intParams.push_back((int)data.topMargin);
-
-  intParams.push_back(0); // parametr ignorowany
-
-  intParams.push_back(data.additionalCopies);
-
-  intParams.push_back(0); // parametr ignorowany
-  intParams.push_back(0); // parametr ignorowany
-
-  intParams.push_back((int)data.signature);
-
-  stringParams.push_back(data.invoiceNr + "\r");
-
-  for (size_t i = 0; i < data.clientLines.size(); ++i)
-  {
-    stringParams.push_back(data.clientLines[i] + "\r");
-  }
-
-  stringParams.push_back(data.nip + "\r");
-
-  stringParams.push_back(data.timeout + "\r");
-
-  stringParams.push_back(data.paymentForm + "\r");
+  Frame frame("$z");
 
-  stringParams.push_back(data.client + "\r");
-  stringParams.push_back(data.seller + "\r");
+  frame.number(28); // stała
 
-  stringParams.push_back(data.systemNr + "\r");
+  frame.number(nextHeader ? 2 : 0);
 
-  execute(intParams, "$h", stringParams, true);
+  execute(frame);
 }
 
 
-void FiscalPrinter::finishInvoice(const Id &id, const FinishInvoiceData &data)
-{
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  intParams.push_back(1); // zatwierdzenie
-
-  intParams.push_back(0); // parametr ignorowany
-
-  intParams.push_back(data.extraLines.count());
-
-  intParams.push_back(0); // parametr ignorowany
-  intParams.push_back(0); // parametr ignorowany
-
-  intParams.push_back(1); // stała wartość
-
-  intParams.push_back(data.payedFlag);
-
-  intParams.push_back((int)data.client);
-  intParams.push_back((int)data.seller);
-
-  if (id.isEmpty())
-  {
-    stringParams.push_back("000\r");
-  }
-  else
-  {
-    stringParams.push_back(id.printerId + id.operatorId + "\r");
-  }
-
-  switch (data.extraLines.count())
+void FiscalPrinter::beginInvoice(const BeginInvoiceData &data)
+{
+  if (validation)
   {
-  case 1:
-    stringParams.push_back(data.extraLines.line1 + "\r");
-    break;
+    ValidationErrors errors;
 
-  case 2:
-    stringParams.push_back(data.extraLines.line1 + "\r");
-    stringParams.push_back(data.extraLines.line2 + "\r");
-    break;
+    validate(data, errors);
 
-  case 3:
-    stringParams.push_back(data.extraLines.line1 + "\r");
-    stringParams.push_back(data.extraLines.line2 + "\r");
-    stringParams.push_back(data.extraLines.line3 + "\r");
-    break;
-
-  default:
-    break;
+    require(errors);
   }
 
-  stringParams.push_back(data.payed + "\r");
+  checkState(TS_IDLE, TS_IDLE, 1002); // paragon już jest rozpoczęty
 
-  stringParams.push_back(data.clientName + "\r");
-  stringParams.push_back(data.sellerName + "\r");
+  Frame frame = command::serialize<command::BeginInvoice>(data);
 
-  stringParams.push_back(fromFloat(data.cashIn) + "/");
-  stringParams.push_back(fromFloat(data.total) + "/");
+  execute(frame);
 
-  stringParams.push_back(fromFloat(data.discountValue) + "/");
-
-  execute(intParams, "$e", stringParams, true);
+  state = TS_INVOICE;
 }
 
 
-void FiscalPrinter::setInvoiceOption(const InvoiceOptions &options)
+void FiscalPrinter::finishInvoice(const Id &id, const FinishInvoiceData &data)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  intParams.push_back(options.additionalCopies);
+  checkState(TS_INVOICE, TS_INVOICE, 29); // próba zakończenia nie rozpoczętej faktury
 
-  intParams.push_back((int)options.client);
-  intParams.push_back((int)options.seller);
+  EncodedId encodedId(id, false); // "000", jeśli identyfikator jest pusty
 
-  intParams.push_back((int)options.payedFlag);
+  command::FinishInvoiceArgs args;
 
-  intParams.push_back(options.year);
-  intParams.push_back(options.month);
-  intParams.push_back(options.day);
+  args.id = &encodedId;
+  args.data = &data;
 
-  intParams.push_back(options.summaryOption);
+  Frame frame = command::serialize<command::FinishInvoice>(args);
 
-  intParams.push_back(options.invoiceOptions2);
+  execute(frame);
 
-  intParams.push_back((int)options.clientIdType);
-
-  intParams.push_back(options.invoiceOptions3);
+  state = TS_IDLE;
+}
 
 
-  stringParams.push_back(options.timeout + "\r");
-  stringParams.push_back(options.paymentForm + "\r");
-  stringParams.push_back(options.clientName + "\r");
-  stringParams.push_back(options.sellerName + "\r");
-  stringParams.push_back(options.systemNr + "\r");
+void FiscalPrinter::setInvoiceOption(const InvoiceOptions &options)
+{
+  Frame frame = command::serialize<command::SetInvoiceOption>(options);
 
-  execute(intParams, "@c", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::extraLinesInvoice(EXTRA_LINE_TYPE type, const string &text)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("$z");
 
-  intParams.push_back(20); // stała
+  frame.number(20); // stała
 
-  intParams.push_back((int)type);
+  frame.number((int)type);
 
-  stringParams.push_back(text + "\r");
+  frame.line(text);
 
-  execute(intParams, "$z", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::login(const Id &id)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame = command::serialize<command::Login>(id);
 
-  intParams.push_back(0); // parametr ignorowany
+  execute(frame);
 
-  stringParams.push_back(id.operatorId + "\r");
-  stringParams.push_back(id.printerId + "\r");
-
-  execute(intParams, "#p", stringParams, true);
+  cashierLoggedIn = true;
 }
 
 
 void FiscalPrinter::logout(const Id &id)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  intParams.push_back(0); // parametr ignorowany
+  Frame frame = command::serialize<command::Logout>(id);
 
-  stringParams.push_back(id.operatorId + "\r");
-  stringParams.push_back(id.printerId + "\r");
+  execute(frame);
 
-  execute(intParams, "#q", stringParams, true);
+  cashierLoggedIn = false;
 }
 
 
 void FiscalPrinter::paymentToCash(const Id &id, float cashIn, bool euro)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_IDLE, TS_IDLE, 1031); // rozkaz wysłany w niewłaściwym trybie
+
+  Frame frame("#i");
 
   if (euro)
   {
-    intParams.push_back(99);
+    frame.number(99);
   }
   else
   {
-    intParams.push_back(0);
+    frame.number(0);
   }
 
-  stringParams.push_back(fromFloat(cashIn) + "/");
+  frame.amount(cashIn);
 
   if (!id.isEmpty())
   {
-    stringParams.push_back(id.printerId + "\r");
-    stringParams.push_back(id.operatorId + "\r");
+    frame.line(id.printerId);
+    frame.line(id.operatorId);
   }
 
-  execute(intParams, "#i", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::withdrawalFromCash(const Id &id, float cashOut, bool euro)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_IDLE, TS_IDLE, 1031); // rozkaz wysłany w niewłaściwym trybie
+
+  Frame frame("#d");
 
   if (euro)
   {
-    intParams.push_back(99);
+    frame.number(99);
   }
   else
   {
-    intParams.push_back(0);
+    frame.number(0);
   }
 
-  stringParams.push_back(fromFloat(cashOut) + "/");
+  frame.amount(cashOut);
 
   if (!id.isEmpty())
   {
-    stringParams.push_back(id.printerId + "\r");
-    stringParams.push_back(id.operatorId + "\r");
+    frame.line(id.printerId);
+    frame.line(id.operatorId);
   }
 
-  execute(intParams, "#d", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::printCashState(const Id &id)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_IDLE, TS_IDLE, 1031); // rozkaz wysłany w niewłaściwym trybie
 
-  intParams.push_back(0); // parametr ignorowany
+  Frame frame("#t");
 
-  if (!id.isEmpty())
-  {
-    stringParams.push_back(id.printerId + "\r");
-    stringParams.push_back(id.operatorId + "\r");
+  frame.number(0); // parametr ignorowany
 
-    execute(intParams, "#t", stringParams, true);
-  }
-  else
+  if (!id.isEmpty())
   {
-    execute(intParams, "#t", true);
+    frame.line(id.printerId);
+    frame.line(id.operatorId);
   }
+
+  execute(frame);
 }
 
 
 void FiscalPrinter::printShiftReport(const Id &id, bool reset, const string &shift)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  if (validation)
+  {
+    ValidationErrors errors;
+
+    validate(id, errors);
+    validateShift(shift, errors);
 
-  intParams.push_back((int)!reset);
+    require(errors);
+  }
+
+  checkState(TS_IDLE, TS_IDLE, 1031); // rozkaz wysłany w niewłaściwym trybie
+
+  Frame frame("#k");
+
+  frame.number((int)!reset);
 
-  stringParams.push_back(shift + "\r");
+  frame.line(shift);
 
-  stringParams.push_back(id.operatorId + "\r");
+  frame.line(id.operatorId);
 
   if (!id.printerId.empty())
   {
-    stringParams.push_back(id.printerId + "\r");
+    frame.line(id.printerId);
   }
 
-  execute(intParams, "#k", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::printDailyReport(const Id &id)
 {
-  if (id.isEmpty())
+  checkState(TS_IDLE, TS_IDLE, 1031); // rozkaz wysłany w niewłaściwym trybie
+
+  Frame frame("#r");
+
+  if (!id.isEmpty())
   {
-    execute("#r", true);
+    frame.line(id.printerId);
+    frame.line(id.operatorId);
   }
-  else
-  {
-    vector<string> stringParams;
 
-    stringParams.push_back(id.printerId + "\r");
-    stringParams.push_back(id.operatorId + "\r");
+  execute(frame);
+
+  extraLinesStored = false; // nowa doba, drukarka zapamięta linie z pierwszego paragonu
 
-    execute("#r", stringParams, true);
+  if (salesJournal != NULL)
+  {
+    try
+    {
+      salesJournal->markDailyReport();
+    }
+    catch (const boost::system::system_error &e)
+    {
+      salesJournalError(e);
+    }
   }
 }
 
@@ -2151,554 +2451,596 @@ void FiscalPrinter::printDailyReport(const Id &id)
 void FiscalPrinter::printPeriodicalReportByDate(const Id &id, int fromYear, int fromMonth,
   int fromDay, int toYear, int toMonth, int toDay, PERIODICAL_REPORT_TYPE type)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_IDLE, TS_IDLE, 1031); // rozkaz wysłany w niewłaściwym trybie
+
+  Frame frame("#o");
 
-  intParams.push_back(fromYear);
-  intParams.push_back(fromMonth);
-  intParams.push_back(fromDay);
+  frame.number(fromYear);
+  frame.number(fromMonth);
+  frame.number(fromDay);
 
-  intParams.push_back(toYear);
-  intParams.push_back(toMonth);
-  intParams.push_back(toDay);
+  frame.number(toYear);
+  frame.number(toMonth);
+  frame.number(toDay);
 
-  intParams.push_back((int)type);
+  frame.number((int)type);
 
   if (!id.isEmpty())
   {
-    stringParams.push_back(id.operatorId + "\r");
-    stringParams.push_back(id.printerId + "\r");
+    frame.line(id.operatorId);
+    frame.line(id.printerId);
   }
 
-  execute(intParams, "#o", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::printPeriodicalReportByNumber(const Id &id, long fromNr, long toNr,
   PERIODICAL_REPORT_TYPE type)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_IDLE, TS_IDLE, 1031); // rozkaz wysłany w niewłaściwym trybie
 
-  intParams.push_back((int)type);
+  Frame frame("#o");
 
-  stringParams.push_back(fromLong(fromNr) + "/");
-  stringParams.push_back(fromLong(toNr) + "/");
+  frame.number((int)type);
+
+  frame.value(fromLong(fromNr));
+  frame.value(fromLong(toNr));
 
   if (!id.isEmpty())
   {
-    stringParams.push_back(id.operatorId + "\r");
-    stringParams.push_back(id.printerId + "\r");
+    frame.line(id.operatorId);
+    frame.line(id.printerId);
   }
 
-  execute(intParams, "#o", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::containerReturn(const string &text)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("#w");
 
-  intParams.push_back(0); // parametr ignorowany
+  frame.number(0); // parametr ignorowany
 
-  stringParams.push_back(text + "\r");
+  frame.line(text);
 
-  execute(intParams, "#w", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::saleReceipt(const Id &id, const SaleReceiptData &data)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("#g");
 
-  intParams.push_back(data.printId);
-  intParams.push_back((int)data.printOption);
+  frame.number(data.printId);
+  frame.number((int)data.printOption);
 
-  stringParams.push_back(id.printerId + "\r");
-  stringParams.push_back(id.operatorId + "\r");
+  frame.line(id.printerId);
+  frame.line(id.operatorId);
 
-  stringParams.push_back(data.receipt + "\r");
+  frame.line(data.receipt);
 
-  stringParams.push_back(data.clientName + "\r");
-  stringParams.push_back(data.terminal + "\r");
-  stringParams.push_back(data.cardName + "\r");
-  stringParams.push_back(data.cardNr + "\r");
+  frame.line(data.clientName);
+  frame.line(data.terminal);
+  frame.line(data.cardName);
+  frame.line(data.cardNr);
 
-  stringParams.push_back(fromInt(data.month) + "\r");
-  stringParams.push_back(fromInt(data.year) + "\r");
+  frame.line(fromInt(data.month));
+  frame.line(fromInt(data.year));
 
-  stringParams.push_back(data.authCode + "\r");
+  frame.line(data.authCode);
 
-  stringParams.push_back(fromFloat(data.amount) + "/");
+  frame.amount(data.amount);
 
-  execute(intParams, "#g", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::returnOfArticle(const Id &id, const SaleReceiptData &data)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  Frame frame("#h");
 
-  intParams.push_back(data.printId);
-  intParams.push_back((int)data.printOption);
+  frame.number(data.printId);
+  frame.number((int)data.printOption);
 
-  stringParams.push_back(id.printerId + "\r");
-  stringParams.push_back(id.operatorId + "\r");
+  frame.line(id.printerId);
+  frame.line(id.operatorId);
 
-  stringParams.push_back(data.receipt + "\r");
+  frame.line(data.receipt);
 
-  stringParams.push_back(data.clientName + "\r");
-  stringParams.push_back(data.terminal + "\r");
-  stringParams.push_back(data.cardName + "\r");
-  stringParams.push_back(data.cardNr + "\r");
+  frame.line(data.clientName);
+  frame.line(data.terminal);
+  frame.line(data.cardName);
+  frame.line(data.cardNr);
 
-  stringParams.push_back(fromInt(data.month) + "\r");
-  stringParams.push_back(fromInt(data.year) + "\r");
+  frame.line(fromInt(data.month));
+  frame.line(fromInt(data.year));
 
-  stringParams.push_back(data.authCode + "\r");
+  frame.line(data.authCode);
 
-  stringParams.push_back(fromFloat(data.amount) + "/");
+  frame.amount(data.amount);
 
-  execute(intParams, "#h", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::beginNonFiscal(int printNr, int headerNr)
 {
-  vector<int> intParams;
+  checkState(TS_IDLE, TS_IDLE, 1031); // rozkaz wysłany w niewłaściwym trybie
+
+  command::NonFiscalArgs args;
 
-  intParams.push_back(0); // stała
+  args.printNr = printNr;
+  args.headerNr = headerNr;
 
-  intParams.push_back(printNr);
-  intParams.push_back(headerNr);
+  Frame frame = command::serialize<command::BeginNonFiscal>(args);
 
-  execute(intParams, "$w", true);
+  execute(frame);
+
+  state = TS_NON_FISCAL;
+  nonFiscal = true;
 }
 
 
 void FiscalPrinter::printNonFiscal(const NonFiscalLine &line)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
-
-  intParams.push_back(line.printNr);
-  intParams.push_back(line.lineNr);
-
-  intParams.push_back((int)line.bold);
-  intParams.push_back((int)line.inverse);
-
-  intParams.push_back(line.font);
-
-  intParams.push_back((int)line.center);
-
-  intParams.push_back((int)line.attrs);
+  checkState(TS_NON_FISCAL, TS_NON_FISCAL, 1031); // rozkaz wysłany w niewłaściwym trybie
 
-  for (size_t i = 0; i < line.lines.size(); ++i)
-  {
-    stringParams.push_back(line.lines[i] + "\r");
-  }
+  Frame frame = command::serialize<command::PrintNonFiscal>(line);
 
-  execute(intParams, "$w", stringParams, true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::finishNonFiscal(int printNr, const string &sysNr, const ExtraLines &extraLines)
 {
-  vector<int> intParams;
-  vector<string> stringParams;
+  checkState(TS_NON_FISCAL, TS_NON_FISCAL, 1031); // rozkaz wysłany w niewłaściwym trybie
 
-  intParams.push_back(1); // stała
+  command::NonFiscalArgs args;
 
-  intParams.push_back(printNr);
-  intParams.push_back(sysNr.empty() ? 0 : 1);
-  intParams.push_back(extraLines.count());
+  args.printNr = printNr;
+  args.sysNr = &sysNr;
+  args.extraLines = &extraLines;
 
-  stringParams.push_back(sysNr + "\r");
+  Frame frame = command::serialize<command::FinishNonFiscal>(args);
 
-  switch (extraLines.count())
-  {
-  case 1:
-    stringParams.push_back(extraLines.line1 + "\r");
-    break;
+  execute(frame);
 
-  case 2:
-    stringParams.push_back(extraLines.line1 + "\r");
-    stringParams.push_back(extraLines.line2 + "\r");
-    break;
+  state = TS_IDLE;
+  nonFiscal = false;
+}
 
-  case 3:
-    stringParams.push_back(extraLines.line1 + "\r");
-    stringParams.push_back(extraLines.line2 + "\r");
-    stringParams.push_back(extraLines.line3 + "\r");
-    break;
 
-  default:
-    break;
+void FiscalPrinter::abortNonFiscal(int printNr)
+{
+  try
+  {
+    finishNonFiscal(printNr, "", ExtraLines::none());
   }
+  catch (const std::exception &)
+  {
+    // bez tego każdy kolejny paragon byłby odrzucany z kodem 1031
 
-  execute(intParams, "$w", stringParams, true);
+    state = TS_UNKNOWN;
+    nonFiscal = false;
+  }
 }
 
 
 void FiscalPrinter::setClientId(CLIENT_ID_TYPE clientIdType, const string &clientId)
 {
+  if (validation)
+  {
+    ValidationErrors errors;
+
+    validateClientId(clientIdType, clientId, errors);
+
+    require(errors);
+  }
+
   if (clientIdType != CIDT_NONE)
   {
-    vector<int> intParams;
-    vector<string> stringParams;
+    Frame frame("$z");
 
-    intParams.push_back(100); // stała
+    frame.number(100); // stała
 
-    intParams.push_back((int)clientIdType);
+    frame.number((int)clientIdType);
 
-    stringParams.push_back(clientId + "\r");
+    frame.line(clientId);
 
-    execute(intParams, "$z", true);
+    execute(frame);
   }
 }
 
 
 void FiscalPrinter::descriptorsReport()
 {
-  vector<int> intParams;
+  Frame frame("@d");
 
-  intParams.push_back(1); // parametr ignorowany
+  frame.number(1); // parametr ignorowany
 
-  execute(intParams, "@d", true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::paperFeed(int lines)
 {
-  vector<int> intParams;
+  Frame frame("#l");
 
-  intParams.push_back(lines);
+  frame.number(lines);
 
-  execute(intParams, "#l", true);
+  execute(frame);
 }
 
 
 void FiscalPrinter::debugGenerateError()
 {
-  execute("#l", false);
+  Frame frame("#l", false);
+
+  execute(frame);
 }
 
 
-string FiscalPrinter::fromFloat(float number)
+void FiscalPrinter::checkState(TRANSACTION_STATE allowed1, TRANSACTION_STATE allowed2, int code)
 {
-  stringstream stream;
-  stream << number;
-  return stream.str();
+  if (!stateTracking)
+  {
+    return;
+  }
+
+  if (state == TS_UNKNOWN)
+  {
+    syncState();
+  }
+
+  if (state != TS_UNKNOWN && state != allowed1 && state != allowed2)
+  {
+    require(ValidationErrors(1, ValidationError("state", code)));
+  }
 }
 
 
-string FiscalPrinter::fromInt(int number)
+void FiscalPrinter::checkExtraLines(const EncodedExtraLines &extraLines)
 {
-  return lexical_cast<string>(number);
+  if (!extraLinesCheck || extraLines.isEmpty())
+  {
+    return;
+  }
+
+  if (!extraLinesStored)
+  {
+    storedExtraLines = extraLines;
+    extraLinesStored = true;
+  }
+  else if (extraLines != storedExtraLines)
+  {
+    throw std::invalid_argument("fp::FiscalPrinter: extra lines differ from the lines stored after the daily report");
+  }
 }
 
 
-string FiscalPrinter::fromLong(long number)
+void FiscalPrinter::execute(Frame &frame)
 {
-  return lexical_cast<string>(number);
+  write(frame.str());
 }
 
 
-std::string FiscalPrinter::toMazovia(const std::string &text)
+string FiscalPrinter::read()
 {
-  string result;
-
-  for (size_t i = 0; i < text.size(); ++i)
+  if (port && io)
   {
-    switch ((char)text[i])
-    {
-
-    case (char)0xc3: // kod kontrolny utf8
+    if (port->is_open())
     {
-      if (i + 1 < text.size())
+      while (!decoder.hasFrame())
       {
-        switch ((char)text[i + 1])
-        {
-
-        case (char)0x93: result.push_back((char)0xa3); break; // Ó
-        case (char)0xb3: result.push_back((char)0xa2); break; // ó
+        // odczyt tylu bajtów, ile jest dostępnych (nie po jednym bajcie)
+        receive();
+      }
 
-        default:
-          break; // pomijamy
-        }
+      // zawartość ramki ze znacznikiem końca (parsery otrzymują odpowiedź w dotychczasowej postaci)
+      string result = decoder.takeFrame() + "\x1b\\";
 
-        ++i;
-      }
+#ifdef DEBUG_FISCAL_PRINTER
+      std::cout << ">>> " << result << std::endl;
+#endif
 
-      break;
+      return result;
     }
+  }
 
-    case (char)0xc4: // kod kontrolny utf8
-    {
-      if (i + 1 < text.size())
-      {
-        switch ((char)text[i + 1])
-        {
-
-        case (char)0x84: result.push_back((char)0x8f); break; // Ą
-        case (char)0x86: result.push_back((char)0x95); break; // Ć
-        case (char)0x98: result.push_back((char)0x90); break; // Ę
-        case (char)0x85: result.push_back((char)0x86); break; // ą
-        case (char)0x87: result.push_back((char)0x8d); break; // ć
-        case (char)0x99: result.push_back((char)0x91); break; // ę
+  return string();
+}
 
-        default:
-          break; // pomijamy
-        }
 
-        ++i;
+char FiscalPrinter::readOneByte()
+{
+  if (port && io)
+  {
+    if (port->is_open())
+    {
+      while (!decoder.hasStatus())
+      {
+        receive();
       }
 
-      break;
+      return decoder.takeStatus();
     }
+  }
+
+  return 0;
+}
 
-    case (char)0xc5: // kod kontrolny utf8
+
+void FiscalPrinter::write(const string &str)
+{
+  if (port && io)
+  {
+    if (port->is_open())
     {
-      if (i + 1 < text.size())
+      long seq = 0;
+
+      if (journal != NULL)
       {
-        switch ((char)text[i + 1])
-        {
+        seq = journal->append(str);
+      }
 
-        case (char)0x81: result.push_back((char)0x9c); break; // Ł
-        case (char)0x83: result.push_back((char)0xa5); break; // Ń
-        case (char)0x9a: result.push_back((char)0x98); break; // Ś
-        case (char)0xb9: result.push_back((char)0xa0); break; // Ź
-        case (char)0xbb: result.push_back((char)0xa1); break; // Ż
-        case (char)0x82: result.push_back((char)0x92); break; // ł
-        case (char)0x84: result.push_back((char)0xa4); break; // ń
-        case (char)0x9b: result.push_back((char)0x9e); break; // ś
-        case (char)0xba: result.push_back((char)0xa6); break; // ź
-        case (char)0xbc: result.push_back((char)0xa7); break; // ż
-
-        default:
-          break; // pomijamy
+      try
+      {
+        writeBytes(str.data(), str.size());
+      }
+      catch (const std::exception &e)
+      {
+        if (journal != NULL)
+        {
+          journal->fail(seq, e.what());
         }
 
-        ++i;
+        state = TS_UNKNOWN;
+
+        throw;
       }
 
-      break;
-    }
+      if (journal != NULL)
+      {
+        journal->complete(seq);
+      }
 
-    default: // inny znak uft8
-      result.push_back(text[i]);
-      break;
+#ifdef DEBUG_FISCAL_PRINTER
+      std::cout << "<<< " << str << std::endl;
+#endif
 
+      return;
     }
   }
-
-  return result;
 }
 
 
-void FiscalPrinter::execute(const vector<int> &intParams, const string &cmd,
-  const vector<string> &stringParams, bool appendCtrlByte)
+void FiscalPrinter::writeOneByte(char c)
 {
-  string content = "";
-
-  if (intParams.size())
+  if (port && io)
   {
-    for (size_t i = 0; i < intParams.size(); ++i)
+    if (port->is_open())
     {
-      content += lexical_cast<string>(intParams[i]) + ";";
-    }
+      writeBytes(&c, 1);
 
-    content = content.substr(0, content.size() - 1); // usunięcie ostatniego znaku ';'
+      return;
+    }
   }
+}
 
-  content += cmd;
 
-  for (size_t i = 0; i < stringParams.size(); ++i)
+void FiscalPrinter::receive()
+{
+  char buffer[64];
+  size_t n = 0;
+
+  if (yield != NULL)
   {
-    content += toMazovia(stringParams[i]);
+    n = port->async_read_some(boost::asio::buffer(buffer, sizeof(buffer)), *yield);
   }
-
-  if (appendCtrlByte)
+  else
   {
-    content += calculateCtrlByte(content);
+    n = port->read_some(boost::asio::buffer(buffer, sizeof(buffer)));
   }
 
-  write(string("\x1bP") + content + string("\x1b\\"));
+  bool stopped = decoder.isStopped();
+
+  decoder.feed(buffer, n);
+
+  if (decoder.isStopped() != stopped)
+  {
+    flowControlChanged();
+  }
 }
 
 
-void FiscalPrinter::execute(const string &cmd, bool appendCtrlByte)
+void FiscalPrinter::resetDecoder()
 {
-  string content = "";
+  bool stopped = decoder.isStopped();
 
-  content += cmd;
+  decoder.reset();
 
-  if (appendCtrlByte)
+  if (stopped)
   {
-    content += calculateCtrlByte(content);
+    flowControlChanged();
   }
-
-  write(string("\x1bP") + content + string("\x1b\\"));
 }
 
 
-void FiscalPrinter::execute(const vector<int> &intParams, const string &cmd, bool appendCtrlByte)
+void FiscalPrinter::flowControlChanged()
 {
-  string content = "";
+  boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
 
-  if (intParams.size())
+  if (decoder.isStopped())
   {
-    for (size_t i = 0; i < intParams.size(); ++i)
-    {
-      content += lexical_cast<string>(intParams[i]) + ";";
-    }
-
-    content = content.substr(0, content.size() - 1); // usunięcie ostatniego znaku ';'
+    stallStart = now;
   }
-
-  content += cmd;
-
-  if (appendCtrlByte)
+  else
   {
-    content += calculateCtrlByte(content);
+    stallTime += (long)(now - stallStart).total_microseconds();
   }
 
-  write(string("\x1bP") + content + string("\x1b\\"));
+  if (flowControlHandler)
+  {
+    flowControlHandler(decoder.isStopped());
+  }
 }
 
 
-void FiscalPrinter::execute(const string &cmd, const vector<string> &stringParams, bool appendCtrlByte)
+void FiscalPrinter::waitForXon()
 {
-  string content = "";
-
-  content += cmd;
-
-  for (size_t i = 0; i < stringParams.size(); ++i)
+  if (yield != NULL)
   {
-    content += toMazovia(stringParams[i]);
-  }
+    receive();
 
-  if (appendCtrlByte)
-  {
-    content += calculateCtrlByte(content);
+    return;
   }
 
-  write(string("\x1bP") + content + string("\x1b\\"));
-}
+  int timeout = -1;
 
+  if (serialSettings.stallTimeout > 0)
+  {
+    long stalled = (long)(boost::posix_time::microsec_clock::universal_time() - stallStart).total_milliseconds();
 
-string fp::FiscalPrinter::calculateCtrlByte(const string &str)
-{
-  char byte = 0xff;
+    if (stalled >= serialSettings.stallTimeout)
+    {
+      throw boost::system::system_error(ETIMEDOUT, boost::system::system_category(), "XOFF");
+    }
 
-  for (string::const_iterator i = str.begin(); i != str.end(); i++)
-  {
-    byte ^= lexical_cast<char>(*i);
+    timeout = serialSettings.stallTimeout - stalled;
   }
 
-  stringstream stream;
-  stream << std::uppercase << std::hex << static_cast<unsigned int>(byte);
+  struct pollfd pfd;
 
-  string s = stream.str();
+  pfd.fd = port->native_handle();
+  pfd.events = POLLIN;
+  pfd.revents = 0;
 
-  if (s.size() > 2)
+  int result = ::poll(&pfd, 1, timeout);
+
+  if (result == -1 && errno != EINTR)
   {
-    return s.substr(s.size() - 2);
+    throw boost::system::system_error(errno, boost::system::system_category(), "poll");
   }
 
-  return s;
+  if (result > 0)
+  {
+    receive();
+  }
 }
 
 
-string FiscalPrinter::read()
+void FiscalPrinter::writeBytes(const char *data, size_t size)
 {
-  if (port && io)
+  // przy obsłudze XON/XOFF przez bibliotekę ramka jest wysyłana porcjami,
+  // XOFF odebrany w trakcie ramki wstrzymuje wysłanie kolejnej porcji
+
+  size_t chunk = serialSettings.userFlowControl ? 16 : size;
+
+  while (size > 0)
   {
-    if (port->is_open())
+    if (serialSettings.userFlowControl)
     {
-      char c = 0;
-      string result = "";
-      while (true)
-      {
-        boost::asio::read(*port, boost::asio::buffer(&c, 1));
-        result.append(lexical_cast<string>(c));
-        if (result.size() >=2)
-        {
-          if (c == '\\' && result[result.size() - 2] == (char)0x1b)
-          {
-            break;
-          }
-        }
-      }
+      pollFlowControl();
 
-      size_t pos = result.find("\x1bP");
-      if (pos != string::npos)
+      while (decoder.isStopped())
       {
-        result = result.substr(pos + 2);
+        waitForXon();
       }
+    }
 
-      // ta linia jest zbedna po zaaplikowaniu latki
-      // result = boost::regex_replace(result, boost::regex("1`"), "");
-
-#ifdef DEBUG_FISCAL_PRINTER
-      std::cout << ">>> " << result << std::endl;
-#endif
+    size_t n = std::min(size, chunk);
 
-      return result;
+    if (yield != NULL)
+    {
+      boost::asio::async_write(*port, boost::asio::buffer(data, n), *yield);
+    }
+    else
+    {
+      boost::asio::write(*port, boost::asio::buffer(data, n));
     }
-  }
 
-  return string();
+    data += n;
+    size -= n;
+  }
 }
 
 
-char FiscalPrinter::readOneByte()
+void FiscalPrinter::applySerialOptions(const string &device, const SerialOptions &options)
 {
-  if (port && io)
+  int fd = port->native_handle();
+
+  if (options.userFlowControl)
   {
-    if (port->is_open())
-    {
-      char result = 0;
-      boost::asio::read(*port, boost::asio::buffer(&result, 1));
+    // XON/XOFF trafiają do dekodera odpowiedzi, sterownik nie wstrzymuje nadawania
 
-      return result;
-    }
+    port->set_option<>(serial_port::flow_control(serial_port::flow_control::none));
   }
 
-  return 0;
-}
-
+  serialSettings.userFlowControl = options.userFlowControl;
+  serialSettings.stallTimeout = options.stallTimeout;
 
-void FiscalPrinter::write(const string &str)
-{
-  if (port && io)
+  if (options.lowLatency)
   {
-    if (port->is_open())
-    {
-      boost::asio::write(*port, boost::asio::buffer(str));
+    struct serial_struct serial;
 
-#ifdef DEBUG_FISCAL_PRINTER
-      std::cout << "<<< " << str << std::endl;
-#endif
+    if (::ioctl(fd, TIOCGSERIAL, &serial) == 0)
+    {
+      serial.flags |= ASYNC_LOW_LATENCY;
 
-      return;
+      if (::ioctl(fd, TIOCSSERIAL, &serial) != 0)
+      {
+        serialSettings.errors.push_back(string("TIOCSSERIAL: ") + strerror(errno));
+      }
+    }
+    else
+    {
+      serialSettings.errors.push_back(string("TIOCGSERIAL: ") + strerror(errno));
     }
   }
-}
 
+  struct serial_struct serial;
 
-void FiscalPrinter::writeOneByte(char c)
-{
-  if (port && io)
+  if (::ioctl(fd, TIOCGSERIAL, &serial) == 0)
   {
-    if (port->is_open())
+    serialSettings.lowLatency = (serial.flags & ASYNC_LOW_LATENCY) != 0;
+  }
+
+  // konwertery FTDI: /sys/bus/usb-serial/devices/ttyUSBn/latency_timer
+
+  char resolved[PATH_MAX];
+
+  if (::realpath(device.c_str(), resolved) != NULL)
+  {
+    string name = resolved;
+
+    name = name.substr(name.rfind('/') + 1);
+
+    string path = "/sys/bus/usb-serial/devices/" + name + "/latency_timer";
+
+    if (::access(path.c_str(), F_OK) == 0)
     {
-      boost::asio::write(*port, boost::asio::buffer(&c, 1));
+      serialSettings.latencyTimerPath = path;
 
-      return;
+      if (options.latencyTimer > 0)
+      {
+        std::ofstream out(path.c_str());
+
+        out << options.latencyTimer << std::endl;
+
+        if (!out)
+        {
+          serialSettings.errors.push_back("latency_timer: " + path);
+        }
+      }
+
+      std::ifstream in(path.c_str());
+
+      if (!(in >> serialSettings.latencyTimer))
+      {
+        serialSettings.latencyTimer = -1;
+      }
     }
   }
 }
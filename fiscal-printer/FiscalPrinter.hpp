@@ -27,12 +27,21 @@
 
 
 #include <fiscal-printer/Common.hpp>
+#include <fiscal-printer/Frame.hpp>
+#include <fiscal-printer/FrameDecoder.hpp>
+#include <fiscal-printer/InfoView.hpp>
+
+#include <boost/function.hpp>
 
 
 namespace fp
 {
 
 
+class Journal;
+class SalesJournal;
+
+
 /// Obsługa drukarek fiskalnych firmy NOVITUS/POSNET obsługujących protokół POSNET.
 /**
     @note Na podstawie opisu protokołu komunikacyjnego drukarek fiskalnych
@@ -45,9 +54,70 @@ class FiscalPrinter
 
 public:
 
+  typedef boost::function<void (bool)> FlowControlHandler;
+
+  typedef boost::function<void (const boost::system::system_error &)> SalesJournalErrorHandler;
+
   FiscalPrinter();
+
+  /// Konstruktor z zewnętrznym serwisem asio.
+  /**
+      @param io Serwis używany przez port (nie jest zwalniany przez drukarkę)
+
+      @note Wiele drukarek może korzystać z jednego serwisu obsługiwanego przez jeden wątek
+            (zobacz FiscalPrinter::AsyncScope).
+   */
+  explicit FiscalPrinter(boost::asio::io_service &io);
+
   ~FiscalPrinter();
 
+  /// Wykonywanie rozkazów we współprogramie (boost::asio::spawn).
+  /**
+      W czasie istnienia obiektu odczyt i zapis portu są asynchroniczne: w oczekiwaniu na
+      drukarkę współprogram jest zawieszany, a wątek serwisu obsługuje inne drukarki.
+      Metody drukarki wołane są tak samo, jak w trybie blokującym:
+
+      @code
+      void receipt(fp::FiscalPrinter *printer, const fp::Item *item, boost::asio::yield_context yield)
+      {
+        fp::FiscalPrinter::AsyncScope scope(*printer, yield);
+
+        printer->beginTransaction(0, fp::ExtraLines::none(), fp::CIDT_NONE, "");
+        printer->printReceiptLine(*item);
+        ...
+      }
+
+      boost::asio::spawn(io, boost::bind(receipt, &printer, &item, _1));
+      @endcode
+
+      @note Współprogram powinien obsługiwać wiele rozkazów (n.p. jeden współprogram na drukarkę
+            odbierający kolejne paragony), stos współprogramu jest alokowany przy jego tworzeniu.
+
+      @note Serwis musi być obsługiwany (io_service::run) przez wątek współprogramu.
+   */
+  class AsyncScope
+  {
+
+  public:
+
+    AsyncScope(fp::FiscalPrinter &printer, boost::asio::yield_context yield);
+    ~AsyncScope();
+
+  private:
+
+    fp::FiscalPrinter &printer;
+
+    boost::asio::yield_context yield;
+    boost::asio::yield_context *previous;
+
+  }; // class AsyncScope
+
+  /// Serwis asio portu.
+  /**
+      @note Dla konstruktora domyślnego serwis istnieje dopiero po otwarciu portu.
+   */
+  boost::asio::io_service &getIoService();
+
   /// Otwórz port.
   /**
       @param device Nazwa urządzenia (n.p. "/dev/ttyS0" lub "/dev/ttyUSB0")
@@ -62,12 +132,195 @@ public:
   */
   void open(const std::string &device, int baudRate = 9600);
 
+  /// Otwórz port z ustawieniami zmniejszającymi opóźnienia.
+  /**
+      @param device Nazwa urządzenia
+      @param baudRate Prędkość transmisji
+      @param options Ustawienia portu
+
+      @note Ustawienia, których nie udało się zastosować (n.p. brak uprawnień do zapisu
+            'latency_timer'), nie powodują błędu otwarcia. Zastosowane ustawienia zwraca
+            FiscalPrinter::getSerialSettings.
+   */
+  void open(const std::string &device, int baudRate, const fp::SerialOptions &options);
+
+  /// Otwórz port z wykryciem prędkości transmisji drukarki.
+  /**
+      Prędkości są sprawdzane od najszybszej: dla każdej wysyłany jest ENQ i oczekiwana jest
+      poprawna odpowiedź (0x60..0x6F). Po zmianie prędkości w ustawieniach drukarki aplikacja
+      nie wymaga zmian.
+
+      @param device Nazwa urządzenia
+      @param baudRates Prędkości do sprawdzenia (pusty wektor - FiscalPrinter::defaultBaudRates)
+      @param timeout Czas oczekiwania na odpowiedź dla jednej prędkości (w milisekundach)
+      @param options Ustawienia portu
+
+      @return Wykryta prędkość lub 0 (port jest wtedy zamykany)
+
+      @note Protokół nie udostępnia rozkazu zmiany prędkości transmisji, prędkość ustawia się
+            w menu serwisowym drukarki.
+   */
+  int openAutoBaud(const std::string &device, const std::vector<int> &baudRates = std::vector<int>(),
+    int timeout = 300, const fp::SerialOptions &options = fp::SerialOptions());
+
+  /// Prędkości sprawdzane przez FiscalPrinter::openAutoBaud (od najszybszej).
+  static std::vector<int> defaultBaudRates();
+
+  /// Sprawdzenie, czy drukarka odpowiada na ENQ w określonym czasie.
+  /**
+      @param timeout Czas oczekiwania w milisekundach
+
+      @note W przeciwieństwie do FiscalPrinter::getEnqStatus metoda nie blokuje się, gdy drukarka
+            nie odpowiada (n.p. przy niezgodnej prędkości transmisji).
+
+      @note Dane oczekujące w buforach portu są odrzucane.
+
+      @note Drukarka musi dwa razy z rzędu odpowiedzieć pojedynczym bajtem statusu, bez innych
+            bajtów (przypadkowe bajty przy niezgodnej prędkości nie są uznawane za odpowiedź).
+   */
+  bool probe(int timeout = 300);
+
+  /// Ustawienia portu zastosowane przy ostatnim otwarciu.
+  fp::SerialSettings getSerialSettings() const;
+
+  /// Pomiar czasu odpowiedzi drukarki na ENQ.
+  /**
+      @param probes Ilość pomiarów
+
+      @return Średni czas od wysłania ENQ do odebrania statusu w mikrosekundach
+
+      @note Pozwala porównać ustawienia portu (FiscalPrinter::open z SerialOptions).
+   */
+  long measureEnqRoundTrip(int probes = 20);
+
+  /// Statystyki odbioru (ilość utrat synchronizacji, pominięte bajty).
+  /**
+      @note Rosnąca ilość utrat synchronizacji wskazuje na zakłócenia na linii.
+   */
+  fp::FrameDecoderStats getFrameDecoderStats() const;
+
+  /// Czy drukarka wstrzymała nadawanie znakiem XOFF (bufor wydruku jest pełny).
+  /**
+      @note Tylko z SerialOptions::userFlowControl, w przeciwnym razie XON/XOFF obsługuje sterownik
+            i zapis po prostu blokuje się w sterowniku.
+   */
+  bool isFlowStopped() const;
+
+  /// Odczyt bajtów oczekujących w porcie bez czekania (aktualizacja stanu XON/XOFF).
+  void pollFlowControl();
+
+  /// Ustawienie funkcji wołanej przy zmianie stanu XON/XOFF (true - drukarka wstrzymała nadawanie).
+  /**
+      @note Funkcja jest wołana z wątku wykonującego rozkazy drukarki.
+   */
+  void setFlowControlHandler(const FlowControlHandler &handler);
+
+  /// Łączny czas wstrzymania nadawania przez drukarkę w mikrosekundach.
+  long getStallTime() const;
+
+  /// Czas wstrzymania nadawania od rozpoczęcia ostatniej transakcji (FiscalPrinter::beginTransaction) w mikrosekundach.
+  long getTransactionStallTime() const;
+
+  /// Sprawdzanie danych rozkazów przed wysłaniem (fp::validate).
+  /**
+      Po włączeniu rozkazy z danymi przekraczającymi ograniczenia z dokumentacji (długości pól
+      w Mazovia, zakresy wartości) kończą się wyjątkiem fp::PrinterException z kodem błędu, który
+      zgłosiłaby drukarka, bez wysyłania ramki i bez odpytywania drukarki rozkazem #n.
+
+      Sprawdzane są: linie paragonu, identyfikator nabywcy, nagłówek, rozpoczęcie faktury,
+      nazwy form płatności (1), raport zmianowy i identyfikator kasy/kasjera w zatwierdzeniu
+      transakcji (przeciążenia z fp::Id). Identyfikator zakodowany przez aplikację jest sprawdzany
+      przy tworzeniu fp::EncodedId, niezależnie od tego ustawienia.
+   */
+  void setValidation(bool enabled);
+
+  /// Śledzenie stanu transakcji w bibliotece.
+  /**
+      Po włączeniu biblioteka pamięta, czy drukarka jest w trakcie paragonu, faktury lub wydruku
+      niefiskalnego, i odrzuca rozkazy niedozwolone w bieżącym stanie wyjątkiem fp::PrinterException
+      z kodem błędu, który zgłosiłaby drukarka (n.p. 1002 'Paragon już jest rozpoczęty',
+      21 'Paragon nie został rozpoczęty'), bez wysyłania ramki.
+
+      Stan jest nieznany po otwarciu portu, po błędzie zapisu i po odczytaniu niezerowego kodu
+      błędu (FiscalPrinter::getLastError). Wtedy przed kolejnym sprawdzanym rozkazem jest ustalany
+      z CashRegisterInfo6::transaction (jeden dodatkowy rozkaz #s).
+
+      @note Wydruk niefiskalny nie jest widoczny w CashRegisterInfo6, dlatego rozpoczęty wydruk
+            niefiskalny (FiscalPrinter::beginNonFiscal) jest pamiętany do FiscalPrinter::finishNonFiscal
+            także wtedy, gdy stan stał się nieznany (również po ponownym otwarciu portu).
+   */
+  void setStateTracking(bool enabled);
+
+  /// Stan transakcji (TS_UNKNOWN, jeśli śledzenie jest wyłączone lub stan nie został ustalony).
+  fp::TRANSACTION_STATE getState() const;
+
+  /// Ustalenie stanu transakcji z CashRegisterInfo6.
+  fp::TRANSACTION_STATE syncState();
+
+  /// Czy kasjer jest zalogowany (FiscalPrinter::login) od otwarcia portu.
+  bool isCashierLoggedIn() const;
+
+  /// Kontrola linii dodatkowych zapamiętanych przez drukarkę po raporcie dobowym.
+  /**
+      Drukarka zapamiętuje linie dodatkowe z pierwszego paragonu po raporcie dobowym i bez zgłaszania
+      błędu ignoruje inne linie na kolejnych paragonach. Po włączeniu kontroli linie są zapamiętywane
+      również w bibliotece, a rozkaz z innymi liniami kończy się wyjątkiem std::invalid_argument
+      (zanim zostanie wysłany). Porównywane są zakodowane bajty, więc najtaniej jest używać
+      jednego obiektu EncodedExtraLines dla wszystkich paragonów.
+
+      @note Zapamiętane linie są zapominane po FiscalPrinter::printDailyReport i przy każdym wywołaniu tej metody
+            (n.p. po raporcie dobowym wykonanym z klawiatury drukarki).
+
+      @note Nie należy włączać kontroli, jeśli w konfiguracji drukarki linia dodatkowa jest numerem systemowym.
+   */
+  void setExtraLinesCheck(bool enabled);
+
   /// Zamknij port.
   /**
       @note Metoda wołana w destruktorze.
    */
   void close();
 
+  /// Czy port jest otwarty.
+  bool isOpen() const;
+
+  /// Ustawienie dziennika rozkazów.
+  /**
+      @param journal Dziennik (jeśli NULL, to rozkazy nie są zapisywane)
+
+      @note Każda ramka jest zapisywana do dziennika przed wysłaniem do drukarki.
+
+      @note Obiekt dziennika nie jest zwalniany przez drukarkę.
+
+      @see Journal
+   */
+  void setJournal(fp::Journal *journal);
+
+  /// Ustawienie dziennika sprzedaży.
+  /**
+      @param salesJournal Dziennik (jeśli NULL, to paragony nie są zapisywane)
+
+      @note Sumy linii paragonu (FiscalPrinter::printReceiptLine) według stawek PTU, razem z rabatami
+            (FiscalPrinter::addDiscount, FiscalPrinter::addVatRateDiscount, FiscalPrinter::addSubtotalDiscount),
+            są zapisywane po zatwierdzeniu transakcji potwierdzonym statusem ENQ (dodatkowe zapytanie ENQ
+            po rozkazie zatwierdzenia), a raport dobowy jest zapisywany po wysłaniu rozkazu
+            FiscalPrinter::printDailyReport.
+
+      @note Błąd zapisu do dziennika nie przerywa zatwierdzenia (paragon jest już wydrukowany), tylko jest
+            przekazywany do funkcji ustawionej przez FiscalPrinter::setSalesJournalErrorHandler.
+
+      @note Obiekt dziennika nie jest zwalniany przez drukarkę.
+
+      @see SalesJournal
+   */
+  void setSalesJournal(fp::SalesJournal *salesJournal);
+
+  /// Ustawienie funkcji wołanej po błędzie zapisu do dziennika sprzedaży.
+  /**
+      @note Funkcja jest wołana z wątku wykonującego rozkazy drukarki.
+   */
+  void setSalesJournalErrorHandler(const SalesJournalErrorHandler &handler);
+
   /// Sygnał dźwiękowy (BEL).
   void bell();
 
@@ -134,6 +387,21 @@ public:
    */
   fp::CashRegisterInfo2 getCashRegisterInfo2(fp::CASH_REGISTER_INFO_2_MODE mode, bool invoices);
 
+  /// Informacje kasowe (1) (#s) bez parsowania całej odpowiedzi.
+  /**
+      Pola są parsowane przy pierwszym odczycie (n.p. pętla sprawdzająca tylko
+      CashRegisterInfoView::transaction nie parsuje stawek i totalizerów).
+
+      @see FiscalPrinter::getCashRegisterInfo1
+   */
+  fp::CashRegisterInfo1View getCashRegisterInfo1View();
+
+  /// Informacje kasowe (2) (#s) bez parsowania całej odpowiedzi.
+  /**
+      @see FiscalPrinter::getCashRegisterInfo2, FiscalPrinter::getCashRegisterInfo1View
+   */
+  fp::CashRegisterInfo2View getCashRegisterInfo2View(fp::CASH_REGISTER_INFO_2_MODE mode, bool invoices);
+
   /// Żądanie odesłania informacji kasowych (3) (#s).
   /**
       Szczegółowe informacje na temat zajętości pamięci fiskalnej, wartość ostatniego
@@ -216,6 +484,24 @@ public:
    */
   fp::DeviceInfo2 getDeviceInfo2();
 
+  /// Odczyt informacji kasowych, zegara i informacji o urządzeniu w jednej wymianie.
+  /**
+      Rozkazy FiscalPrinter::getCashRegisterInfo1, 2, 3, 4 i 6, FiscalPrinter::getClock,
+      FiscalPrinter::getVersionInfo i FiscalPrinter::getDeviceInfo2 są wysyłane jeden za drugim,
+      bez czekania na odpowiedzi, a odpowiedzi są odczytywane po kolei. Czas odczytu to w przybliżeniu
+      jeden czas odpowiedzi drukarki i czas transmisji, zamiast ośmiu czasów odpowiedzi.
+
+      @param mode2 Tryb informacji kasowych (2)
+      @param invoices Informacje kasowe (2) dotyczą totalizerów faktur (przełącznik $r jest wysyłany przed pozostałymi rozkazami)
+      @param mode6 Tryb informacji kasowych (6)
+
+      @note Kod błędu ostatniego rozkazu jest zerowany.
+
+      @note Metoda czeka na wszystkie odpowiedzi drukarki.
+   */
+  fp::PrinterSnapshot getSnapshot(fp::CASH_REGISTER_INFO_2_MODE mode2 = fp::CRI2M_23, bool invoices = false,
+    fp::CASH_REGISTER_INFO_6_MODE mode6 = fp::CRI6M_0);
+
   /// Rozpoczęcie odczytu zawartości pamięci fiskalnej (rozpoczynając od daty) (#s).
   /**
       @param year Rok <0;99>
@@ -385,6 +671,10 @@ public:
   void beginTransaction(int items, const fp::ExtraLines &extraLines, fp::CLIENT_ID_TYPE clientIdType,
     const std::string &clientId);
 
+  /// Rozpoczęcie transakcji ($h) z liniami dodatkowymi zakodowanymi wcześniej.
+  void beginTransaction(int items, const fp::EncodedExtraLines &extraLines, fp::CLIENT_ID_TYPE clientIdType,
+    const std::string &clientId);
+
   /// Drukuj linię paragonu ($l).
   /**
       @param item Linia paragonu
@@ -395,6 +685,31 @@ public:
   */
   void printReceiptLine(const fp::Item &item);
 
+  /// Zakodowanie stałych części linii paragonu.
+  /**
+      @param item Linia paragonu (pola 'line', 'quantity' i 'gross' są pomijane)
+
+      @note Pola tekstowe nie mogą zawierać znaków o kodach 0x01 i 0x02.
+
+      @note Przy włączonej walidacji sprawdzane są tylko pola zapisywane w szablonie (fp::validateItemTemplate).
+
+      @see ItemTemplateCache
+   */
+  fp::ItemTemplate makeItemTemplate(const fp::Item &item);
+
+  /// Drukuj linię paragonu na podstawie szablonu ($l lub ^l).
+  /**
+      @param itemTemplate Szablon linii
+      @param line Numer linii
+      @param quantity Ilość
+      @param gross Kwota brutto
+
+      @note Ramka jest identyczna z ramką wysyłaną przez printReceiptLine(const fp::Item &).
+
+      @note Przy włączonej walidacji sprawdzane są ilość i kwota brutto (fp::validateItemLine).
+   */
+  void printReceiptLine(const fp::ItemTemplate &itemTemplate, int line, const std::string &quantity, float gross);
+
   /// Obsługa kaucji w linii paragonu ($l).
   /**
       @param type Rodzaj kaucji
@@ -477,6 +792,10 @@ public:
   void confirmTransaction(const fp::Id &id, float cashIn, float total, fp::TRANSACTION_DISCOUNT_TYPE discountType,
     float discountValue, const fp::ExtraLines &extraLines);
 
+  /// Standardowe zatwierdzenie transakcji ($e) z identyfikatorem i liniami dodatkowymi zakodowanymi wcześniej.
+  void confirmTransaction(const fp::EncodedId &id, float cashIn, float total, fp::TRANSACTION_DISCOUNT_TYPE discountType,
+    float discountValue, const fp::EncodedExtraLines &extraLines);
+
   /// Zatwierdzenie transakcji z formami płatności (1) ($x).
   /**
       @param id Identyfikator kasy/kasjera
@@ -502,6 +821,10 @@ public:
   void confirmTransactionWithPaymentForms1(const fp::Id &id, const fp::PaymentFormsInfo1 &info, float total,
     fp::TRANSACTION_DISCOUNT_TYPE discountType, float discountValue, const fp::ExtraLines &extraLines);
 
+  /// Zatwierdzenie transakcji z formami płatności (1) ($x) z identyfikatorem i liniami dodatkowymi zakodowanymi wcześniej.
+  void confirmTransactionWithPaymentForms1(const fp::EncodedId &id, const fp::PaymentFormsInfo1 &info, float total,
+    fp::TRANSACTION_DISCOUNT_TYPE discountType, float discountValue, const fp::EncodedExtraLines &extraLines);
+
   /// Zatwierdzenie transakcji z formami płatności (2) ($y).
   /**
       @param id Identyfikator kasy/kasjera
@@ -530,6 +853,11 @@ public:
     float total, DISCOUNT_TYPE discountType, float discountValue, std::string sysNr, bool summary,
     const fp::ExtraLines &extraLines);
 
+  /// Zatwierdzenie transakcji z formami płatności (2) ($y) z identyfikatorem i liniami dodatkowymi zakodowanymi wcześniej.
+  void confirmTransactionWithPaymentForms2(const fp::EncodedId &id, const fp::PaymentFormsInfo2 &info,
+    float total, DISCOUNT_TYPE discountType, float discountValue, std::string sysNr, bool summary,
+    const fp::EncodedExtraLines &extraLines);
+
   /// Obsługa form płatności ($b).
   /**
       @param serviceType Akcja
@@ -817,6 +1145,19 @@ public:
    */
   void finishNonFiscal(int printNr, const std::string &sysNr, const fp::ExtraLines &extraLines);
 
+  /// Wydruk niefiskalny: zamknięcie wydruku przerwanego błędem ($w).
+  /**
+      @param printNr Numer wydruku (z dokumentacji)
+
+      Wysyła zakończenie wydruku bez numeru systemowego i dodatkowych linii. Jeśli zakończenie
+      się nie powiedzie (n.p. drukarka nie jest w trybie wydruku niefiskalnego albo połączenie
+      zostało utracone), to rozpoczęty wydruk nie jest dłużej pamiętany, a stan transakcji
+      zostanie ustalony ponownie przed kolejnym sprawdzanym rozkazem (FiscalPrinter::setStateTracking).
+
+      @note Metoda nie rzuca wyjątków.
+   */
+  void abortNonFiscal(int printNr);
+
   /// Identyfikator nabywcy ($z).
   /**
       @param clientIdType Typ identyfikatora nabywcy
@@ -848,18 +1189,31 @@ public:
 
 private:
 
-  std::string fromFloat(float number);
-  std::string fromInt(int number);
-  std::string fromLong(long number);
+  void execute(fp::Frame &frame);
+
+  void checkExtraLines(const fp::EncodedExtraLines &extraLines);
+
+  void checkState(fp::TRANSACTION_STATE allowed1, fp::TRANSACTION_STATE allowed2, int code);
 
-  std::string toMazovia(const std::string &text);
+  void updateState(const fp::CashRegisterInfo6 &info);
 
-  void execute(const std::vector<int> &intParams, const std::string &cmd, const std::vector<std::string> &stringParams, bool appendCtrlByte);
-  void execute(const std::string &cmd, bool appendCtrlByte);
-  void execute(const std::vector<int> &intParams, const std::string &cmd, bool appendCtrlByte);
-  void execute(const std::string &cmd, const std::vector<std::string> &stringParams, bool appendCtrlByte);
+  void addSale(const std::string &vat, boost::int64_t amount);
+  void addSale(int vat, boost::int64_t amount);
+  void recordSale();
+  void salesJournalError(const boost::system::system_error &e);
 
-  std::string calculateCtrlByte(const std::string &str);
+  static fp::TRANSACTION_STATE transactionState(int transaction);
+
+  static fp::CashRegisterInfo1 parseCashRegisterInfo1(const std::string &reply);
+  static fp::CashRegisterInfo2 parseCashRegisterInfo2(const std::string &reply);
+  static fp::CashRegisterInfo3 parseCashRegisterInfo3(const std::string &reply);
+  static fp::CashRegisterInfo4 parseCashRegisterInfo4(const std::string &reply);
+  static fp::CashRegisterInfo6 parseCashRegisterInfo6(const std::string &reply);
+  static fp::VersionInfo parseVersionInfo(const std::string &reply);
+  static fp::DeviceInfo2 parseDeviceInfo2(const std::string &reply);
+  static fp::ClockInfo parseClockInfo(const std::string &reply);
+
+  fp::Frame encodeReceiptLine(const fp::Item &item, const std::string &quantity, const std::string &gross);
 
   std::string read();
   char readOneByte();
@@ -867,9 +1221,53 @@ private:
   void write(const std::string &str);
   void writeOneByte(char c);
 
+  void receive();
+  void resetDecoder();
+  void flowControlChanged();
+  void waitForXon();
+  void writeBytes(const char *data, size_t size);
+
+  void applySerialOptions(const std::string &device, const fp::SerialOptions &options);
+
+  bool probeEnq(int fd, int timeout);
+
   boost::asio::io_service *io;
   boost::asio::serial_port *port;
 
+  bool ownIo;
+
+  boost::asio::yield_context *yield;
+
+  fp::FrameDecoder decoder;
+
+  FlowControlHandler flowControlHandler;
+
+  boost::posix_time::ptime stallStart;
+  long stallTime;
+  long transactionStallStart;
+
+  bool extraLinesCheck;
+  bool extraLinesStored;
+
+  bool validation;
+
+  bool stateTracking;
+
+  fp::TRANSACTION_STATE state;
+  bool nonFiscal; // rozpoczęty wydruk niefiskalny, niewidoczny w CashRegisterInfo6
+
+  bool cashierLoggedIn;
+
+  fp::EncodedExtraLines storedExtraLines;
+
+  fp::SerialSettings serialSettings;
+
+  fp::Journal *journal;
+
+  fp::SalesJournal *salesJournal;
+  SalesJournalErrorHandler salesJournalErrorHandler;
+  fp::VatTable sale; // sumy linii bieżącego paragonu
+
 }; // class FiscalPrinter
 
 
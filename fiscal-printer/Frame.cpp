@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/Frame.hpp>
+#include <fiscal-printer/Validator.hpp>
+
+#include <sstream>
+#include <stdexcept>
+
+
+using namespace fp;
+using namespace std;
+using namespace boost;
+
+
+namespace
+{
+
+/// Znak Mazovia odpowiadający dwubajtowemu znakowi UTF-8 (0, jeśli znak nie jest obsługiwany).
+char mazovia(char lead, char next)
+{
+  switch (lead)
+  {
+
+  case (char)0xc3: // kod kontrolny utf8
+  {
+    switch (next)
+    {
+    case (char)0x93: return (char)0xa3; // Ó
+    case (char)0xb3: return (char)0xa2; // ó
+
+    default:
+      return 0; // pomijamy
+    }
+  }
+
+  case (char)0xc4: // kod kontrolny utf8
+  {
+    switch (next)
+    {
+    case (char)0x84: return (char)0x8f; // Ą
+    case (char)0x86: return (char)0x95; // Ć
+    case (char)0x98: return (char)0x90; // Ę
+    case (char)0x85: return (char)0x86; // ą
+    case (char)0x87: return (char)0x8d; // ć
+    case (char)0x99: return (char)0x91; // ę
+
+    default:
+      return 0; // pomijamy
+    }
+  }
+
+  case (char)0xc5: // kod kontrolny utf8
+  {
+    switch (next)
+    {
+    case (char)0x81: return (char)0x9c; // Ł
+    case (char)0x83: return (char)0xa5; // Ń
+    case (char)0x9a: return (char)0x98; // Ś
+    case (char)0xb9: return (char)0xa0; // Ź
+    case (char)0xbb: return (char)0xa1; // Ż
+    case (char)0x82: return (char)0x92; // ł
+    case (char)0x84: return (char)0xa4; // ń
+    case (char)0x9b: return (char)0x9e; // ś
+    case (char)0xba: return (char)0xa6; // ź
+    case (char)0xbc: return (char)0xa7; // ż
+
+    default:
+      return 0; // pomijamy
+    }
+  }
+
+  default:
+    return 0;
+
+  }
+}
+
+
+bool isMazoviaLead(char c)
+{
+  return c == (char)0xc3 || c == (char)0xc4 || c == (char)0xc5;
+}
+
+} // namespace
+
+
+string fp::fromFloat(float number)
+{
+  stringstream stream;
+  stream << number;
+  return stream.str();
+}
+
+
+string fp::fromInt(int number)
+{
+  return lexical_cast<string>(number);
+}
+
+
+string fp::fromLong(long number)
+{
+  return lexical_cast<string>(number);
+}
+
+
+string fp::toMazovia(const string &text)
+{
+  string result;
+
+  appendMazovia(result, text);
+
+  return result;
+}
+
+
+void fp::appendMazovia(string &result, const string &text)
+{
+  for (size_t i = 0; i < text.size(); ++i)
+  {
+    if (isMazoviaLead(text[i]))
+    {
+      if (i + 1 < text.size())
+      {
+        char c = mazovia(text[i], text[i + 1]);
+
+        if (c != 0)
+        {
+          result.push_back(c);
+        }
+
+        ++i;
+      }
+    }
+    else // inny znak uft8
+    {
+      result.push_back(text[i]);
+    }
+  }
+}
+
+
+size_t fp::mazoviaLength(const string &text)
+{
+  size_t length = 0;
+
+  for (size_t i = 0; i < text.size(); ++i)
+  {
+    if (isMazoviaLead(text[i]))
+    {
+      if (i + 1 < text.size())
+      {
+        if (mazovia(text[i], text[i + 1]) != 0)
+        {
+          ++length;
+        }
+
+        ++i;
+      }
+    }
+    else
+    {
+      ++length;
+    }
+  }
+
+  return length;
+}
+
+
+char fp::xorBytes(const string &str)
+{
+  char byte = 0;
+
+  for (string::const_iterator i = str.begin(); i != str.end(); i++)
+  {
+    byte ^= *i;
+  }
+
+  return byte;
+}
+
+
+string fp::formatCtrlByte(char byte)
+{
+  stringstream stream;
+  stream << std::uppercase << std::hex << static_cast<unsigned int>(byte);
+
+  string s = stream.str();
+
+  if (s.size() > 2)
+  {
+    return s.substr(s.size() - 2);
+  }
+
+  return s;
+}
+
+
+string fp::calculateCtrlByte(const string &str)
+{
+  return formatCtrlByte((char)0xff ^ xorBytes(str));
+}
+
+
+EncodedText &EncodedText::add(const string &text, char separator)
+{
+  size_t from = data.size();
+
+  appendMazovia(data, text);
+
+  data.push_back(separator);
+
+  for (size_t i = from; i < data.size(); ++i)
+  {
+    x ^= data[i];
+  }
+
+  return *this;
+}
+
+
+EncodedExtraLines::EncodedExtraLines(const ExtraLines &e) : extraLines(e), n(e.count())
+{
+  if (n > 0) add(extraLines.line1, '\r');
+  if (n > 1) add(extraLines.line2, '\r');
+  if (n > 2) add(extraLines.line3, '\r');
+}
+
+
+EncodedId::EncodedId()
+{
+  joinedText.add("000", '\r');
+  splitText.add("", '\r').add("", '\r');
+}
+
+
+EncodedId::EncodedId(const Id &i, bool check) : id(i)
+{
+  if (check)
+  {
+    ValidationErrors errors;
+
+    validate(id, errors);
+    require(errors);
+  }
+
+  joinedText.add(id.isEmpty() ? string("000") : id.printerId + id.operatorId, '\r');
+
+  splitText.add(id.printerId, '\r').add(id.operatorId, '\r');
+}
+
+
+Frame::Frame(const char *c, bool t) : buffer("\x1bP"), command(c), ctrl(t), params(false), commandIn(false),
+  finished(false), x(0)
+{
+}
+
+
+Frame &Frame::number(int value)
+{
+  if (commandIn)
+  {
+    throw std::logic_error("fp::Frame: numeric parameter after text fields");
+  }
+
+  size_t from = buffer.size();
+
+  if (params)
+  {
+    buffer.push_back(';');
+  }
+
+  buffer += lexical_cast<string>(value);
+
+  params = true;
+
+  update(from);
+
+  return *this;
+}
+
+
+Frame &Frame::text(const string &text)
+{
+  beginText();
+
+  size_t from = buffer.size();
+
+  appendMazovia(buffer, text);
+
+  update(from);
+
+  return *this;
+}
+
+
+Frame &Frame::line(const string &text)
+{
+  this->text(text);
+
+  buffer.push_back('\r');
+  x ^= '\r';
+
+  return *this;
+}
+
+
+Frame &Frame::value(const string &text)
+{
+  this->text(text);
+
+  buffer.push_back('/');
+  x ^= '/';
+
+  return *this;
+}
+
+
+Frame &Frame::amount(float value)
+{
+  return this->value(fromFloat(value));
+}
+
+
+Frame &Frame::lines(const ExtraLines &extraLines, int count)
+{
+  int n = extraLines.count();
+
+  if (n > 0) line(extraLines.line1);
+  if (n > 1) line(extraLines.line2);
+  if (n > 2) line(extraLines.line3);
+
+  for (int i = n; i < count; ++i)
+  {
+    line("");
+  }
+
+  return *this;
+}
+
+
+Frame &Frame::lines(const EncodedExtraLines &extraLines, int count)
+{
+  encoded(extraLines);
+
+  for (int i = extraLines.count(); i < count; ++i)
+  {
+    buffer.push_back('\r');
+    x ^= '\r';
+  }
+
+  return *this;
+}
+
+
+Frame &Frame::encoded(const EncodedText &text)
+{
+  beginText();
+
+  buffer += text.bytes();
+
+  x ^= text.checksum();
+
+  return *this;
+}
+
+
+const string &Frame::str()
+{
+  if (!finished)
+  {
+    beginText();
+
+    if (ctrl)
+    {
+      buffer += formatCtrlByte((char)0xff ^ x);
+    }
+
+    buffer += "\x1b\\";
+
+    finished = true;
+  }
+
+  return buffer;
+}
+
+
+string Frame::content() const
+{
+  string result = buffer.substr(2);
+
+  if (!commandIn)
+  {
+    result += command;
+  }
+
+  return result;
+}
+
+
+void Frame::beginText()
+{
+  if (!commandIn)
+  {
+    size_t from = buffer.size();
+
+    buffer += command;
+
+    update(from);
+
+    commandIn = true;
+  }
+}
+
+
+void Frame::update(size_t from)
+{
+  // bajty dopisane do bufora od pozycji 'from' są uwzględniane w bajcie kontrolnym
+
+  for (size_t i = from; i < buffer.size(); ++i)
+  {
+    x ^= buffer[i];
+  }
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_FRAME_HPP__
+#define __FP_FRAME_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+
+namespace fp
+{
+
+
+/// Liczba w postaci tekstowej (jak w rozkazach protokołu).
+std::string fromFloat(float number);
+std::string fromInt(int number);
+std::string fromLong(long number);
+
+/// Kodowanie tekstu UTF-8 w stronie kodowej Mazovia (nieobsługiwane znaki wielobajtowe są pomijane).
+std::string toMazovia(const std::string &text);
+
+/// Dopisanie tekstu UTF-8 zakodowanego w stronie kodowej Mazovia.
+void appendMazovia(std::string &out, const std::string &text);
+
+/// Długość tekstu UTF-8 po zakodowaniu w Mazovia (bez kodowania).
+std::size_t mazoviaLength(const std::string &text);
+
+/// XOR wszystkich bajtów.
+char xorBytes(const std::string &str);
+
+/// Bajt kontrolny w postaci tekstowej (wielkie litery, bez zer wiodących).
+std::string formatCtrlByte(char byte);
+
+/// Bajt kontrolny zawartości ramki (XOR bajtów i 0xFF).
+std::string calculateCtrlByte(const std::string &str);
+
+
+/// Pola tekstowe zakodowane w Mazovia (z separatorami) razem z ich częścią bajtu kontrolnego.
+/**
+    Pola powtarzane na kolejnych paragonach (linie dodatkowe, identyfikator kasy/kasjera) można
+    zakodować raz, a następnie dopisywać do ramek bez ponownego kodowania (Frame::encoded).
+ */
+class EncodedText
+{
+
+public:
+
+  EncodedText() : x(0) {}
+
+  /// Dopisanie pola zakończonego znakiem 'separator' (n.p. CR).
+  fp::EncodedText &add(const std::string &text, char separator);
+
+  /// Zakodowane bajty.
+  const std::string &bytes() const { return data; }
+
+  /// XOR zakodowanych bajtów.
+  char checksum() const { return x; }
+
+  bool operator==(const fp::EncodedText &other) const { return data == other.data; }
+  bool operator!=(const fp::EncodedText &other) const { return data != other.data; }
+
+private:
+
+  std::string data;
+
+  char x;
+
+}; // class EncodedText
+
+
+/// Zakodowane linie dodatkowe.
+/**
+    Linie dodatkowe wysłane w pierwszym paragonie po raporcie dobowym są zapamiętywane przez
+    drukarkę i na kolejnych paragonach muszą być identyczne. Aplikacja może więc zakodować je raz
+    i używać tego samego obiektu dla wszystkich paragonów.
+
+    @see FiscalPrinter::setExtraLinesCheck
+ */
+class EncodedExtraLines : public EncodedText
+{
+
+public:
+
+  EncodedExtraLines() : n(0) {}
+  explicit EncodedExtraLines(const fp::ExtraLines &extraLines);
+
+  /// Ilość linii (jak ExtraLines::count).
+  int count() const { return n; }
+
+  bool isEmpty() const { return n == 0; }
+
+  /// Linie przed zakodowaniem.
+  const fp::ExtraLines &getExtraLines() const { return extraLines; }
+
+private:
+
+  fp::ExtraLines extraLines;
+
+  int n;
+
+}; // class EncodedExtraLines
+
+
+/// Zakodowany identyfikator kasy/kasjera.
+class EncodedId
+{
+
+public:
+
+  EncodedId();
+
+  /// Konstruktor.
+  /**
+      @param id Numer kasy i kasjer
+      @param check Sprawdzenie długości pól (fp::validate)
+
+      @throw fp::PrinterException Numer kasy dłuższy niż 8 znaków lub kasjer dłuższy niż 32 znaki (tylko z 'check')
+   */
+  explicit EncodedId(const fp::Id &id, bool check = true);
+
+  /// Numer kasy i kasjer w jednym polu zakończonym znakiem CR ("000", jeśli identyfikator jest pusty).
+  const fp::EncodedText &joined() const { return joinedText; }
+
+  /// Numer kasy i kasjer w osobnych polach zakończonych znakiem CR.
+  const fp::EncodedText &split() const { return splitText; }
+
+  bool isEmpty() const { return id.isEmpty(); }
+
+  /// Identyfikator przed zakodowaniem.
+  const fp::Id &getId() const { return id; }
+
+private:
+
+  fp::Id id;
+
+  fp::EncodedText joinedText;
+  fp::EncodedText splitText;
+
+}; // class EncodedId
+
+
+/// Ramka rozkazu protokołu POSNET.
+/**
+    Opis rozkazu: mnemonik, parametry liczbowe (oddzielone znakiem ';', przed mnemonikiem),
+    pola tekstowe (zakończone znakiem CR lub '/', kodowane w Mazovia) i bajt kontrolny.
+    Ramka jest zapisywana bezpośrednio do bufora, bajt kontrolny jest liczony w trakcie zapisu.
+
+    @code
+    fp::Frame frame("$h");
+
+    frame.number(items).number(extraLines.count()).lines(extraLines);
+
+    write(frame.str()); // ESC P 1;2$h linia1 CR linia2 CR <bajt kontrolny> ESC '\'
+    @endcode
+
+    @note Parametry liczbowe muszą być dodane przed polami tekstowymi.
+
+    @see fp::command (opisy rozkazów sprawdzające kolejność pól w czasie kompilacji)
+ */
+class Frame
+{
+
+public:
+
+  /// Konstruktor.
+  /**
+      @param command Mnemonik rozkazu (n.p. "$h")
+      @param ctrl Ramka z bajtem kontrolnym
+   */
+  explicit Frame(const char *command, bool ctrl = true);
+
+  /// Parametr liczbowy.
+  /**
+      @throw std::logic_error Parametr po polu tekstowym (mnemonik jest już w buforze)
+   */
+  fp::Frame &number(int value);
+
+  /// Pole tekstowe bez znaku końca.
+  fp::Frame &text(const std::string &text);
+
+  /// Pole tekstowe zakończone znakiem CR.
+  fp::Frame &line(const std::string &text);
+
+  /// Pole tekstowe zakończone znakiem '/'.
+  fp::Frame &value(const std::string &text);
+
+  /// Kwota zakończona znakiem '/'.
+  fp::Frame &amount(float value);
+
+  /// Linie dodatkowe zakończone znakiem CR (tylko 'extraLines.count()' pierwszych linii).
+  /**
+      @param extraLines Linie dodatkowe
+      @param count Ilość pól (brakujące linie są uzupełniane pustymi polami), 0 - tylko linie
+   */
+  fp::Frame &lines(const fp::ExtraLines &extraLines, int count = 0);
+
+  /// Zakodowane linie dodatkowe (jak Frame::lines, bez ponownego kodowania).
+  fp::Frame &lines(const fp::EncodedExtraLines &extraLines, int count = 0);
+
+  /// Zakodowane pola tekstowe (bajty są kopiowane, bajt kontrolny jest uzupełniany o EncodedText::checksum).
+  fp::Frame &encoded(const fp::EncodedText &text);
+
+  /// Zakończona ramka (z bajtem kontrolnym i znacznikiem końca).
+  const std::string &str();
+
+  /// Zawartość ramki bez znacznika początku (przed Frame::str, bez bajtu kontrolnego i znacznika końca).
+  std::string content() const;
+
+private:
+
+  void beginText();
+  void update(size_t from);
+
+  std::string buffer;
+
+  const char *command;
+
+  bool ctrl;
+  bool params;    // dodano parametr liczbowy
+  bool commandIn; // mnemonik jest w buforze
+  bool finished;
+
+  char x;
+
+}; // class Frame
+
+
+} // namespace fp
+
+
+#endif // __FP_FRAME_HPP__
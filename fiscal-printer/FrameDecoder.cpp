@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/FrameDecoder.hpp>
+
+
+using namespace fp;
+using namespace std;
+
+
+namespace
+{
+
+const char ESC  = 0x1b;
+const char XON  = 0x11;
+const char XOFF = 0x13;
+
+} // namespace
+
+
+FrameDecoder::FrameDecoder(size_t m) : maxPayload(m), state(S_IDLE), synced(true), stopped(false)
+{
+}
+
+
+void FrameDecoder::feed(const char *data, size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    char c = data[i];
+
+    if (c == XON || c == XOFF)
+    {
+      ++stats.flowControl;
+
+      stopped = c == XOFF;
+
+      continue;
+    }
+
+    switch (state)
+    {
+    case S_IDLE:
+      if (c == ESC)
+      {
+        state = S_ESC;
+      }
+      else if (c >= 0x60 && c <= 0x77)
+      {
+        status.push_back(c);
+
+        ++stats.statusBytes;
+
+        synced = true;
+      }
+      else
+      {
+        garbage(1);
+      }
+      break;
+
+    case S_ESC:
+      if (c == 'P')
+      {
+        payload.clear();
+
+        state = S_FRAME;
+
+        synced = true;
+      }
+      else if (c == ESC)
+      {
+        garbage(1);
+      }
+      else
+      {
+        garbage(2);
+
+        state = S_IDLE;
+      }
+      break;
+
+    case S_FRAME:
+      if (c == ESC)
+      {
+        state = S_FRAME_ESC;
+      }
+      else if (payload.size() < maxPayload)
+      {
+        payload.push_back(c);
+      }
+      else
+      {
+        // ramka za długa, prawdopodobnie zgubiony koniec ramki
+
+        garbage(payload.size() + 1);
+
+        payload.clear();
+
+        state = S_IDLE;
+      }
+      break;
+
+    case S_FRAME_ESC:
+      if (c == '\\')
+      {
+        frames.push_back(payload);
+
+        ++stats.frames;
+
+        payload.clear();
+
+        state = S_IDLE;
+      }
+      else if (c == 'P')
+      {
+        // początek nowej ramki przed końcem poprzedniej (n.p. po ponownym połączeniu)
+
+        garbage(payload.size() + 2);
+
+        synced = true;
+
+        payload.clear();
+
+        state = S_FRAME;
+      }
+      else
+      {
+        garbage(payload.size() + 2);
+
+        payload.clear();
+
+        state = S_IDLE;
+      }
+      break;
+    }
+  }
+}
+
+
+bool FrameDecoder::hasFrame() const
+{
+  return !frames.empty();
+}
+
+
+string FrameDecoder::takeFrame()
+{
+  string result = frames.front();
+
+  frames.pop_front();
+
+  return result;
+}
+
+
+bool FrameDecoder::hasStatus() const
+{
+  return !status.empty();
+}
+
+
+char FrameDecoder::takeStatus()
+{
+  char result = status.front();
+
+  status.pop_front();
+
+  return result;
+}
+
+
+void FrameDecoder::clearStatus()
+{
+  stats.discarded += status.size();
+
+  status.clear();
+}
+
+
+void FrameDecoder::reset()
+{
+  if (state != S_IDLE)
+  {
+    garbage(payload.size() + 2);
+  }
+
+  stats.discarded += status.size();
+
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    stats.discarded += frames[i].size() + 4;
+  }
+
+  payload.clear();
+
+  frames.clear();
+  status.clear();
+
+  state = S_IDLE;
+
+  synced = true;
+
+  stopped = false;
+}
+
+
+bool FrameDecoder::isStopped() const
+{
+  return stopped;
+}
+
+
+FrameDecoderStats FrameDecoder::getStats() const
+{
+  return stats;
+}
+
+
+void FrameDecoder::garbage(size_t count)
+{
+  stats.discarded += count;
+
+  // seria śmieci liczona jest jako jedna utrata synchronizacji
+
+  if (synced)
+  {
+    ++stats.resyncs;
+
+    synced = false;
+  }
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_FRAME_DECODER_HPP__
+#define __FP_FRAME_DECODER_HPP__
+
+
+#include <deque>
+#include <string>
+
+
+namespace fp
+{
+
+
+/// Statystyki dekodera ramek.
+struct FrameDecoderStats
+{
+  unsigned long frames;       ///< Odebrane ramki.
+  unsigned long statusBytes;  ///< Odebrane bajty statusu (ENQ/DLE) poza ramkami.
+  unsigned long flowControl;  ///< Pominięte znaki XON/XOFF.
+  unsigned long discarded;    ///< Pominięte bajty (poza ramkami, przerwane ramki, nieaktualne statusy).
+  unsigned long resyncs;      ///< Ilość utrat synchronizacji (śmieci między ramkami, przerwane ramki).
+
+  FrameDecoderStats() : frames(0), statusBytes(0), flowControl(0), discarded(0), resyncs(0) {}
+
+}; // struct FrameDecoderStats
+
+
+/// Dekoder strumienia odbieranego z drukarki.
+/**
+    Bajty mogą być dostarczane w dowolnych porcjach. Ramki (ESC 'P' ... ESC '\') są przekazywane
+    bez znaczników początku i końca, bajty statusu ENQ (0x60..0x6F) i DLE (0x70..0x77) odebrane
+    poza ramką są przekazywane osobno. Pozostałe bajty poza ramką są pomijane, znaki XON/XOFF
+    są pomijane także wewnątrz ramki (stan XON/XOFF jest zapamiętywany).
+ */
+class FrameDecoder
+{
+
+public:
+
+  /// Konstruktor.
+  /**
+      @param maxPayload Maksymalna długość ramki (dłuższa ramka jest pomijana)
+   */
+  explicit FrameDecoder(size_t maxPayload = 4096);
+
+  /// Przetworzenie odebranych bajtów.
+  void feed(const char *data, size_t size);
+
+  /// Czy jest odebrana ramka.
+  bool hasFrame() const;
+
+  /// Pobranie najstarszej odebranej ramki.
+  std::string takeFrame();
+
+  /// Czy jest odebrany bajt statusu.
+  bool hasStatus() const;
+
+  /// Pobranie najstarszego bajtu statusu.
+  char takeStatus();
+
+  /// Pominięcie odebranych bajtów statusu (n.p. przed wysłaniem ENQ, odebrane wcześniej nie są odpowiedzią).
+  void clearStatus();
+
+  /// Wyzerowanie stanu (n.p. po ponownym otwarciu portu), statystyki są zachowane.
+  void reset();
+
+  /// Czy ostatnim odebranym znakiem sterowania przepływem był XOFF.
+  bool isStopped() const;
+
+  /// Statystyki.
+  fp::FrameDecoderStats getStats() const;
+
+private:
+
+  enum STATE
+  {
+    S_IDLE,      // poza ramką
+    S_ESC,       // ESC poza ramką
+    S_FRAME,     // wewnątrz ramki
+    S_FRAME_ESC  // ESC wewnątrz ramki
+
+  }; // enum STATE
+
+  void garbage(size_t count);
+
+  size_t maxPayload;
+
+  STATE state;
+
+  bool synced; // ostatni bajt poza ramką nie był śmieciem
+
+  bool stopped;
+
+  std::string payload;
+
+  std::deque<std::string> frames;
+  std::deque<char> status;
+
+  fp::FrameDecoderStats stats;
+
+}; // class FrameDecoder
+
+
+} // namespace fp
+
+
+#endif // __FP_FRAME_DECODER_HPP__
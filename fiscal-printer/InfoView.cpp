@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#include <fiscal-printer/InfoView.hpp>
+
+#include <cstring>
+
+
+using namespace fp;
+using namespace std;
+
+
+namespace
+{
+
+/// Liczba całkowita od pozycji 'p' (przesuwa 'p' za liczbę).
+int parseInt(const string &s, size_t &p)
+{
+  bool negative = false;
+
+  if (p < s.size() && s[p] == '-')
+  {
+    negative = true;
+    ++p;
+  }
+
+  int value = 0;
+
+  while (p < s.size() && s[p] >= '0' && s[p] <= '9')
+  {
+    value = value * 10 + (s[p] - '0');
+    ++p;
+  }
+
+  return negative ? -value : value;
+}
+
+
+/// Liczba rzeczywista z zakresu [begin;end) zapisana z kropką dziesiętną.
+double parseReal(const string &s, size_t begin, size_t end)
+{
+  size_t p = begin;
+
+  bool negative = false;
+
+  if (p < end && s[p] == '-')
+  {
+    negative = true;
+    ++p;
+  }
+
+  double value = 0.0;
+
+  while (p < end && s[p] >= '0' && s[p] <= '9')
+  {
+    value = value * 10.0 + (s[p] - '0');
+    ++p;
+  }
+
+  if (p < end && s[p] == '.')
+  {
+    ++p;
+
+    double scale = 0.1;
+
+    while (p < end && s[p] >= '0' && s[p] <= '9')
+    {
+      value += (s[p] - '0') * scale;
+      scale /= 10.0;
+      ++p;
+    }
+  }
+
+  return negative ? -value : value;
+}
+
+} // namespace
+
+
+CashRegisterInfoView::CashRegisterInfoView(const string &r, const char *prefix, int v, int t) : reply(r),
+  prefixSize(strlen(prefix)), fixedVat(v), extraTotals(t), headerParsed(false), valid(false), fieldsSplit(false),
+  fields(0), vats(0), parsed(0)
+{
+  if (reply.compare(0, prefixSize, prefix) != 0)
+  {
+    headerParsed = true; // nieprawidłowa odpowiedź, wszystkie pola mają wartość 0
+    fieldsSplit = true;
+  }
+
+  memset(header, 0, sizeof(header));
+}
+
+
+bool CashRegisterInfoView::isValid() const
+{
+  parseHeader();
+
+  return valid;
+}
+
+
+int CashRegisterInfoView::lastError() const
+{
+  parseHeader();
+
+  return header[0];
+}
+
+
+bool CashRegisterInfoView::fiscal() const
+{
+  parseHeader();
+
+  return header[1] != 0;
+}
+
+
+bool CashRegisterInfoView::transaction() const
+{
+  parseHeader();
+
+  return header[2] != 0;
+}
+
+
+bool CashRegisterInfoView::transactionOk() const
+{
+  parseHeader();
+
+  return header[3] != 0;
+}
+
+
+int CashRegisterInfoView::resets() const
+{
+  parseHeader();
+
+  return header[5];
+}
+
+
+int CashRegisterInfoView::year() const
+{
+  parseHeader();
+
+  return header[6];
+}
+
+
+int CashRegisterInfoView::month() const
+{
+  parseHeader();
+
+  return header[7];
+}
+
+
+int CashRegisterInfoView::day() const
+{
+  parseHeader();
+
+  return header[8];
+}
+
+
+int CashRegisterInfoView::vatCount() const
+{
+  splitFields();
+
+  return vats;
+}
+
+
+double CashRegisterInfoView::vat(int i) const
+{
+  splitFields();
+
+  return i >= 0 && i < vats ? real(i) : 0.0;
+}
+
+
+int CashRegisterInfoView::reciepts() const
+{
+  splitFields();
+
+  if (vats >= fields)
+  {
+    return 0;
+  }
+
+  size_t p = begin[vats];
+
+  return parseInt(reply, p);
+}
+
+
+int CashRegisterInfoView::totalCount() const
+{
+  splitFields();
+
+  return vats + extraTotals;
+}
+
+
+double CashRegisterInfoView::total(int i) const
+{
+  splitFields();
+
+  return i >= 0 && i < vats + extraTotals ? real(vats + 1 + i) : 0.0;
+}
+
+
+float CashRegisterInfoView::cash() const
+{
+  splitFields();
+
+  return (float)real(vats + 1 + vats + extraTotals);
+}
+
+
+string CashRegisterInfoView::number() const
+{
+  splitFields();
+
+  int field = vats + 1 + vats + extraTotals + 1;
+
+  if (field >= fields)
+  {
+    return string();
+  }
+
+  // numer unikatowy to reszta odpowiedzi (znaki drukowalne)
+
+  size_t from = begin[field];
+  size_t to = from;
+
+  while (to < reply.size() && (unsigned char)reply[to] >= 0x20 && (unsigned char)reply[to] < 0x7f)
+  {
+    ++to;
+  }
+
+  return reply.substr(from, to - from);
+}
+
+
+void CashRegisterInfoView::parseHeader() const
+{
+  if (headerParsed)
+  {
+    return;
+  }
+
+  headerParsed = true;
+
+  size_t p = prefixSize;
+
+  for (int i = 0; i < HEADER_FIELDS; ++i)
+  {
+    header[i] = parseInt(reply, p);
+
+    char separator = i + 1 < HEADER_FIELDS ? ';' : '/';
+
+    if (p >= reply.size() || reply[p] != separator)
+    {
+      return;
+    }
+
+    ++p;
+  }
+
+  valid = true;
+}
+
+
+void CashRegisterInfoView::splitFields() const
+{
+  if (fieldsSplit)
+  {
+    return;
+  }
+
+  fieldsSplit = true;
+
+  size_t p = reply.find('/', prefixSize); // koniec nagłówka
+
+  if (p == string::npos)
+  {
+    return;
+  }
+
+  ++p;
+
+  while (fields < MAX_FIELDS && p < reply.size())
+  {
+    size_t q = reply.find('/', p);
+
+    begin[fields] = p;
+    end[fields] = q == string::npos ? reply.size() : q;
+
+    ++fields;
+
+    if (q == string::npos)
+    {
+      break;
+    }
+
+    p = q + 1;
+  }
+
+  if (fixedVat > 0)
+  {
+    vats = fixedVat;
+  }
+  else
+  {
+    // stawki są liczbami z kropką dziesiętną, ilość paragonów (następne pole) jest liczbą całkowitą
+
+    while (vats < fields && reply.find('.', begin[vats]) < end[vats])
+    {
+      ++vats;
+    }
+  }
+
+  if (vats > fields)
+  {
+    vats = fields;
+  }
+}
+
+
+void CashRegisterInfoView::fill(VatTable &rates, VatTable &totals) const
+{
+  for (int i = 0; i < vatCount() && i < VatTable::SIZE; ++i)
+  {
+    rates.set(i, vat(i));
+  }
+
+  rates.excludeDisabled();
+
+  for (int i = 0; i < totalCount() && i < VatTable::SIZE; ++i)
+  {
+    totals.set(i, total(i));
+  }
+}
+
+
+double CashRegisterInfoView::real(int field) const
+{
+  if (field < 0 || field >= fields)
+  {
+    return 0.0;
+  }
+
+  if (!(parsed & (1UL << field)))
+  {
+    values[field] = parseReal(reply, begin[field], end[field]);
+
+    parsed |= 1UL << field;
+  }
+
+  return values[field];
+}
+
+
+CashRegisterInfo1View::CashRegisterInfo1View(const string &reply) : CashRegisterInfoView(reply, "1#X", 0, 1)
+{
+}
+
+
+CashRegisterInfo1 CashRegisterInfo1View::toInfo() const
+{
+  CashRegisterInfo1 info;
+
+  info.lastError = lastError();
+
+  info.fiscal = fiscal();
+  info.transaction = transaction();
+  info.transactionOk = transactionOk();
+
+  info.ramResets = resets();
+
+  info.year = year();
+  info.month = month();
+  info.day = day();
+
+  fill(info.vat, info.totals);
+
+  info.reciepts = reciepts();
+
+  info.cash = cash();
+
+  info.number = number();
+
+  return info;
+}
+
+
+CashRegisterInfo2View::CashRegisterInfo2View(const string &reply) : CashRegisterInfoView(reply, "2#X", 7, 0)
+{
+}
+
+
+CashRegisterInfo2 CashRegisterInfo2View::toInfo() const
+{
+  CashRegisterInfo2 info;
+
+  info.lastError = lastError();
+
+  info.fiscal = fiscal();
+  info.transaction = transaction();
+  info.transactionOk = transactionOk();
+
+  info.resets = resets();
+
+  info.year = year();
+  info.month = month();
+  info.day = day();
+
+  fill(info.vat, info.totals);
+
+  info.reciepts = reciepts();
+
+  info.cash = cash();
+
+  info.number = number();
+
+  return info;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#ifndef __FP_INFO_VIEW_HPP__
+#define __FP_INFO_VIEW_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+
+namespace fp
+{
+
+
+/// Widok odpowiedzi z informacjami kasowymi (1) lub (2) parsujący pola przy pierwszym odczycie.
+/**
+    Odpowiedź jest przechowywana bez parsowania. Pola nagłówka (błąd, tryb fiskalny, stan
+    transakcji, data) są parsowane razem przy pierwszym odczycie któregokolwiek z nich, położenie
+    pól oddzielonych znakiem '/' jest ustalane przy pierwszym odczycie stawki, totalizera, gotówki
+    lub numeru unikatowego, a każda liczba jest parsowana przy pierwszym odczycie.
+
+    Pętla sprawdzająca tylko CashRegisterInfoView::transaction nie parsuje więc stawek, totalizerów,
+    gotówki ani numeru unikatowego.
+
+    @note Liczby są parsowane niezależnie od ustawień regionalnych (LC_NUMERIC).
+ */
+class CashRegisterInfoView
+{
+
+public:
+
+  /// Odpowiedź ma oczekiwany format.
+  bool isValid() const;
+
+  int lastError() const;
+
+  bool fiscal() const;
+  bool transaction() const;
+  bool transactionOk() const;
+
+  /// Ilość zerowań RAM zapisanych w pamięci fiskalnej.
+  int resets() const;
+
+  int year() const;
+  int month() const;
+  int day() const;
+
+  /// Ilość stawek PTU w odpowiedzi.
+  int vatCount() const;
+
+  /// Stawka PTU (0 - A, 1 - B, ...), 0.0 poza zakresem.
+  double vat(int i) const;
+
+  /// Ilość wydrukowanych paragonów fiskalnych.
+  int reciepts() const;
+
+  /// Ilość totalizerów w odpowiedzi.
+  int totalCount() const;
+
+  /// Stan totalizera (0 - A, 1 - B, ...), 0.0 poza zakresem.
+  double total(int i) const;
+
+  /// Stan gotówki w kasie.
+  float cash() const;
+
+  /// Numer unikatowy.
+  std::string number() const;
+
+  /// Odpowiedź drukarki.
+  const std::string &getReply() const { return reply; }
+
+protected:
+
+  /**
+      @param reply Odpowiedź drukarki
+      @param prefix Początek odpowiedzi (n.p. "1#X")
+      @param fixedVat Ilość stawek PTU (0 - zmienna, ustalana z odpowiedzi)
+      @param extraTotals Ilość totalizerów ponad ilość stawek PTU
+   */
+  CashRegisterInfoView(const std::string &reply, const char *prefix, int fixedVat, int extraTotals);
+
+  /// Wypełnienie tablic stawek i totalizerów.
+  void fill(fp::VatTable &rates, fp::VatTable &totals) const;
+
+private:
+
+  enum { HEADER_FIELDS = 9, MAX_FIELDS = 24 };
+
+  void parseHeader() const;
+  void splitFields() const;
+
+  double real(int field) const;
+
+  std::string reply;
+
+  size_t prefixSize;
+
+  int fixedVat;
+  int extraTotals;
+
+  mutable bool headerParsed;
+  mutable bool valid;
+  mutable int header[HEADER_FIELDS];
+
+  mutable bool fieldsSplit;
+  mutable int fields;             // ilość pól po nagłówku
+  mutable int vats;
+  mutable size_t begin[MAX_FIELDS];
+  mutable size_t end[MAX_FIELDS];
+
+  mutable unsigned long parsed;   // bit 'i' - pole 'i' zostało sparsowane
+  mutable double values[MAX_FIELDS];
+
+}; // class CashRegisterInfoView
+
+
+/// Widok informacji kasowych (1) (FiscalPrinter::getCashRegisterInfo1View).
+class CashRegisterInfo1View : public CashRegisterInfoView
+{
+
+public:
+
+  explicit CashRegisterInfo1View(const std::string &reply);
+
+  /// Wszystkie pola (jak FiscalPrinter::getCashRegisterInfo1).
+  fp::CashRegisterInfo1 toInfo() const;
+
+}; // class CashRegisterInfo1View
+
+
+/// Widok informacji kasowych (2) (FiscalPrinter::getCashRegisterInfo2View).
+class CashRegisterInfo2View : public CashRegisterInfoView
+{
+
+public:
+
+  explicit CashRegisterInfo2View(const std::string &reply);
+
+  /// Wszystkie pola (jak FiscalPrinter::getCashRegisterInfo2).
+  fp::CashRegisterInfo2 toInfo() const;
+
+}; // class CashRegisterInfo2View
+
+
+} // namespace fp
+
+
+#endif // __FP_INFO_VIEW_HPP__
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/ItemTemplateCache.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+
+using namespace fp;
+using namespace std;
+
+
+ItemTemplateCache::ItemTemplateCache()
+{
+}
+
+
+const ItemTemplate *ItemTemplateCache::find(const string &productId) const
+{
+  map<string, ItemTemplate>::const_iterator i = templates.find(productId);
+
+  if (i == templates.end())
+  {
+    return NULL;
+  }
+
+  return &i->second;
+}
+
+
+const ItemTemplate &ItemTemplateCache::get(FiscalPrinter &printer, const string &productId, const Item &item)
+{
+  map<string, ItemTemplate>::iterator i = templates.find(productId);
+
+  if (i != templates.end() && i->second.price == item.price)
+  {
+    return i->second;
+  }
+
+  return insert(productId, printer.makeItemTemplate(item));
+}
+
+
+const ItemTemplate &ItemTemplateCache::insert(const string &productId, const ItemTemplate &itemTemplate)
+{
+  ItemTemplate &result = templates[productId];
+
+  result = itemTemplate;
+
+  return result;
+}
+
+
+void ItemTemplateCache::erase(const string &productId)
+{
+  templates.erase(productId);
+}
+
+
+void ItemTemplateCache::clear()
+{
+  templates.clear();
+}
+
+
+size_t ItemTemplateCache::size() const
+{
+  return templates.size();
+}
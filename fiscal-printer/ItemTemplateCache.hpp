@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_ITEM_TEMPLATE_CACHE_HPP__
+#define __FP_ITEM_TEMPLATE_CACHE_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+#include <map>
+
+
+namespace fp
+{
+
+
+class FiscalPrinter;
+
+
+/// Pamięć podręczna zakodowanych linii paragonu, kluczem jest identyfikator towaru.
+/**
+    Przy sprzedaży towaru z pamięci podręcznej kodowane są tylko numer linii, ilość i kwota brutto.
+
+    @note Po zmianie danych towaru (nazwa, stawka PTU, cena, rabat) należy usunąć szablon (ItemTemplateCache::erase).
+ */
+class ItemTemplateCache
+{
+
+public:
+
+  ItemTemplateCache();
+
+  /// Szablon towaru (lub NULL, jeśli towaru nie ma w pamięci podręcznej).
+  const fp::ItemTemplate *find(const std::string &productId) const;
+
+  /// Szablon towaru, tworzony przy pierwszym użyciu.
+  /**
+      @param printer Drukarka (kodowanie szablonu)
+      @param productId Identyfikator towaru
+      @param item Linia paragonu (używana tylko przy tworzeniu szablonu)
+
+      @note Jeśli cena w szablonie różni się od ceny w linii, to szablon jest tworzony ponownie.
+   */
+  const fp::ItemTemplate &get(fp::FiscalPrinter &printer, const std::string &productId, const fp::Item &item);
+
+  /// Dodanie (lub zastąpienie) szablonu towaru.
+  const fp::ItemTemplate &insert(const std::string &productId, const fp::ItemTemplate &itemTemplate);
+
+  /// Usunięcie szablonu towaru.
+  void erase(const std::string &productId);
+
+  /// Usunięcie wszystkich szablonów.
+  void clear();
+
+  /// Ilość szablonów.
+  size_t size() const;
+
+private:
+
+  std::map<std::string, fp::ItemTemplate> templates;
+
+}; // class ItemTemplateCache
+
+
+} // namespace fp
+
+
+#endif // __FP_ITEM_TEMPLATE_CACHE_HPP__
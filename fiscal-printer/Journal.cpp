@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+#include <fiscal-printer/Journal.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+#include <boost/algorithm/string.hpp>
+
+#include <fstream>
+#include <algorithm>
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+using namespace fp;
+using namespace std;
+using namespace boost;
+
+
+// Format rekordów dziennika (jeden rekord w linii, pola oddzielone tabulatorem):
+//
+//   B <receiptId>              rozpoczęcie paragonu
+//   F <seq> <ramka hex>        ramka zapisana przed wysłaniem
+//   C <seq>                    ramka wysłana
+//   E <seq> <błąd>             błąd wysyłania ramki
+//   X                          zakończenie paragonu
+//   R <receiptId> <wynik>      paragon obsłużony przez Journal::recover
+
+
+Journal::Journal() : fd(-1), groupSize(16), pending(0), seq(0)
+{
+}
+
+
+Journal::~Journal()
+{
+  close();
+}
+
+
+void Journal::open(const string &p, int g)
+{
+  if (fd != -1)
+  {
+    return;
+  }
+
+  // numeracja ramek jest kontynuowana po ponownym otwarciu dziennika
+
+  ifstream file(p.c_str());
+  string line;
+
+  while (getline(file, line))
+  {
+    if (line.size() > 2 && line[0] == 'F')
+    {
+      long s = atol(line.c_str() + 2);
+
+      if (s > seq)
+      {
+        seq = s;
+      }
+    }
+  }
+
+  file.close();
+
+  fd = ::open(p.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+  if (fd == -1)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "open");
+  }
+
+  path = p;
+  groupSize = g > 0 ? g : 1;
+  pending = 0;
+}
+
+
+void Journal::close()
+{
+  if (fd != -1)
+  {
+    sync();
+
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+
+bool Journal::isOpen() const
+{
+  return fd != -1;
+}
+
+
+void Journal::beginReceipt(const string &id)
+{
+  receiptId = sanitize(id);
+
+  writeRecord("B\t" + receiptId + "\n");
+
+  sync(); // granica paragonu
+}
+
+
+void Journal::endReceipt()
+{
+  writeRecord("X\n");
+
+  sync(); // granica paragonu
+
+  receiptId.clear();
+}
+
+
+long Journal::append(const string &frame)
+{
+  ++seq;
+
+  writeRecord("F\t" + lexical_cast<string>(seq) + "\t" + toHex(frame) + "\n");
+
+  return seq;
+}
+
+
+void Journal::complete(long s)
+{
+  writeRecord("C\t" + lexical_cast<string>(s) + "\n");
+
+  if (pending >= groupSize)
+  {
+    sync();
+  }
+}
+
+
+void Journal::fail(long s, const string &error)
+{
+  writeRecord("E\t" + lexical_cast<string>(s) + "\t" + sanitize(error) + "\n");
+
+  sync();
+}
+
+
+void Journal::sync()
+{
+  if (fd != -1 && pending > 0)
+  {
+    ::fdatasync(fd);
+
+    pending = 0;
+  }
+}
+
+
+void Journal::truncate()
+{
+  if (fd != -1)
+  {
+    if (::ftruncate(fd, 0) == -1)
+    {
+      throw boost::system::system_error(errno, boost::system::system_category(), "ftruncate");
+    }
+
+    ::fdatasync(fd);
+
+    pending = 0;
+  }
+}
+
+
+JournalRecovery Journal::recover(FiscalPrinter &printer, const Id &id)
+{
+  JournalRecovery recovery;
+
+  sync();
+
+  ifstream file(path.c_str());
+
+  string line;
+
+  bool open = false;
+
+  long confirmSeq = 0;
+
+  vector<long> sent;
+
+  while (getline(file, line))
+  {
+    if (line.empty())
+    {
+      continue;
+    }
+
+    vector<string> fields;
+    split(fields, line, is_any_of("\t"));
+
+    switch (line[0])
+    {
+    case 'B':
+      open = true;
+
+      recovery.receiptId = fields.size() > 1 ? fields[1] : string();
+      recovery.frames = 0;
+      recovery.completed = 0;
+
+      confirmSeq = 0;
+
+      sent.clear();
+      break;
+
+    case 'F':
+      if (open && fields.size() > 2)
+      {
+        long s = atol(fields[1].c_str());
+
+        ++recovery.frames;
+
+        sent.push_back(s);
+
+        if (isConfirmation(fields[2]))
+        {
+          confirmSeq = s;
+        }
+      }
+      break;
+
+    case 'C':
+      if (open && fields.size() > 1)
+      {
+        long s = atol(fields[1].c_str());
+
+        if (find(sent.begin(), sent.end(), s) != sent.end())
+        {
+          ++recovery.completed;
+        }
+      }
+      break;
+
+    case 'X':
+    case 'R':
+      open = false;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  file.close();
+
+  if (!open)
+  {
+    recovery = JournalRecovery();
+
+    return recovery;
+  }
+
+  CashRegisterInfo6 info = printer.getCashRegisterInfo6(CRI6M_0);
+  EnqStatus status = printer.getEnqStatus();
+
+  if (info.transaction != 0 || status.transaction)
+  {
+    receiptId = recovery.receiptId; // ramka anulowania trafia do tego samego paragonu
+
+    printer.cancelTransaction(id);
+
+    recovery.result = JR_CANCELLED;
+  }
+  else if (confirmSeq != 0 && status.transactionOk)
+  {
+    recovery.result = JR_CONFIRMED;
+  }
+  else
+  {
+    recovery.result = JR_LOST;
+  }
+
+  writeRecord("R\t" + recovery.receiptId + "\t" + lexical_cast<string>((int)recovery.result) + "\n");
+
+  sync();
+
+  receiptId.clear();
+
+  return recovery;
+}
+
+
+void Journal::writeRecord(const string &record)
+{
+  if (fd == -1)
+  {
+    return;
+  }
+
+  const char *data = record.data();
+  size_t size = record.size();
+
+  while (size > 0)
+  {
+    ssize_t n = ::write(fd, data, size);
+
+    if (n == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      throw boost::system::system_error(errno, boost::system::system_category(), "write");
+    }
+
+    data += n;
+    size -= n;
+  }
+
+  ++pending;
+}
+
+
+bool Journal::isConfirmation(const string &hex)
+{
+  // ramka zapisana jest w postaci hex: ESC 'P' <parametry> <rozkaz> ...
+
+  string frame;
+
+  for (size_t i = 0; i + 1 < hex.size(); i += 2)
+  {
+    frame.push_back((char)strtol(hex.substr(i, 2).c_str(), NULL, 16));
+  }
+
+  size_t pos = frame.find("\x1bP");
+
+  if (pos == string::npos)
+  {
+    return false;
+  }
+
+  pos += 2;
+
+  size_t cmd = frame.find_first_not_of("0123456789;", pos);
+
+  if (cmd == string::npos || cmd + 2 > frame.size())
+  {
+    return false;
+  }
+
+  string mnemonic = frame.substr(cmd, 2);
+
+  if (mnemonic == "$x" || mnemonic == "$y")
+  {
+    return true;
+  }
+
+  if (mnemonic == "$e") // $e z pierwszym parametrem 1 to zatwierdzenie, 0 to anulowanie
+  {
+    string params = frame.substr(pos, cmd - pos);
+
+    return params == "1" || params.compare(0, 2, "1;") == 0;
+  }
+
+  return false;
+}
+
+
+string Journal::sanitize(const string &text)
+{
+  string result = text;
+
+  for (size_t i = 0; i < result.size(); ++i)
+  {
+    if (result[i] == '\t' || result[i] == '\n' || result[i] == '\r')
+    {
+      result[i] = ' ';
+    }
+  }
+
+  return result;
+}
+
+
+string Journal::toHex(const string &data)
+{
+  static const char digits[] = "0123456789ABCDEF";
+
+  string result;
+  result.reserve(data.size() * 2);
+
+  for (size_t i = 0; i < data.size(); ++i)
+  {
+    unsigned char c = (unsigned char)data[i];
+
+    result.push_back(digits[c >> 4]);
+    result.push_back(digits[c & 0x0f]);
+  }
+
+  return result;
+}
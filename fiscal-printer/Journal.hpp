@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+#ifndef __FP_JOURNAL_HPP__
+#define __FP_JOURNAL_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+
+namespace fp
+{
+
+
+class FiscalPrinter;
+
+
+/// Wynik odtwarzania stanu po awarii.
+enum JOURNAL_RECOVERY
+{
+  JR_CLEAN     = 0, ///< Dziennik nie zawiera niezakończonego paragonu.
+  JR_CONFIRMED = 1, ///< Zatwierdzenie paragonu dotarło do drukarki, paragon został zakończony poprawnie.
+  JR_CANCELLED = 2, ///< Drukarka była w trybie transakcji, transakcja została anulowana.
+  JR_LOST      = 3  ///< Drukarka nie jest w trybie transakcji, a zatwierdzenie paragonu nie zostało potwierdzone
+                    ///< (paragon należy wystawić ponownie).
+
+}; // enum JOURNAL_RECOVERY
+
+
+/// Wynik odtwarzania stanu po awarii.
+struct JournalRecovery
+{
+  JOURNAL_RECOVERY result; ///< Wynik.
+
+  std::string receiptId;   ///< Identyfikator niezakończonego paragonu.
+
+  long frames;             ///< Ilość ramek niezakończonego paragonu zapisanych w dzienniku.
+  long completed;          ///< Ilość ramek, które zostały w całości wysłane do drukarki.
+
+  JournalRecovery() : result(JR_CLEAN), frames(0), completed(0) {}
+
+}; // struct JournalRecovery
+
+
+/// Dziennik rozkazów wysyłanych do drukarki (write-ahead log).
+/**
+    Każda ramka jest dopisywana do dziennika _przed_ wysłaniem do drukarki, a po wysłaniu
+    dopisywana jest informacja o jej zakończeniu lub o błędzie. Ramki są oznaczane
+    identyfikatorem paragonu nadanym przez aplikację (Journal::beginReceipt).
+
+    @note Zapis do pliku odbywa się przy każdej ramce (dane trafiają do systemu operacyjnego,
+          więc przetrwają awarię procesu), natomiast fsync jest wykonywany grupowo: po zapisaniu
+          groupSize ramek oraz na granicach paragonów (Journal::beginReceipt, Journal::endReceipt).
+
+    @see FiscalPrinter::setJournal
+ */
+class Journal
+{
+
+public:
+
+  Journal();
+  ~Journal();
+
+  /// Otwórz dziennik.
+  /**
+      @param path Ścieżka do pliku dziennika (plik jest tworzony, jeśli nie istnieje)
+      @param groupSize Ilość rekordów, po której wykonywany jest fsync
+
+      @note W przypadku błędu rzucany jest wyjątek boost::system::system_error.
+   */
+  void open(const std::string &path, int groupSize = 16);
+
+  /// Zamknij dziennik.
+  /**
+      @note Metoda wołana w destruktorze.
+   */
+  void close();
+
+  /// Czy dziennik jest otwarty.
+  bool isOpen() const;
+
+  /// Rozpoczęcie paragonu.
+  /**
+      @param receiptId Identyfikator paragonu nadany przez aplikację (n.p. numer w bazie POS)
+   */
+  void beginReceipt(const std::string &receiptId);
+
+  /// Zakończenie paragonu (paragon zatwierdzony lub anulowany przez aplikację).
+  void endReceipt();
+
+  /// Dopisanie ramki (przed wysłaniem do drukarki).
+  /**
+      @param frame Zakodowana ramka
+
+      @return Numer kolejny ramki w dzienniku
+   */
+  long append(const std::string &frame);
+
+  /// Ramka została wysłana do drukarki.
+  void complete(long seq);
+
+  /// Błąd wysyłania ramki.
+  void fail(long seq, const std::string &error);
+
+  /// Wymuszenie zapisu dziennika na dysk (fsync).
+  void sync();
+
+  /// Wyczyszczenie dziennika.
+  /**
+      @note Należy wywołać tylko wtedy, gdy żaden paragon nie jest w trakcie wystawiania
+            (n.p. po raporcie dobowym lub po Journal::recover).
+   */
+  void truncate();
+
+  /// Odtworzenie stanu po awarii.
+  /**
+      Porównuje ostatni niezakończony paragon z dziennika ze stanem drukarki
+      (EnqStatus::transactionOk i CashRegisterInfo6::transaction). Jeśli drukarka jest
+      w trybie transakcji, to transakcja jest anulowana.
+
+      @param printer Drukarka (port musi być otwarty)
+      @param id Identyfikator kasy/kasjera użyty do anulowania transakcji
+
+      @note Metoda czeka na odpowiedź drukarki.
+   */
+  JournalRecovery recover(fp::FiscalPrinter &printer, const fp::Id &id);
+
+private:
+
+  void writeRecord(const std::string &record);
+
+  static bool isConfirmation(const std::string &frame);
+
+  static std::string sanitize(const std::string &text);
+
+  static std::string toHex(const std::string &data);
+
+  std::string path;
+
+  int fd;
+
+  int groupSize;
+  int pending;
+
+  long seq;
+
+  std::string receiptId;
+
+}; // class Journal
+
+
+} // namespace fp
+
+
+#endif // __FP_JOURNAL_HPP__
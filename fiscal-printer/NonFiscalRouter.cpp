@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/NonFiscalRouter.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+#include <boost/bind.hpp>
+
+
+using namespace fp;
+using namespace std;
+using namespace boost;
+
+
+NonFiscalRouter::NonFiscalRouter()
+{
+}
+
+
+NonFiscalRouter::~NonFiscalRouter()
+{
+  for (size_t i = 0; i < members.size(); ++i)
+  {
+    delete members[i];
+  }
+}
+
+
+void NonFiscalRouter::addPrinter(const string &name, Scheduler &scheduler, int baudRate, bool fiscal)
+{
+  Member *member = new Member();
+
+  member->status.name = name;
+  member->status.fiscal = fiscal;
+
+  member->scheduler = &scheduler;
+
+  PrintTimeModel model = scheduler.getPrintTimeModel();
+
+  model.setBaudRate(baudRate);
+
+  scheduler.setPrintTimeModel(model);
+
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  members.push_back(member);
+}
+
+
+void NonFiscalRouter::setPrintTimeParameters(const string &name, const PrintTimeParameters &parameters)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  for (size_t i = 0; i < members.size(); ++i)
+  {
+    if (members[i]->status.name == name)
+    {
+      PrintTimeModel model = members[i]->scheduler->getPrintTimeModel();
+
+      model.setParameters(parameters);
+
+      members[i]->scheduler->setPrintTimeModel(model);
+    }
+  }
+}
+
+
+string NonFiscalRouter::print(const NonFiscalDocument &document, const CompletionHandler &handler)
+{
+  size_t best = members.size();
+  bool bestFiscal = true;
+  long bestFinish = 0;
+  size_t bestPending = 0;
+
+  PrintEstimate estimate;
+
+  Scheduler *scheduler = NULL;
+  string name;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+      const Member &member = *members[i];
+      const RouterPrinterStatus &status = member.status;
+
+      if (!status.available)
+      {
+        continue;
+      }
+
+      size_t pending = member.scheduler->pending(SP_NORMAL) + member.scheduler->pending(SP_BULK);
+
+      // na drukarce paragonów trwa sprzedaż
+
+      if (status.fiscal && member.scheduler->pending(SP_NORMAL) > 0)
+      {
+        continue;
+      }
+
+      long finish = status.backlog + member.scheduler->estimate(document).total;
+
+      bool better = best == members.size() ||
+        (bestFiscal && !status.fiscal) ||
+        (bestFiscal == status.fiscal && (finish < bestFinish || (finish == bestFinish && pending < bestPending)));
+
+      if (better)
+      {
+        best = i;
+        bestFiscal = status.fiscal;
+        bestFinish = finish;
+        bestPending = pending;
+      }
+    }
+
+    if (best < members.size())
+    {
+      Member &member = *members[best];
+
+      estimate = member.scheduler->estimate(document);
+
+      member.status.jobs += 1;
+      member.status.backlog += estimate.total;
+
+      scheduler = member.scheduler;
+      name = member.status.name;
+    }
+  }
+
+  if (scheduler == NULL)
+  {
+    checkStatus(); // drukarki niedostępne po błędzie mogą wrócić do puli
+
+    if (handler)
+    {
+      handler(false, "no printer available");
+    }
+
+    return string();
+  }
+
+  scheduler->printNonFiscal(document, boost::bind(&NonFiscalRouter::completed, this, best, estimate, handler, _1, _2));
+
+  return name;
+}
+
+
+void NonFiscalRouter::checkStatus()
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  for (size_t i = 0; i < members.size(); ++i)
+  {
+    members[i]->scheduler->submit(SP_INTERACTIVE, Scheduler::Step(boost::bind(&NonFiscalRouter::readStatus, this, i, _1)),
+      boost::bind(&NonFiscalRouter::statusRead, this, i, _1, _2));
+  }
+}
+
+
+vector<RouterPrinterStatus> NonFiscalRouter::getStatus() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  vector<RouterPrinterStatus> result;
+
+  for (size_t i = 0; i < members.size(); ++i)
+  {
+    result.push_back(members[i]->status);
+  }
+
+  return result;
+}
+
+
+void NonFiscalRouter::readStatus(size_t index, FiscalPrinter &printer)
+{
+  DleStatus dle = printer.getDleStatus();
+
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  RouterPrinterStatus &status = members[index]->status;
+
+  status.dle = dle;
+  status.dleKnown = true;
+  status.available = dle.online && !dle.paper && !dle.error;
+}
+
+
+void NonFiscalRouter::statusRead(size_t index, bool ok, const string &error)
+{
+  (void)error;
+
+  if (!ok)
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    members[index]->status.available = false;
+  }
+}
+
+
+void NonFiscalRouter::completed(size_t index, const PrintEstimate &estimate, CompletionHandler handler, bool ok,
+  const string &error)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    Member &member = *members[index];
+
+    member.status.jobs -= 1;
+    member.status.backlog -= estimate.total;
+
+    if (!ok)
+    {
+      // drukarka wraca do puli po odczycie poprawnego statusu (NonFiscalRouter::checkStatus)
+
+      member.status.available = false;
+    }
+  }
+
+  if (handler)
+  {
+    handler(ok, error);
+  }
+}
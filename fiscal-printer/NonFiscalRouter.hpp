@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_NON_FISCAL_ROUTER_HPP__
+#define __FP_NON_FISCAL_ROUTER_HPP__
+
+
+#include <fiscal-printer/Scheduler.hpp>
+#include <fiscal-printer/PrintTimeModel.hpp>
+
+#include <boost/thread.hpp>
+
+
+namespace fp
+{
+
+
+/// Stan drukarki w puli NonFiscalRouter.
+struct RouterPrinterStatus
+{
+  std::string name;   ///< Nazwa drukarki.
+
+  bool fiscal;        ///< Drukarka paragonów (używana tylko, gdy inne są niedostępne).
+  bool available;     ///< Drukarka przyjmuje wydruki (ostatni status DLE bez błędu i braku papieru).
+
+  fp::DleStatus dle;  ///< Ostatni odczytany status DLE.
+  bool dleKnown;      ///< Status DLE został odczytany.
+
+  size_t jobs;        ///< Ilość wydruków zleconych i niezakończonych.
+  long backlog;       ///< Przewidywany czas wykonania zleconych wydruków w mikrosekundach.
+
+  RouterPrinterStatus() : fiscal(false), available(true), dleKnown(false), jobs(0), backlog(0)
+  {
+    dle.online = true;
+    dle.paper = false;
+    dle.error = false;
+  }
+
+}; // struct RouterPrinterStatus
+
+
+/// Rozdzielanie wydruków niefiskalnych (bonów kuchennych, kopii zamówień) między drukarki z puli.
+/**
+    Wydruk jest zlecany (Scheduler::printNonFiscal) drukarce, której zlecone wydruki skończą się
+    najwcześniej (PrintTimeModel), przy czym pomijane są drukarki bez papieru, z błędem mechanizmu
+    lub po błędzie wydruku. Drukarki paragonów (fiscal) są używane tylko, gdy żadna inna drukarka nie
+    jest dostępna i nie trwa na nich sprzedaż (brak zadań SP_NORMAL w Scheduler'ze).
+
+    Czas wydruku jest szacowany modelem czasu wydruku Scheduler'a drukarki, który jest korygowany
+    pomiarami każdego wydruku (Scheduler::getPrintTimeModel).
+
+    @note Scheduler'y muszą działać dłużej niż router (przed usunięciem routera należy poczekać
+          na wykonanie zleconych wydruków, Scheduler::wait).
+ */
+class NonFiscalRouter
+{
+
+public:
+
+  typedef fp::Scheduler::CompletionHandler CompletionHandler;
+
+  NonFiscalRouter();
+  ~NonFiscalRouter();
+
+  /// Dodanie drukarki do puli.
+  /**
+      @param name Nazwa drukarki
+      @param scheduler Scheduler drukarki (uruchomiony)
+      @param baudRate Prędkość transmisji (model czasu wydruku Scheduler'a)
+      @param fiscal Drukarka paragonów
+   */
+  void addPrinter(const std::string &name, fp::Scheduler &scheduler, int baudRate = 9600, bool fiscal = false);
+
+  /// Ustawienie parametrów modelu czasu wydruku drukarki (Scheduler::setPrintTimeModel).
+  void setPrintTimeParameters(const std::string &name, const fp::PrintTimeParameters &parameters);
+
+  /// Zlecenie wydruku.
+  /**
+      @param document Wydruk niefiskalny
+      @param handler Funkcja wołana po zakończeniu wydruku
+
+      @return Nazwa wybranej drukarki (pusta, jeśli żadna nie jest dostępna, wtedy 'handler' jest wołany
+              z błędem przed powrotem z metody)
+   */
+  std::string print(const fp::NonFiscalDocument &document, const CompletionHandler &handler = CompletionHandler());
+
+  /// Odczyt statusu DLE wszystkich drukarek (SP_INTERACTIVE).
+  /**
+      @note Metoda nie czeka na odczyt. Drukarka niedostępna po błędzie wraca do puli
+            po odczycie poprawnego statusu.
+   */
+  void checkStatus();
+
+  /// Stan drukarek w puli.
+  std::vector<fp::RouterPrinterStatus> getStatus() const;
+
+private:
+
+  struct Member
+  {
+    fp::RouterPrinterStatus status;
+
+    fp::Scheduler *scheduler;
+
+  }; // struct Member
+
+  void readStatus(size_t index, fp::FiscalPrinter &printer);
+  void statusRead(size_t index, bool ok, const std::string &error);
+
+  void completed(size_t index, const fp::PrintEstimate &estimate, CompletionHandler handler, bool ok,
+    const std::string &error);
+
+  std::vector<Member *> members;
+
+  mutable boost::mutex mutex;
+
+}; // class NonFiscalRouter
+
+
+} // namespace fp
+
+
+#endif // __FP_NON_FISCAL_ROUTER_HPP__
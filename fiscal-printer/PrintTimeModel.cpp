@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/PrintTimeModel.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+#include <fiscal-printer/Frame.hpp>
+
+#include <set>
+
+
+using namespace fp;
+using namespace std;
+
+
+namespace
+{
+
+// przybliżone rozmiary ramek bez argumentów tekstowych (ESC P, argumenty liczbowe, rozkaz, bajt kontrolny, ESC \)
+
+const long BEGIN_FRAME_BYTES = 16;
+const long ITEM_FRAME_BYTES = 34;
+const long CONFIRM_FRAME_BYTES = 50;
+const long NON_FISCAL_FRAME_BYTES = 22;
+const long REPORT_FRAME_BYTES = 30;
+
+const int PRICE_COLUMNS = 24; // ilość, cena, kwota brutto i stawka PTU w linii towaru
+
+const int QR_LINES = 8;
+const int BARCODE_LINES = 3;
+const int GRAPHIC_LINES = 10;
+const int DISCOUNT_LINES = 2;
+const int VAT_LINES = 2;
+const int CASH_LINES = 2;
+
+
+// teksty są liczone w znakach Mazovia (tak jak są wysyłane i drukowane), a nie w bajtach UTF-8
+
+long extraLinesBytes(const ExtraLines &extraLines)
+{
+  return mazoviaLength(extraLines.line1) + mazoviaLength(extraLines.line2) + mazoviaLength(extraLines.line3) +
+    extraLines.count();
+}
+
+} // namespace
+
+
+PrintTimeModel::PrintTimeModel(int b, const PrintTimeParameters &p) : baudRate(b), parameters(p)
+{
+  clearSamples();
+}
+
+
+void PrintTimeModel::setBaudRate(int b)
+{
+  baudRate = b;
+}
+
+
+int PrintTimeModel::getBaudRate() const
+{
+  return baudRate;
+}
+
+
+void PrintTimeModel::setParameters(const PrintTimeParameters &p)
+{
+  parameters = p;
+}
+
+
+PrintTimeParameters PrintTimeModel::getParameters() const
+{
+  return parameters;
+}
+
+
+PrintEstimate PrintTimeModel::estimate(const Receipt &receipt) const
+{
+  int lines = parameters.receiptHeader + parameters.receiptFooter + receipt.extraLines.count();
+  long bytes = BEGIN_FRAME_BYTES + CONFIRM_FRAME_BYTES + 2 * extraLinesBytes(receipt.extraLines) + 1;
+
+  set<string> vat;
+
+  for (size_t i = 0; i < receipt.items.size(); ++i)
+  {
+    const Item &item = receipt.items[i];
+
+    lines += itemLines(item);
+
+    bytes += ITEM_FRAME_BYTES + mazoviaLength(item.name) + item.quantity.size() + item.vat.size() +
+      mazoviaLength(item.description) + mazoviaLength(item.barcode) + mazoviaLength(item.discountName);
+
+    vat.insert(item.vat);
+  }
+
+  lines += VAT_LINES * vat.size();
+
+  if (receipt.cashIn > 0.0)
+  {
+    lines += CASH_LINES;
+  }
+
+  // rozpoczęcie, linie, zatwierdzenie, ENQ
+
+  return estimate(lines, receipt.items.size() + 3, bytes);
+}
+
+
+PrintEstimate PrintTimeModel::estimate(const NonFiscalDocument &document) const
+{
+  int lines = parameters.documentHeader + parameters.documentFooter + document.extraLines.count();
+  long bytes = 2 * NON_FISCAL_FRAME_BYTES + mazoviaLength(document.sysNr) + extraLinesBytes(document.extraLines) + 1;
+
+  for (size_t i = 0; i < document.lines.size(); ++i)
+  {
+    const NonFiscalLine &line = document.lines[i];
+
+    lines += nonFiscalLines(line);
+
+    bytes += NON_FISCAL_FRAME_BYTES;
+
+    for (size_t j = 0; j < line.lines.size(); ++j)
+    {
+      bytes += mazoviaLength(line.lines[j]) + 1;
+    }
+  }
+
+  // rozpoczęcie, linie, zakończenie, ENQ
+
+  return estimate(lines, document.lines.size() + 3, bytes);
+}
+
+
+PrintEstimate PrintTimeModel::estimateDailyReport() const
+{
+  return estimate(parameters.dailyReportLines, 2, REPORT_FRAME_BYTES + 1);
+}
+
+
+PrintEstimate PrintTimeModel::estimate(int lines, int frames, long bytes) const
+{
+  PrintEstimate result;
+
+  result.lines = lines;
+  result.frames = frames;
+  result.bytes = bytes;
+
+  result.wireTime = wireTime(bytes);
+  result.printTime = frames * parameters.frameOverhead + lines * parameters.lineTime;
+  result.total = result.wireTime + result.printTime;
+
+  return result;
+}
+
+
+int PrintTimeModel::itemLines(const Item &item) const
+{
+  // nazwa z ilością, ceną i kwotą brutto, dłuższa nazwa jest przenoszona do kolejnej linii
+
+  int lines = textLines(item.name + string(PRICE_COLUMNS, ' '));
+
+  if (item.line == 0)
+  {
+    ++lines; // 'STORNO'
+  }
+
+  lines += textLines(item.description);
+
+  if (!item.barcode.empty())
+  {
+    if (item.barcode[0] == '@')
+    {
+      lines += QR_LINES;
+    }
+    else if (item.barcode[0] == '#')
+    {
+      lines += BARCODE_LINES;
+    }
+    else
+    {
+      lines += textLines("K:" + item.barcode);
+    }
+  }
+
+  if (item.discountType != IDT_0)
+  {
+    lines += DISCOUNT_LINES;
+  }
+
+  return lines;
+}
+
+
+int PrintTimeModel::nonFiscalLines(const NonFiscalLine &line) const
+{
+  if (line.lineNr == 249)
+  {
+    return QR_LINES;
+  }
+
+  if (line.lineNr == 250)
+  {
+    return GRAPHIC_LINES;
+  }
+
+  if (line.printNr == 254)
+  {
+    return BARCODE_LINES;
+  }
+
+  return 1;
+}
+
+
+long PrintTimeModel::calibrateLink(FiscalPrinter &printer, int probes)
+{
+  long result = printer.measureEnqRoundTrip(probes);
+
+  if (result > 0)
+  {
+    parameters.frameOverhead = result;
+  }
+
+  return result;
+}
+
+
+void PrintTimeModel::addSample(const PrintEstimate &e, long measured)
+{
+  double f = e.frames;
+  double l = e.lines;
+  double y = measured - e.wireTime;
+
+  ++samples;
+
+  ff += f * f;
+  fl += f * l;
+  ll += l * l;
+  fy += f * y;
+  ly += l * y;
+
+  double det = ff * ll - fl * fl;
+
+  if (samples >= 2 && det > 1e-6 * ff * ll)
+  {
+    double overhead = (fy * ll - ly * fl) / det;
+    double lineTime = (ly * ff - fy * fl) / det;
+
+    if (overhead >= 0.0 && lineTime >= 0.0)
+    {
+      parameters.frameOverhead = (long)overhead;
+      parameters.lineTime = (long)lineTime;
+
+      return;
+    }
+  }
+
+  // za mało pomiarów (albo wynik bez sensu fizycznego): korekta tylko czasu wydruku linii
+
+  if (ll > 0.0)
+  {
+    double lineTime = (ly - parameters.frameOverhead * fl) / ll;
+
+    if (lineTime >= 0.0)
+    {
+      parameters.lineTime = (long)lineTime;
+    }
+  }
+}
+
+
+long PrintTimeModel::getSamples() const
+{
+  return samples;
+}
+
+
+void PrintTimeModel::clearSamples()
+{
+  samples = 0;
+
+  ff = 0.0;
+  fl = 0.0;
+  ll = 0.0;
+  fy = 0.0;
+  ly = 0.0;
+}
+
+
+long PrintTimeModel::wireTime(long bytes) const
+{
+  if (baudRate <= 0)
+  {
+    return 0;
+  }
+
+  return (long)(bytes * 10 * 1000000LL / baudRate);
+}
+
+
+int PrintTimeModel::textLines(const string &text) const
+{
+  if (text.empty() || parameters.lineWidth <= 0)
+  {
+    return 0;
+  }
+
+  return (mazoviaLength(text) + parameters.lineWidth - 1) / parameters.lineWidth;
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_PRINT_TIME_MODEL_HPP__
+#define __FP_PRINT_TIME_MODEL_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+
+namespace fp
+{
+
+
+class FiscalPrinter;
+
+
+/// Parametry modelu czasu wydruku.
+struct PrintTimeParameters
+{
+  long lineTime;          ///< Czas wydruku jednej linii w mikrosekundach.
+  long frameOverhead;     ///< Czas obsługi jednej ramki przez drukarkę (odpowiedź, przetwarzanie) w mikrosekundach.
+
+  int lineWidth;          ///< Ilość znaków w linii wydruku.
+
+  int receiptHeader;      ///< Ilość linii nagłówka paragonu (nagłówek, NIP, data, 'PARAGON FISKALNY').
+  int receiptFooter;      ///< Ilość linii stopki paragonu (suma, numer, kasa, kasjer, numer unikatowy).
+  int documentHeader;     ///< Ilość linii nagłówka wydruku niefiskalnego.
+  int documentFooter;     ///< Ilość linii stopki wydruku niefiskalnego.
+  int dailyReportLines;   ///< Ilość linii raportu dobowego.
+
+  PrintTimeParameters() : lineTime(40000), frameOverhead(10000), lineWidth(40), receiptHeader(8),
+    receiptFooter(10), documentHeader(5), documentFooter(5), dailyReportLines(60) {}
+
+}; // struct PrintTimeParameters
+
+
+/// Oszacowanie czasu wydruku.
+struct PrintEstimate
+{
+  int lines;      ///< Ilość linii wydruku.
+  int frames;     ///< Ilość ramek (łącznie z ENQ po zakończeniu).
+  long bytes;     ///< Ilość wysłanych bajtów.
+
+  long wireTime;  ///< Czas transmisji w mikrosekundach.
+  long printTime; ///< Czas obsługi ramek i wydruku linii w mikrosekundach.
+  long total;     ///< Łączny czas w mikrosekundach.
+
+  PrintEstimate() : lines(0), frames(0), bytes(0), wireTime(0), printTime(0), total(0) {}
+
+}; // struct PrintEstimate
+
+
+/// Model czasu wydruku paragonu, wydruku niefiskalnego lub raportu.
+/**
+    Czas wydruku to czas transmisji ramek przy danej prędkości portu (8N1, 10 bitów na bajt),
+    czas obsługi każdej ramki przez drukarkę oraz czas wydruku każdej linii.
+
+    Ilość linii jest szacowana z zawartości dokumentu (długość nazwy towaru, opis, kod kreskowy,
+    rabat, stawki PTU, linie dodatkowe). Czas obsługi ramki i czas wydruku linii są korygowane
+    pomiarami rzeczywistych wydruków (PrintTimeModel::addSample), metodą najmniejszych kwadratów.
+
+    @code
+    fp::PrintTimeModel model(115200);
+
+    model.calibrateLink(printer);
+
+    fp::PrintEstimate estimate = model.estimate(receipt);
+
+    // ... wydruk paragonu, 'measured' to czas od rozpoczęcia transakcji do odpowiedzi na ENQ po zatwierdzeniu
+
+    model.addSample(estimate, measured);
+    @endcode
+
+    @note Model Scheduler'a (Scheduler::getPrintTimeModel) jest korygowany automatycznie czasem wykonania
+          każdego zadania z oszacowaniem (Job::estimate: wydruki niefiskalne Scheduler::printNonFiscal,
+          zlecenia demona). Samodzielny model trzeba korygować przez PrintTimeModel::addSample.
+          PrintTimeModel::calibrateLink ustawia jedynie czas obsługi ramki (dolne oszacowanie).
+
+    @note Zapis do portu czeka, gdy drukarka wstrzymuje nadawanie (XOFF), więc czas wstrzymania
+          (FiscalPrinter::getTransactionStallTime) jest częścią zmierzonego czasu, a odpowiedź na ENQ po
+          zakończeniu dokumentu przychodzi po wydrukowaniu linii z bufora drukarki.
+
+    @note Długości tekstów są liczone w znakach Mazovia (fp::mazoviaLength), nie w bajtach UTF-8.
+
+    @note Metody nie są synchronizowane.
+ */
+class PrintTimeModel
+{
+
+public:
+
+  explicit PrintTimeModel(int baudRate = 9600, const fp::PrintTimeParameters &parameters = fp::PrintTimeParameters());
+
+  /// Ustawienie prędkości transmisji.
+  void setBaudRate(int baudRate);
+
+  /// Prędkość transmisji.
+  int getBaudRate() const;
+
+  /// Ustawienie parametrów (pomiary są zachowane).
+  void setParameters(const fp::PrintTimeParameters &parameters);
+
+  /// Parametry (po korekcie pomiarami).
+  fp::PrintTimeParameters getParameters() const;
+
+  /// Oszacowanie czasu wydruku paragonu (rozpoczęcie, linie, zatwierdzenie, ENQ).
+  fp::PrintEstimate estimate(const fp::Receipt &receipt) const;
+
+  /// Oszacowanie czasu wydruku niefiskalnego.
+  fp::PrintEstimate estimate(const fp::NonFiscalDocument &document) const;
+
+  /// Oszacowanie czasu raportu dobowego.
+  fp::PrintEstimate estimateDailyReport() const;
+
+  /// Oszacowanie czasu dla znanej ilości linii, ramek i bajtów.
+  fp::PrintEstimate estimate(int lines, int frames, long bytes) const;
+
+  /// Ilość linii wydruku jednej linii paragonu.
+  int itemLines(const fp::Item &item) const;
+
+  /// Ilość linii wydruku jednej linii wydruku niefiskalnego.
+  int nonFiscalLines(const fp::NonFiscalLine &line) const;
+
+  /// Pomiar czasu obsługi ramki (FiscalPrinter::measureEnqRoundTrip).
+  /**
+      @return Zmierzony czas w mikrosekundach
+
+      @note Mierzony jest tylko czas odpowiedzi na ENQ, bez przetwarzania ramki i wydruku linii,
+            więc wynik jest dolnym oszacowaniem PrintTimeParameters::frameOverhead.
+   */
+  long calibrateLink(fp::FiscalPrinter &printer, int probes = 20);
+
+  /// Dodanie pomiaru rzeczywistego wydruku.
+  /**
+      @param estimate Oszacowanie dla wydrukowanego dokumentu
+      @param measured Zmierzony czas w mikrosekundach
+
+      @note Po co najmniej dwóch pomiarach różniących się proporcją ilości ramek do ilości linii
+            korygowane są oba parametry, wcześniej tylko czas wydruku linii.
+   */
+  void addSample(const fp::PrintEstimate &estimate, long measured);
+
+  /// Ilość pomiarów.
+  long getSamples() const;
+
+  /// Usunięcie pomiarów (parametry pozostają bez zmian).
+  void clearSamples();
+
+private:
+
+  long wireTime(long bytes) const;
+
+  int textLines(const std::string &text) const;
+
+  int baudRate;
+
+  fp::PrintTimeParameters parameters;
+
+  // sumy metody najmniejszych kwadratów: x1 - ramki, x2 - linie, y - czas bez transmisji
+
+  long samples;
+
+  double ff;
+  double fl;
+  double ll;
+  double fy;
+  double ly;
+
+}; // class PrintTimeModel
+
+
+} // namespace fp
+
+
+#endif // __FP_PRINT_TIME_MODEL_HPP__
@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/Protocol.hpp>
+
+#include <cstring>
+
+
+using namespace fp;
+using namespace fp::protocol;
+using namespace std;
+
+
+namespace
+{
+
+class Writer
+{
+
+public:
+
+  Writer()
+  {
+    data.append(4, '\0'); // miejsce na długość
+  }
+
+  void putByte(int value)
+  {
+    data.push_back((char)(value & 0xff));
+  }
+
+  void putInt(boost::uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i)
+    {
+      data.push_back((char)((value >> (8 * i)) & 0xff));
+    }
+  }
+
+  void putFloat(float value)
+  {
+    boost::uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    putInt(bits);
+  }
+
+  void putString(const string &value)
+  {
+    putInt((boost::uint32_t)value.size());
+
+    data.append(value);
+  }
+
+  string finish()
+  {
+    boost::uint32_t size = (boost::uint32_t)data.size() - 4;
+
+    for (int i = 0; i < 4; ++i)
+    {
+      data[i] = (char)((size >> (8 * i)) & 0xff);
+    }
+
+    return data;
+  }
+
+private:
+
+  string data;
+
+}; // class Writer
+
+
+class Reader
+{
+
+public:
+
+  Reader(const string &d) : data(d), pos(0), ok(true) {}
+
+  int getByte()
+  {
+    if (!check(1))
+    {
+      return 0;
+    }
+
+    return (unsigned char)data[pos++];
+  }
+
+  boost::uint32_t getInt()
+  {
+    if (!check(4))
+    {
+      return 0;
+    }
+
+    boost::uint32_t value = decodeLength(data.data() + pos);
+
+    pos += 4;
+
+    return value;
+  }
+
+  float getFloat()
+  {
+    boost::uint32_t bits = getInt();
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+  }
+
+  string getString()
+  {
+    boost::uint32_t size = getInt();
+
+    if (!check(size))
+    {
+      return string();
+    }
+
+    string value = data.substr(pos, size);
+
+    pos += size;
+
+    return value;
+  }
+
+  bool failed() const
+  {
+    return !ok;
+  }
+
+  bool isOk() const
+  {
+    return ok && pos == data.size();
+  }
+
+private:
+
+  bool check(size_t size)
+  {
+    if (!ok || data.size() - pos < size)
+    {
+      ok = false;
+    }
+
+    return ok;
+  }
+
+  const string &data;
+
+  size_t pos;
+
+  bool ok;
+
+}; // class Reader
+
+
+void putExtraLines(Writer &w, const ExtraLines &extraLines)
+{
+  w.putString(extraLines.line1);
+  w.putString(extraLines.line2);
+  w.putString(extraLines.line3);
+}
+
+
+void getExtraLines(Reader &r, ExtraLines &extraLines)
+{
+  extraLines.line1 = r.getString();
+  extraLines.line2 = r.getString();
+  extraLines.line3 = r.getString();
+}
+
+
+void putReceipt(Writer &w, const Receipt &receipt)
+{
+  w.putString(receipt.receiptId);
+
+  w.putString(receipt.id.printerId);
+  w.putString(receipt.id.operatorId);
+
+  putExtraLines(w, receipt.extraLines);
+
+  w.putFloat(receipt.cashIn);
+  w.putFloat(receipt.total);
+
+  w.putInt((boost::uint32_t)receipt.items.size());
+
+  for (size_t i = 0; i < receipt.items.size(); ++i)
+  {
+    const Item &item = receipt.items[i];
+
+    w.putInt((boost::uint32_t)item.line);
+
+    w.putString(item.name);
+    w.putString(item.barcode);
+    w.putString(item.description);
+    w.putString(item.vat);
+    w.putString(item.quantity);
+
+    w.putFloat(item.price);
+    w.putFloat(item.gross);
+
+    w.putByte((int)item.discountType);
+    w.putByte((int)item.discountDesc);
+    w.putFloat(item.discountValue);
+
+    w.putString(item.discountName);
+  }
+}
+
+
+void getReceipt(Reader &r, Receipt &receipt)
+{
+  receipt.receiptId = r.getString();
+
+  receipt.id.printerId = r.getString();
+  receipt.id.operatorId = r.getString();
+
+  getExtraLines(r, receipt.extraLines);
+
+  receipt.cashIn = r.getFloat();
+  receipt.total = r.getFloat();
+
+  boost::uint32_t count = r.getInt();
+
+  receipt.items.clear();
+
+  for (boost::uint32_t i = 0; i < count && !r.failed(); ++i)
+  {
+    Item item;
+
+    item.line = (int)r.getInt();
+
+    item.name = r.getString();
+    item.barcode = r.getString();
+    item.description = r.getString();
+    item.vat = r.getString();
+    item.quantity = r.getString();
+
+    item.price = r.getFloat();
+    item.gross = r.getFloat();
+
+    item.discountType = (ITEM_DISCOUNT_TYPE)r.getByte();
+    item.discountDesc = (DISCOUNT_DESCRIPTION_TYPE)r.getByte();
+    item.discountValue = r.getFloat();
+
+    item.discountName = r.getString();
+
+    receipt.items.push_back(item);
+  }
+}
+
+
+void putNonFiscal(Writer &w, const NonFiscalDocument &document)
+{
+  w.putInt((boost::uint32_t)document.printNr);
+  w.putInt((boost::uint32_t)document.headerNr);
+
+  w.putInt((boost::uint32_t)document.lines.size());
+
+  for (size_t i = 0; i < document.lines.size(); ++i)
+  {
+    const NonFiscalLine &line = document.lines[i];
+
+    w.putInt((boost::uint32_t)line.printNr);
+    w.putInt((boost::uint32_t)line.lineNr);
+
+    w.putByte(line.bold);
+    w.putByte(line.inverse);
+    w.putByte(line.center);
+
+    w.putByte(line.font);
+    w.putByte((int)line.attrs);
+
+    w.putInt((boost::uint32_t)line.lines.size());
+
+    for (size_t j = 0; j < line.lines.size(); ++j)
+    {
+      w.putString(line.lines[j]);
+    }
+  }
+
+  w.putString(document.sysNr);
+
+  putExtraLines(w, document.extraLines);
+}
+
+
+void getNonFiscal(Reader &r, NonFiscalDocument &document)
+{
+  document.printNr = (int)r.getInt();
+  document.headerNr = (int)r.getInt();
+
+  boost::uint32_t count = r.getInt();
+
+  document.lines.clear();
+
+  for (boost::uint32_t i = 0; i < count && !r.failed(); ++i)
+  {
+    NonFiscalLine line;
+
+    line.printNr = (int)r.getInt();
+    line.lineNr = (int)r.getInt();
+
+    line.bold = r.getByte() != 0;
+    line.inverse = r.getByte() != 0;
+    line.center = r.getByte() != 0;
+
+    line.font = r.getByte();
+    line.attrs = (FONT_ATTRS)r.getByte();
+
+    boost::uint32_t lines = r.getInt();
+
+    for (boost::uint32_t j = 0; j < lines && !r.failed(); ++j)
+    {
+      line.lines.push_back(r.getString());
+    }
+
+    document.lines.push_back(line);
+  }
+
+  document.sysNr = r.getString();
+
+  getExtraLines(r, document.extraLines);
+}
+
+} // namespace
+
+
+string fp::protocol::encodeRequest(const Request &request)
+{
+  Writer w;
+
+  w.putByte(MT_REQUEST);
+
+  w.putInt(request.requestId);
+  w.putString(request.printer);
+  w.putByte((int)request.priority);
+
+  w.putInt((boost::uint32_t)request.commands.size());
+
+  for (size_t i = 0; i < request.commands.size(); ++i)
+  {
+    const Command &command = request.commands[i];
+
+    w.putByte((int)command.type);
+
+    switch (command.type)
+    {
+    case CT_RECEIPT:
+      putReceipt(w, command.receipt);
+      break;
+
+    case CT_NON_FISCAL:
+      putNonFiscal(w, command.nonFiscal);
+      break;
+
+    case CT_DISPLAY_MESSAGE:
+      w.putString(command.message);
+      break;
+
+    case CT_OPEN_DRAWER:
+    case CT_BELL:
+    default:
+      break;
+    }
+  }
+
+  return w.finish();
+}
+
+
+string fp::protocol::encodeCompletion(const Completion &completion)
+{
+  Writer w;
+
+  w.putByte(MT_COMPLETION);
+
+  w.putInt(completion.requestId);
+  w.putByte(completion.ok);
+  w.putInt(completion.executed);
+  w.putString(completion.error);
+
+  return w.finish();
+}
+
+
+boost::uint32_t fp::protocol::decodeLength(const char *header)
+{
+  boost::uint32_t value = 0;
+
+  for (int i = 3; i >= 0; --i)
+  {
+    value = (value << 8) | (unsigned char)header[i];
+  }
+
+  return value;
+}
+
+
+int fp::protocol::messageType(const string &body)
+{
+  return body.empty() ? 0 : (unsigned char)body[0];
+}
+
+
+bool fp::protocol::decodeRequest(const string &body, Request &request)
+{
+  Reader r(body);
+
+  if (r.getByte() != MT_REQUEST)
+  {
+    return false;
+  }
+
+  request.requestId = r.getInt();
+  request.printer = r.getString();
+
+  int priority = r.getByte();
+
+  if (priority < SP_INTERACTIVE || priority > SP_BULK)
+  {
+    return false;
+  }
+
+  request.priority = (SCHEDULER_PRIORITY)priority;
+
+  boost::uint32_t count = r.getInt();
+
+  request.commands.clear();
+
+  for (boost::uint32_t i = 0; i < count && !r.failed(); ++i)
+  {
+    Command command;
+
+    command.type = (COMMAND_TYPE)r.getByte();
+
+    switch (command.type)
+    {
+    case CT_RECEIPT:
+      getReceipt(r, command.receipt);
+      break;
+
+    case CT_NON_FISCAL:
+      getNonFiscal(r, command.nonFiscal);
+      break;
+
+    case CT_DISPLAY_MESSAGE:
+      command.message = r.getString();
+      break;
+
+    case CT_OPEN_DRAWER:
+    case CT_BELL:
+      break;
+
+    default:
+      return false;
+    }
+
+    request.commands.push_back(command);
+  }
+
+  return r.isOk() && request.commands.size() == count;
+}
+
+
+bool fp::protocol::decodeCompletion(const string &body, Completion &completion)
+{
+  Reader r(body);
+
+  if (r.getByte() != MT_COMPLETION)
+  {
+    return false;
+  }
+
+  completion.requestId = r.getInt();
+  completion.ok = r.getByte() != 0;
+  completion.executed = r.getInt();
+  completion.error = r.getString();
+
+  return r.isOk();
+}
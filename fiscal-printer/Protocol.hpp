@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_PROTOCOL_HPP__
+#define __FP_PROTOCOL_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+#include <fiscal-printer/Scheduler.hpp>
+
+#include <boost/cstdint.hpp>
+
+
+namespace fp
+{
+
+
+/// Protokół demona fiscal-printerd.
+/**
+    Wiadomość: długość treści (4 bajty, little endian) i treść. Treść zaczyna się od typu
+    wiadomości (1 bajt). Liczby całkowite zapisywane są jako 4 bajty little endian, liczby
+    zmiennoprzecinkowe jako 4 bajty IEEE 754, napisy jako długość (4 bajty) i bajty napisu.
+ */
+namespace protocol
+{
+
+
+static const boost::uint32_t MAX_MESSAGE_SIZE = 1024 * 1024; ///< Maksymalna długość treści wiadomości.
+
+
+/// Typ wiadomości.
+enum MESSAGE_TYPE
+{
+  MT_REQUEST    = 1, ///< Zlecenie (klient -> demon).
+  MT_COMPLETION = 2  ///< Wynik zlecenia (demon -> klient).
+
+}; // enum MESSAGE_TYPE
+
+
+/// Typ rozkazu w zleceniu.
+enum COMMAND_TYPE
+{
+  CT_RECEIPT         = 1, ///< Paragon (Command::receipt).
+  CT_NON_FISCAL      = 2, ///< Wydruk niefiskalny (Command::nonFiscal).
+  CT_OPEN_DRAWER     = 3, ///< Otwarcie szuflady.
+  CT_BELL            = 4, ///< Sygnał dźwiękowy.
+  CT_DISPLAY_MESSAGE = 5  ///< Napis na wyświetlaczu (Command::message).
+
+}; // enum COMMAND_TYPE
+
+
+/// Rozkaz w zleceniu.
+struct Command
+{
+  COMMAND_TYPE type;                ///< Typ rozkazu.
+
+  fp::Receipt receipt;              ///< Paragon (CT_RECEIPT).
+  fp::NonFiscalDocument nonFiscal;  ///< Wydruk niefiskalny (CT_NON_FISCAL).
+  std::string message;              ///< Napis (CT_DISPLAY_MESSAGE).
+
+  Command() : type(CT_BELL) {}
+
+}; // struct Command
+
+
+/// Zlecenie: rozkazy wykonywane kolejno na jednej drukarce.
+struct Request
+{
+  boost::uint32_t requestId;      ///< Identyfikator zlecenia nadany przez klienta.
+
+  std::string printer;            ///< Nazwa drukarki (z konfiguracji demona).
+
+  fp::SCHEDULER_PRIORITY priority; ///< Klasa priorytetu (demon ustala ją sam dla paragonów i wydruków niefiskalnych).
+
+  std::vector<Command> commands;  ///< Rozkazy.
+
+  Request() : requestId(0), priority(fp::SP_NORMAL) {}
+
+}; // struct Request
+
+
+/// Wynik zlecenia.
+struct Completion
+{
+  boost::uint32_t requestId; ///< Identyfikator zlecenia.
+
+  bool ok;                   ///< Wszystkie rozkazy zostały wykonane.
+
+  boost::uint32_t executed;  ///< Ilość wykonanych rozkazów.
+
+  std::string error;         ///< Opis błędu.
+
+  Completion() : requestId(0), ok(false), executed(0) {}
+
+}; // struct Completion
+
+
+/// Zakodowanie zlecenia (razem z długością).
+std::string encodeRequest(const Request &request);
+
+/// Zakodowanie wyniku zlecenia (razem z długością).
+std::string encodeCompletion(const Completion &completion);
+
+/// Odczytanie długości treści z nagłówka (4 bajty).
+boost::uint32_t decodeLength(const char *header);
+
+/// Typ wiadomości (pierwszy bajt treści), 0 dla pustej treści.
+int messageType(const std::string &body);
+
+/// Odczytanie zlecenia z treści wiadomości.
+/**
+    @return false, jeśli treść jest niepoprawna
+ */
+bool decodeRequest(const std::string &body, Request &request);
+
+/// Odczytanie wyniku zlecenia z treści wiadomości.
+/**
+    @return false, jeśli treść jest niepoprawna
+ */
+bool decodeCompletion(const std::string &body, Completion &completion);
+
+
+} // namespace protocol
+
+
+} // namespace fp
+
+
+#endif // __FP_PROTOCOL_HPP__
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/ReconnectSupervisor.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+#include <boost/bind.hpp>
+
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+
+using namespace fp;
+using namespace std;
+
+
+ReconnectSupervisor::ReconnectSupervisor() : baudRate(9600), pollInterval(500), running(false), stopped(false),
+  reconnects(0), thread(NULL)
+{
+}
+
+
+ReconnectSupervisor::~ReconnectSupervisor()
+{
+  stop();
+}
+
+
+void ReconnectSupervisor::setDevice(const string &d, int b, const SerialOptions &o)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  device = d;
+  baudRate = b;
+  options = o;
+}
+
+
+void ReconnectSupervisor::setReconnectHandler(const ReconnectHandler &h)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  handler = h;
+}
+
+
+void ReconnectSupervisor::start(int p)
+{
+  if (thread != NULL)
+  {
+    return;
+  }
+
+  pollInterval = p;
+
+  running = true;
+  stopped = false;
+
+  thread = new boost::thread(boost::bind(&ReconnectSupervisor::run, this));
+}
+
+
+void ReconnectSupervisor::stop()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    running = false;
+    stopped = true;
+  }
+
+  condition.notify_all();
+
+  if (thread != NULL)
+  {
+    thread->join();
+
+    delete thread;
+    thread = NULL;
+  }
+}
+
+
+bool ReconnectSupervisor::isPresent() const
+{
+  string d;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    d = device;
+  }
+
+  return !d.empty() && ::access(d.c_str(), F_OK) == 0;
+}
+
+
+bool ReconnectSupervisor::recover(FiscalPrinter &printer)
+{
+  printer.close();
+
+  while (true)
+  {
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+
+      if (stopped)
+      {
+        return false;
+      }
+    }
+
+    ReconnectResult result;
+
+    if (isPresent() && reopen(printer, result))
+    {
+      ReconnectHandler h;
+
+      {
+        boost::lock_guard<boost::mutex> lock(mutex);
+
+        lastResult = result;
+
+        ++reconnects;
+
+        h = handler;
+      }
+
+      if (h)
+      {
+        h(result);
+      }
+
+      return true;
+    }
+
+    // oczekiwanie na zdarzenie inotify (lub upłynięcie czasu)
+
+    boost::unique_lock<boost::mutex> lock(mutex);
+
+    if (!stopped)
+    {
+      condition.timed_wait(lock, boost::posix_time::milliseconds(pollInterval));
+    }
+  }
+}
+
+
+ReconnectResult ReconnectSupervisor::getLastResult() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return lastResult;
+}
+
+
+unsigned long ReconnectSupervisor::getReconnects() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return reconnects;
+}
+
+
+bool ReconnectSupervisor::reopen(FiscalPrinter &printer, ReconnectResult &result)
+{
+  string d;
+  int b;
+  SerialOptions o;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    d = device;
+    b = baudRate;
+    o = options;
+  }
+
+  try
+  {
+    printer.open(d, b, o);
+
+    // urządzenie może już istnieć, ale drukarka jeszcze nie odpowiadać
+
+    if (!printer.probe(1000))
+    {
+      printer.close();
+
+      return false;
+    }
+
+    result.enqStatus = printer.getEnqStatus();
+    result.info = printer.getCashRegisterInfo6(CRI6M_0);
+
+    if (result.enqStatus.transaction || result.info.transaction != 0)
+    {
+      printer.cancelTransaction(Id());
+
+      result.transactionCancelled = true;
+
+      result.enqStatus = printer.getEnqStatus();
+    }
+
+    result.ok = true;
+
+    return true;
+  }
+  catch (const std::exception &)
+  {
+    // n.p. udev nie nadał jeszcze uprawnień do urządzenia
+
+    printer.close();
+
+    return false;
+  }
+}
+
+
+void ReconnectSupervisor::run()
+{
+  int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+  int wd = -1;
+
+  string directory;
+
+  while (true)
+  {
+    string d;
+
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+
+      if (!running)
+      {
+        break;
+      }
+
+      d = device;
+    }
+
+    // obserwowany jest katalog urządzenia, plik urządzenia znika razem z urządzeniem
+
+    string dir = d.substr(0, d.rfind('/') == string::npos ? 0 : d.rfind('/'));
+
+    if (dir.empty())
+    {
+      dir = ".";
+    }
+
+    if (fd != -1 && (wd == -1 || dir != directory))
+    {
+      if (wd != -1)
+      {
+        ::inotify_rm_watch(fd, wd);
+      }
+
+      wd = ::inotify_add_watch(fd, dir.c_str(), IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_TO | IN_MOVED_FROM);
+
+      directory = dir;
+    }
+
+    bool event = false;
+
+    if (fd != -1 && wd != -1)
+    {
+      struct pollfd pfd;
+
+      pfd.fd = fd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+
+      if (::poll(&pfd, 1, pollInterval) > 0)
+      {
+        char buffer[4096];
+
+        while (::read(fd, buffer, sizeof(buffer)) > 0)
+        {
+          event = true;
+        }
+      }
+
+      if (::access(directory.c_str(), F_OK) != 0)
+      {
+        ::inotify_rm_watch(fd, wd);
+
+        wd = -1; // katalog usunięty, obserwacja zostanie wznowiona po jego pojawieniu się
+      }
+    }
+    else
+    {
+      // brak katalogu (lub inotify), sprawdzanie obecności co 'pollInterval'
+
+      boost::unique_lock<boost::mutex> lock(mutex);
+
+      if (running)
+      {
+        condition.timed_wait(lock, boost::posix_time::milliseconds(pollInterval));
+      }
+
+      wd = -1;
+    }
+
+    if (event && isPresent())
+    {
+      condition.notify_all(); // ReconnectSupervisor::recover
+    }
+  }
+
+  if (fd != -1)
+  {
+    ::close(fd);
+  }
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_RECONNECT_SUPERVISOR_HPP__
+#define __FP_RECONNECT_SUPERVISOR_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+
+namespace fp
+{
+
+
+class FiscalPrinter;
+
+
+/// Wynik ponownego połączenia z drukarką.
+struct ReconnectResult
+{
+  bool ok;                        ///< Połączenie zostało odtworzone.
+
+  fp::EnqStatus enqStatus;        ///< Status ENQ po połączeniu.
+  fp::CashRegisterInfo6 info;     ///< Informacje kasowe (6) po połączeniu.
+
+  bool transactionCancelled;      ///< Przerwana transakcja została anulowana.
+
+  ReconnectResult() : ok(false), transactionCancelled(false) {}
+
+}; // struct ReconnectResult
+
+
+/// Ponowne otwieranie portu po odłączeniu urządzenia USB.
+/**
+    Wątek nadzorcy obserwuje katalog urządzenia (inotify) i budzi oczekujących, gdy plik
+    urządzenia pojawi się ponownie. Dodatkowo obecność urządzenia jest sprawdzana co
+    'pollInterval' milisekund (n.p. gdy katalog /dev/serial/by-id znika razem z urządzeniem).
+
+    Użycie ze Scheduler'em:
+
+    @code
+    fp::ReconnectSupervisor supervisor;
+    supervisor.setDevice("/dev/ttyUSB0", 9600, fp::SerialOptions::lowLatencyDefaults());
+    supervisor.start();
+
+    scheduler.setRecovery(boost::bind(&fp::ReconnectSupervisor::recover, &supervisor, _1));
+    @endcode
+
+    Po błędzie wejścia/wyjścia Scheduler woła ReconnectSupervisor::recover, które czeka na
+    urządzenie, otwiera port z tymi samymi ustawieniami i synchronizuje stan drukarki. Zadania
+    oczekujące w kolejkach są wykonywane po odtworzeniu połączenia.
+
+    @note Transakcja przerwana przez odłączenie jest anulowana (zadanie, które ją prowadziło,
+          kończy się błędem).
+
+    @note Nadzorcę należy zatrzymać przed zatrzymaniem Scheduler'a (wątek Scheduler'a może
+          czekać w ReconnectSupervisor::recover).
+ */
+class ReconnectSupervisor
+{
+
+public:
+
+  typedef boost::function<void (const fp::ReconnectResult &)> ReconnectHandler;
+
+  ReconnectSupervisor();
+  ~ReconnectSupervisor();
+
+  /// Ustawienie urządzenia.
+  void setDevice(const std::string &device, int baudRate = 9600, const fp::SerialOptions &options = fp::SerialOptions());
+
+  /// Ustawienie funkcji wołanej po każdym odtworzeniu połączenia.
+  void setReconnectHandler(const ReconnectHandler &handler);
+
+  /// Uruchomienie wątku obserwującego urządzenie.
+  /**
+      @param pollInterval Co ile milisekund sprawdzać obecność urządzenia
+   */
+  void start(int pollInterval = 500);
+
+  /// Zatrzymanie wątku (ReconnectSupervisor::recover przestaje czekać).
+  void stop();
+
+  /// Czy plik urządzenia istnieje.
+  bool isPresent() const;
+
+  /// Ponowne otwarcie portu.
+  /**
+      @param printer Drukarka (port jest zamykany i otwierany ponownie)
+
+      @return true, jeśli połączenie zostało odtworzone (false po ReconnectSupervisor::stop)
+
+      @note Metoda czeka na pojawienie się urządzenia i odpowiedź drukarki. Musi być wołana
+            z wątku, który ma dostęp do drukarki.
+   */
+  bool recover(fp::FiscalPrinter &printer);
+
+  /// Wynik ostatniego ponownego połączenia.
+  fp::ReconnectResult getLastResult() const;
+
+  /// Ilość ponownych połączeń.
+  unsigned long getReconnects() const;
+
+private:
+
+  void run();
+
+  bool reopen(fp::FiscalPrinter &printer, fp::ReconnectResult &result);
+
+  std::string device;
+  int baudRate;
+  fp::SerialOptions options;
+
+  int pollInterval;
+
+  bool running;
+  bool stopped;
+
+  unsigned long reconnects;
+
+  ReconnectHandler handler;
+
+  fp::ReconnectResult lastResult;
+
+  mutable boost::mutex mutex;
+  boost::condition_variable condition;
+
+  boost::thread *thread;
+
+}; // class ReconnectSupervisor
+
+
+} // namespace fp
+
+
+#endif // __FP_RECONNECT_SUPERVISOR_HPP__
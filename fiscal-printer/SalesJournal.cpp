@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#include <fiscal-printer/SalesJournal.hpp>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace fp;
+using namespace std;
+
+
+// Format rekordów dziennika (jeden rekord w linii, pola oddzielone tabulatorem):
+//
+//   R <czas> <maska> <A> <B> <C> <D> <E> <F> <G>    paragon (kwoty w groszach)
+//   D <czas>                                        raport dobowy
+
+
+namespace
+{
+
+/// Kwota w groszach pomnożona przez procent (zaokrąglenie do grosza).
+boost::int64_t percent(boost::int64_t amount, float value)
+{
+  double result = amount * (double)value / 100.0;
+
+  return (boost::int64_t)(result < 0.0 ? result - 0.5 : result + 0.5);
+}
+
+
+long elapsed(const boost::posix_time::ptime &start)
+{
+  return (long)(boost::posix_time::microsec_clock::universal_time() - start).total_microseconds();
+}
+
+} // namespace
+
+
+SalesJournal::SalesJournal() : fd(-1), mask(0)
+{
+}
+
+
+SalesJournal::~SalesJournal()
+{
+  close();
+}
+
+
+void SalesJournal::open(const string &path)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  if (fd != -1)
+  {
+    return;
+  }
+
+  boost::uint64_t length = load(path);
+
+  fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+  if (fd == -1)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "open");
+  }
+
+  // bajty po ostatnim znaku nowej linii to przerwany zapis, kolejny rekord byłby dopisany w tej samej linii
+
+  struct stat st;
+
+  if (::fstat(fd, &st) == 0 && (boost::uint64_t)st.st_size > length && ::ftruncate(fd, length) == -1)
+  {
+    int err = errno;
+
+    ::close(fd);
+    fd = -1;
+
+    throw boost::system::system_error(err, boost::system::system_category(), "ftruncate");
+  }
+}
+
+
+void SalesJournal::close()
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  if (fd != -1)
+  {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+
+bool SalesJournal::isOpen() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return fd != -1;
+}
+
+
+void SalesJournal::append(const VatTable &totals)
+{
+  ostringstream record;
+
+  record << "R\t" << boost::posix_time::to_iso_string(boost::posix_time::second_clock::universal_time())
+         << '\t' << totals.mask;
+
+  for (int i = 0; i < VatTable::SIZE; ++i)
+  {
+    record << '\t' << totals.values[i];
+  }
+
+  record << '\n';
+
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  writeRecord(record.str());
+
+  for (int i = 0; i < VatTable::SIZE; ++i)
+  {
+    columns[i].push_back(totals.values[i]);
+  }
+
+  mask |= totals.mask;
+}
+
+
+void SalesJournal::markDailyReport()
+{
+  string record = "D\t" + boost::posix_time::to_iso_string(boost::posix_time::second_clock::universal_time()) + "\n";
+
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  writeRecord(record);
+
+  days.push_back(columns[0].size());
+}
+
+
+size_t SalesJournal::size() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return columns[0].size();
+}
+
+
+VatTable SalesJournal::sum(size_t first, size_t last) const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return sumLocked(first, last);
+}
+
+
+SalesReconciliation SalesJournal::reconcile(const CashRegisterInfo2 &info) const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  size_t first = days.empty() ? 0 : days.back();
+
+  return compare(first, columns[0].size(), info.totals);
+}
+
+
+SalesReconciliation SalesJournal::reconcile(const DailyReportRecord &record) const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  size_t first = days.size() < 2 ? 0 : days[days.size() - 2];
+  size_t last = days.empty() ? 0 : days.back();
+
+  return compare(first, last, record.totals);
+}
+
+
+boost::int64_t SalesJournal::lineGross(const Item &item)
+{
+  return lineGross(item.gross, item.discountType, item.discountValue, item.line == 0);
+}
+
+
+boost::int64_t SalesJournal::lineGross(float gross, ITEM_DISCOUNT_TYPE discountType, float discountValue, bool storno)
+{
+  boost::int64_t amount = VatTable::toFixed(gross);
+
+  switch (discountType)
+  {
+  case IDT_1: amount -= VatTable::toFixed(discountValue); break;
+  case IDT_2: amount -= percent(amount, discountValue);   break;
+  case IDT_3: amount += VatTable::toFixed(discountValue); break;
+  case IDT_4: amount += percent(amount, discountValue);   break;
+
+  case IDT_0:
+  default:
+    break;
+  }
+
+  return storno ? -amount : amount;
+}
+
+
+void SalesJournal::applyDiscount(VatTable &totals, TRANSACTION_DISCOUNT_TYPE type, float value)
+{
+  if (type == TDT_0)
+  {
+    return;
+  }
+
+  for (int i = 0; i < VatTable::SIZE; ++i)
+  {
+    boost::int64_t change = percent(totals.values[i], value);
+
+    totals.values[i] += type == TDT_1 ? -change : change;
+  }
+}
+
+
+void SalesJournal::applyDiscount(VatTable &totals, DISCOUNT_TYPE type, float value)
+{
+  switch (type)
+  {
+  case DT_1: applyDiscount(totals, TDT_1, value); return;
+  case DT_2: applyDiscount(totals, TDT_2, value); return;
+
+  case DT_3:
+  case DT_4:
+    break;
+
+  case DT_0:
+  default:
+    return;
+  }
+
+  // kwota dzielona proporcjonalnie do kwot stawek, reszta z zaokrągleń trafia do stawki o największej kwocie
+
+  boost::int64_t total = totals.sum();
+
+  if (total == 0)
+  {
+    return;
+  }
+
+  boost::int64_t amount = VatTable::toFixed(value);
+  boost::int64_t left = amount;
+
+  int largest = 0;
+
+  for (int i = 0; i < VatTable::SIZE; ++i)
+  {
+    boost::int64_t part = (boost::int64_t)(amount * (double)totals.values[i] / total + 0.5);
+
+    totals.values[i] += type == DT_3 ? -part : part;
+
+    left -= part;
+
+    if (totals.values[i] > totals.values[largest])
+    {
+      largest = i;
+    }
+  }
+
+  totals.values[largest] += type == DT_3 ? -left : left;
+}
+
+
+boost::uint64_t SalesJournal::load(const string &path)
+{
+  for (int i = 0; i < VatTable::SIZE; ++i)
+  {
+    columns[i].clear();
+  }
+
+  mask = 0;
+
+  days.clear();
+
+  ifstream file(path.c_str());
+  string line;
+
+  boost::uint64_t length = 0; // długość pliku do ostatniego znaku nowej linii
+
+  while (getline(file, line))
+  {
+    if (file.eof()) // ostatnia linia bez znaku nowej linii
+    {
+      break;
+    }
+
+    length += line.size() + 1;
+
+    istringstream in(line);
+
+    string type;
+    string time;
+
+    in >> type >> time;
+
+    if (type == "D")
+    {
+      days.push_back(columns[0].size());
+    }
+    else if (type == "R")
+    {
+      unsigned int m = 0;
+      boost::int64_t values[VatTable::SIZE];
+
+      in >> m;
+
+      for (int i = 0; i < VatTable::SIZE; ++i)
+      {
+        in >> values[i];
+      }
+
+      if (!in) // niekompletny rekord (n.p. przerwany zapis)
+      {
+        continue;
+      }
+
+      for (int i = 0; i < VatTable::SIZE; ++i)
+      {
+        columns[i].push_back(values[i]);
+      }
+
+      mask |= m;
+    }
+  }
+
+  return length;
+}
+
+
+void SalesJournal::writeRecord(const string &record)
+{
+  if (fd == -1)
+  {
+    return;
+  }
+
+  const char *data = record.data();
+  size_t size = record.size();
+
+  while (size > 0)
+  {
+    ssize_t n = ::write(fd, data, size);
+
+    if (n == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      throw boost::system::system_error(errno, boost::system::system_category(), "write");
+    }
+
+    data += n;
+    size -= n;
+  }
+
+  if (::fdatasync(fd) == -1)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "fdatasync");
+  }
+}
+
+
+VatTable SalesJournal::sumLocked(size_t first, size_t last) const
+{
+  VatTable totals;
+
+  last = min(last, columns[0].size());
+
+  if (first >= last)
+  {
+    return totals;
+  }
+
+  // każda kolumna to ciągła tablica, pętla jest wektoryzowana przez kompilator
+
+  for (int i = 0; i < VatTable::SIZE; ++i)
+  {
+    const boost::int64_t *values = &columns[i][0];
+
+    boost::int64_t total = 0;
+
+    for (size_t j = first; j < last; ++j)
+    {
+      total += values[j];
+    }
+
+    totals.values[i] = total;
+  }
+
+  totals.mask = mask;
+  totals.size = VatTable::SIZE;
+
+  return totals;
+}
+
+
+SalesReconciliation SalesJournal::compare(size_t first, size_t last, const VatTable &totals) const
+{
+  boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+
+  SalesReconciliation result;
+
+  result.journal = sumLocked(first, last);
+  result.printer = totals;
+  result.difference = totals - result.journal;
+
+  result.receipts = last > first ? (long)(last - first) : 0;
+
+  result.duration = elapsed(start);
+
+  return result;
+}
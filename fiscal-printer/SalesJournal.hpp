@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#ifndef __FP_SALES_JOURNAL_HPP__
+#define __FP_SALES_JOURNAL_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+#include <boost/thread.hpp>
+
+
+namespace fp
+{
+
+
+/// Wynik uzgodnienia dziennika sprzedaży z totalizerami drukarki.
+struct SalesReconciliation
+{
+  fp::VatTable journal;    ///< Sumy brutto paragonów z dziennika.
+  fp::VatTable printer;    ///< Totalizery drukarki.
+  fp::VatTable difference; ///< Różnica: drukarka - dziennik.
+
+  long receipts;           ///< Ilość paragonów z dziennika.
+
+  long duration;           ///< Czas sumowania w mikrosekundach.
+
+  SalesReconciliation() : receipts(0), duration(0) {}
+
+  /// Totalizery są zgodne z dziennikiem dla wszystkich stawek.
+  bool isConsistent() const
+  {
+    for (int i = 0; i < VatTable::SIZE; ++i)
+    {
+      if (difference.values[i] != 0)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+}; // struct SalesReconciliation
+
+
+/// Lokalny dziennik sprzedaży (zatwierdzone paragony).
+/**
+    Każdy zatwierdzony paragon jest dopisywany do pliku jako sumy brutto linii paragonu według
+    stawek PTU, a raport dobowy jest zapisywany jako granica doby. Kwoty są przechowywane
+    w pamięci kolumnami (jedna tablica na stawkę), więc sumy dowolnego zakresu paragonów są
+    liczone prostymi pętlami po ciągłych tablicach.
+
+    Uzgodnienie porównuje sumy z dziennika z totalizerami drukarki:
+
+    @code
+    fp::SalesJournal sales;
+    sales.open("/var/lib/pos/sales.journal");
+
+    printer.setSalesJournal(&sales);
+    ...
+    fp::SalesReconciliation r = sales.reconcile(printer.getCashRegisterInfo2(fp::CRI2M_23, false));
+
+    if (!r.isConsistent())
+    {
+      // r.difference - rozbieżności według stawek
+    }
+    @endcode
+
+    @note Sumy linii paragonu uwzględniają rabaty i dopłaty do linii oraz do transakcji (zaokrąglane
+          do grosza dla każdej stawki, drukarka może zaokrąglać inaczej).
+          Faktury nie są zapisywane w dzienniku.
+
+    @note Metody mogą być wołane z wielu wątków (n.p. uzgodnienie z wątku aplikacji w czasie
+          sprzedaży).
+
+    @see FiscalPrinter::setSalesJournal
+ */
+class SalesJournal
+{
+
+public:
+
+  SalesJournal();
+  ~SalesJournal();
+
+  /// Otwórz dziennik.
+  /**
+      @param path Ścieżka do pliku dziennika (plik jest tworzony, jeśli nie istnieje, zapisane paragony są wczytywane)
+
+      @note Niedokończony ostatni rekord (przerwany zapis) jest obcinany, kolejne rekordy zaczynają się od nowej linii.
+
+      @note W przypadku błędu rzucany jest wyjątek boost::system::system_error.
+   */
+  void open(const std::string &path);
+
+  /// Zamknij dziennik.
+  /**
+      @note Metoda wołana w destruktorze.
+   */
+  void close();
+
+  /// Czy dziennik jest otwarty.
+  bool isOpen() const;
+
+  /// Dopisanie zatwierdzonego paragonu.
+  /**
+      @param totals Sumy brutto linii paragonu według stawek PTU
+
+      @note Rekord jest zapisywany na dysk (fdatasync) przed powrotem z metody.
+
+      @note W przypadku błędu zapisu rzucany jest wyjątek boost::system::system_error.
+   */
+  void append(const fp::VatTable &totals);
+
+  /// Zapisanie raportu dobowego (kolejne paragony należą do nowej doby).
+  void markDailyReport();
+
+  /// Ilość paragonów w dzienniku.
+  size_t size() const;
+
+  /// Sumy paragonów z zakresu [first;last).
+  fp::VatTable sum(size_t first, size_t last) const;
+
+  /// Uzgodnienie paragonów od ostatniego raportu dobowego z totalizerami (CRI2M_23).
+  /**
+      @param info Informacje kasowe odczytane w trybie CRI2M_23 (poza transakcją)
+   */
+  fp::SalesReconciliation reconcile(const fp::CashRegisterInfo2 &info) const;
+
+  /// Uzgodnienie paragonów doby zamkniętej ostatnim raportem dobowym z rekordem raportu.
+  /**
+      @param record Rekord raportu dobowego z pamięci fiskalnej (n.p. EndOfDayReport::dailyReport)
+   */
+  fp::SalesReconciliation reconcile(const fp::DailyReportRecord &record) const;
+
+  /// Kwota linii paragonu po rabacie lub dopłacie w groszach (ujemna dla operacji STORNO).
+  static boost::int64_t lineGross(const fp::Item &item);
+
+  /// Kwota linii paragonu po rabacie lub dopłacie w groszach.
+  /**
+      @param gross Kwota brutto linii
+      @param discountType Rodzaj rabatu
+      @param discountValue Kwota lub procent rabatu/dopłaty
+      @param storno Operacja STORNO (kwota ujemna)
+   */
+  static boost::int64_t lineGross(float gross, fp::ITEM_DISCOUNT_TYPE discountType, float discountValue, bool storno);
+
+  /// Zastosowanie procentowego rabatu (TDT_1) lub dopłaty (TDT_2) do transakcji.
+  static void applyDiscount(fp::VatTable &totals, fp::TRANSACTION_DISCOUNT_TYPE type, float value);
+
+  /// Zastosowanie rabatu lub narzutu do transakcji (kwotowy jest dzielony proporcjonalnie do kwot stawek).
+  static void applyDiscount(fp::VatTable &totals, fp::DISCOUNT_TYPE type, float value);
+
+private:
+
+  boost::uint64_t load(const std::string &path);
+
+  void writeRecord(const std::string &record);
+
+  fp::VatTable sumLocked(size_t first, size_t last) const;
+
+  fp::SalesReconciliation compare(size_t first, size_t last, const fp::VatTable &totals) const;
+
+  int fd;
+
+  std::vector<boost::int64_t> columns[VatTable::SIZE]; // kwoty paragonów w groszach, kolumna na stawkę
+
+  unsigned int mask;                                   // stawki występujące w paragonach
+
+  std::vector<size_t> days;                            // indeks pierwszego paragonu po każdym raporcie dobowym
+
+  mutable boost::mutex mutex;
+
+}; // class SalesJournal
+
+
+} // namespace fp
+
+
+#endif // __FP_SALES_JOURNAL_HPP__
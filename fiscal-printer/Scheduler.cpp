@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/Scheduler.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+#include <boost/bind.hpp>
+
+
+using namespace fp;
+using namespace std;
+using namespace boost;
+
+
+namespace
+{
+
+/// Zadanie złożone z listy kroków.
+class StepsJob : public Job
+{
+
+public:
+
+  StepsJob(const vector<Scheduler::Step> &s, const Scheduler::CompletionHandler &h,
+    const Scheduler::Step &c = Scheduler::Step(), const PrintEstimate &e = PrintEstimate()) :
+    steps(s), handler(h), cleanup(c), printEstimate(e), index(0) {}
+
+  bool step(FiscalPrinter &printer)
+  {
+    if (index < steps.size())
+    {
+      try
+      {
+        steps[index++](printer);
+      }
+      catch (const std::exception &)
+      {
+        // drukarka mogła zostać w trybie rozpoczętym przez poprzednie kroki
+
+        if (cleanup && index > 1)
+        {
+          cleanup(printer);
+        }
+
+        throw;
+      }
+    }
+
+    return index < steps.size();
+  }
+
+  void finished(bool ok, const string &error)
+  {
+    if (handler)
+    {
+      handler(ok, error);
+    }
+  }
+
+  PrintEstimate estimate(const PrintTimeModel &) const
+  {
+    return printEstimate;
+  }
+
+private:
+
+  vector<Scheduler::Step> steps;
+
+  Scheduler::CompletionHandler handler;
+
+  Scheduler::Step cleanup; // wołany po błędzie kroku (jeśli co najmniej jeden krok został wykonany)
+
+  PrintEstimate printEstimate; // oszacowanie z chwili zlecenia
+
+  size_t index;
+
+}; // class StepsJob
+
+
+/// Odczyt pamięci fiskalnej, jeden rekord na krok.
+class FiscalMemoryJob : public Job
+{
+
+public:
+
+  FiscalMemoryJob(long r, int c, const Scheduler::RecordHandler &rh, const Scheduler::CompletionHandler &h) :
+    row(r), count(c), recordHandler(rh), handler(h), started(false) {}
+
+  bool step(FiscalPrinter &printer)
+  {
+    if (!started)
+    {
+      printer.beginFiscalMemoryReadByRow(row);
+
+      started = true;
+
+      return count > 0;
+    }
+
+    FiscalMemoryRecord *record = printer.getFiscalMemoryRecord();
+
+    if (record == NULL)
+    {
+      return false;
+    }
+
+    --count;
+
+    if (recordHandler)
+    {
+      recordHandler(record);
+    }
+    else
+    {
+      delete record;
+    }
+
+    return count > 0;
+  }
+
+  void finished(bool ok, const string &error)
+  {
+    if (handler)
+    {
+      handler(ok, error);
+    }
+  }
+
+private:
+
+  long row;
+  int count;
+
+  Scheduler::RecordHandler recordHandler;
+  Scheduler::CompletionHandler handler;
+
+  bool started;
+
+}; // class FiscalMemoryJob
+
+} // namespace
+
+
+Scheduler::Scheduler(FiscalPrinter &p) : printer(p), backPressurePoll(0), paused(false), current(NULL),
+  currentPriority(SP_BULK), running(false), thread(NULL)
+{
+}
+
+
+Scheduler::~Scheduler()
+{
+  stop();
+
+  for (int i = 0; i < PRIORITIES; ++i)
+  {
+    while (!queues[i].empty())
+    {
+      delete queues[i].front();
+      queues[i].pop_front();
+    }
+  }
+}
+
+
+void Scheduler::start()
+{
+  if (thread != NULL)
+  {
+    return;
+  }
+
+  running = true;
+
+  thread = new boost::thread(boost::bind(&Scheduler::run, this));
+}
+
+
+void Scheduler::stop()
+{
+  if (thread == NULL)
+  {
+    return;
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    running = false;
+  }
+
+  condition.notify_all();
+
+  thread->join();
+
+  delete thread;
+  thread = NULL;
+
+  idle.notify_all();
+}
+
+
+void Scheduler::setRecovery(const Recovery &r)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  recovery = r;
+}
+
+
+void Scheduler::setBulkBackPressure(int pollInterval)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    backPressurePoll = pollInterval;
+  }
+
+  condition.notify_all();
+}
+
+
+void Scheduler::setPrintTimeModel(const PrintTimeModel &m)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  model = m;
+}
+
+
+PrintTimeModel Scheduler::getPrintTimeModel() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return model;
+}
+
+
+PrintEstimate Scheduler::estimate(const NonFiscalDocument &document) const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return model.estimate(document);
+}
+
+
+void Scheduler::submit(SCHEDULER_PRIORITY priority, Job *job)
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    queues[priority].push_back(job);
+  }
+
+  condition.notify_all();
+}
+
+
+void Scheduler::submit(SCHEDULER_PRIORITY priority, const vector<Step> &steps, const CompletionHandler &handler)
+{
+  submit(priority, new StepsJob(steps, handler));
+}
+
+
+void Scheduler::submit(SCHEDULER_PRIORITY priority, const Step &step, const CompletionHandler &handler)
+{
+  submit(priority, vector<Step>(1, step), handler);
+}
+
+
+void Scheduler::openDrawer()
+{
+  submit(SP_INTERACTIVE, Step(boost::bind(&FiscalPrinter::openDrawer, _1)));
+}
+
+
+void Scheduler::bell()
+{
+  submit(SP_INTERACTIVE, Step(boost::bind(&FiscalPrinter::bell, _1)));
+}
+
+
+void Scheduler::setDisplayMessage(const string &message)
+{
+  submit(SP_INTERACTIVE, Step(boost::bind(&FiscalPrinter::setDisplayMessage, _1, message)));
+}
+
+
+void Scheduler::printNonFiscal(const NonFiscalDocument &document, const CompletionHandler &handler)
+{
+  vector<Step> steps;
+
+  steps.push_back(boost::bind(&FiscalPrinter::beginNonFiscal, _1, document.printNr, document.headerNr));
+
+  for (size_t i = 0; i < document.lines.size(); ++i)
+  {
+    steps.push_back(boost::bind(&FiscalPrinter::printNonFiscal, _1, document.lines[i]));
+  }
+
+  steps.push_back(boost::bind(&FiscalPrinter::finishNonFiscal, _1, document.printNr, document.sysNr, document.extraLines));
+
+  steps.push_back(boost::bind(&FiscalPrinter::getEnqStatus, _1)); // odpowiedź po wydrukowaniu (koniec pomiaru)
+
+  submit(SP_BULK, new StepsJob(steps, handler, boost::bind(&FiscalPrinter::abortNonFiscal, _1, document.printNr),
+    estimate(document)));
+}
+
+
+void Scheduler::readFiscalMemory(long row, int count, const RecordHandler &recordHandler, const CompletionHandler &handler)
+{
+  submit(SP_BULK, new FiscalMemoryJob(row, count, recordHandler, handler));
+}
+
+
+size_t Scheduler::pending(SCHEDULER_PRIORITY priority) const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return queues[priority].size();
+}
+
+
+void Scheduler::wait()
+{
+  boost::unique_lock<boost::mutex> lock(mutex);
+
+  while (running)
+  {
+    bool empty = current == NULL;
+
+    for (int i = 0; i < PRIORITIES && empty; ++i)
+    {
+      empty = queues[i].empty();
+    }
+
+    if (empty)
+    {
+      break;
+    }
+
+    idle.wait(lock);
+  }
+}
+
+
+Job *Scheduler::next(int &priority)
+{
+  // zadania interaktywne mają pierwszeństwo zawsze (także w trakcie innego zadania)
+
+  if (!queues[SP_INTERACTIVE].empty())
+  {
+    priority = SP_INTERACTIVE;
+
+    return queues[SP_INTERACTIVE].front();
+  }
+
+  // rozpoczęte zadanie jest kontynuowane, drukarka może być w trybie tego zadania
+
+  if (current != NULL)
+  {
+    if (paused && currentPriority == SP_BULK)
+    {
+      return NULL;
+    }
+
+    priority = currentPriority;
+
+    return current;
+  }
+
+  for (int i = SP_NORMAL; i < PRIORITIES; ++i)
+  {
+    if (paused && i == SP_BULK)
+    {
+      break;
+    }
+
+    if (!queues[i].empty())
+    {
+      priority = i;
+
+      return queues[i].front();
+    }
+  }
+
+  return NULL;
+}
+
+
+bool Scheduler::checkBackPressure()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    if (backPressurePoll <= 0)
+    {
+      return false;
+    }
+  }
+
+  try
+  {
+    printer.pollFlowControl();
+  }
+  catch (const std::exception &)
+  {
+    return false; // błąd zostanie zgłoszony przez kolejny krok zadania
+  }
+
+  return printer.isFlowStopped();
+}
+
+
+void Scheduler::run()
+{
+  // pomiar czasu wykonania bieżącego zadania (model czasu wydruku)
+
+  Job *measured = NULL;
+  PrintEstimate measuredEstimate;
+  boost::posix_time::ptime measuredStart;
+  bool interleaved = false;
+
+  while (true)
+  {
+    Job *job = NULL;
+    int priority = SP_BULK;
+
+    bool stopped = checkBackPressure();
+
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+
+      paused = stopped;
+
+      while (running && (job = next(priority)) == NULL)
+      {
+        idle.notify_all();
+
+        if (paused)
+        {
+          // stan XON/XOFF zmienia się tylko przy odczycie portu, sprawdzamy go co 'backPressurePoll'
+
+          condition.timed_wait(lock, boost::posix_time::milliseconds(backPressurePoll));
+
+          lock.unlock();
+          stopped = checkBackPressure();
+          lock.lock();
+
+          paused = stopped;
+        }
+        else
+        {
+          condition.wait(lock);
+        }
+      }
+
+      if (!running)
+      {
+        break;
+      }
+
+      if (priority != SP_INTERACTIVE)
+      {
+        current = job;
+        currentPriority = priority;
+      }
+
+      if (priority != SP_INTERACTIVE && job != measured)
+      {
+        measured = job;
+        measuredEstimate = job->estimate(model);
+        measuredStart = boost::posix_time::microsec_clock::universal_time();
+        interleaved = false;
+      }
+      else if (priority == SP_INTERACTIVE && measured != NULL)
+      {
+        interleaved = true; // czas zadania interaktywnego zawyżyłby pomiar
+      }
+    }
+
+    bool more = false;
+    bool ok = true;
+    bool ioError = false;
+
+    string error;
+
+    try
+    {
+      more = job->step(printer);
+    }
+    catch (const boost::system::system_error &e)
+    {
+      ok = false;
+      ioError = true;
+      error = e.what();
+    }
+    catch (const std::exception &e)
+    {
+      ok = false;
+      error = e.what();
+    }
+
+    if (more && ok)
+    {
+      continue;
+    }
+
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+
+      queues[priority].pop_front();
+
+      if (job == current)
+      {
+        current = NULL;
+      }
+    }
+
+    if (job == measured)
+    {
+      if (ok && !interleaved && measuredEstimate.frames > 0)
+      {
+        boost::posix_time::time_duration elapsed = boost::posix_time::microsec_clock::universal_time() - measuredStart;
+
+        boost::lock_guard<boost::mutex> lock(mutex);
+
+        model.addSample(measuredEstimate, (long)elapsed.total_microseconds());
+      }
+
+      measured = NULL;
+    }
+
+    job->finished(ok, error);
+
+    delete job;
+
+    if (ioError)
+    {
+      Recovery r;
+
+      {
+        boost::lock_guard<boost::mutex> lock(mutex);
+
+        r = recovery;
+      }
+
+      if (r)
+      {
+        r(printer); // czeka na odtworzenie połączenia, kolejki są zachowane
+      }
+    }
+  }
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+#ifndef __FP_SCHEDULER_HPP__
+#define __FP_SCHEDULER_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+#include <fiscal-printer/PrintTimeModel.hpp>
+
+#include <deque>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+
+namespace fp
+{
+
+
+class FiscalPrinter;
+
+
+/// Klasa priorytetu zadania.
+enum SCHEDULER_PRIORITY
+{
+  SP_INTERACTIVE = 0, ///< Szuflada, wyświetlacz, sygnał dźwiękowy (obsługiwane między ramkami innych zadań).
+  SP_NORMAL      = 1, ///< Sprzedaż.
+  SP_BULK        = 2  ///< Raporty, odczyt pamięci fiskalnej, wydruki niefiskalne.
+
+}; // enum SCHEDULER_PRIORITY
+
+
+/// Zadanie wykonywane przez Scheduler.
+/**
+    Zadanie jest wykonywane krok po kroku, każdy krok powinien wysyłać jedną ramkę.
+    Pomiędzy krokami Scheduler może wysłać ramki zadań z klasy SP_INTERACTIVE.
+ */
+class Job
+{
+
+public:
+
+  virtual ~Job() {}
+
+  /// Wykonanie kolejnego kroku.
+  /**
+      @return true, jeśli zadanie ma kolejne kroki
+   */
+  virtual bool step(fp::FiscalPrinter &printer) = 0;
+
+  /// Zadanie zostało zakończone.
+  /**
+      @param ok Wszystkie kroki zostały wykonane
+      @param error Opis błędu (jeśli krok zakończył się wyjątkiem)
+
+      @note Wołane z wątku Scheduler'a.
+   */
+  virtual void finished(bool ok, const std::string &error) { (void)ok; (void)error; }
+
+  /// Oszacowanie czasu wydruku zadania (model czasu wydruku Scheduler'a).
+  /**
+      @return Oszacowanie (PrintEstimate::frames == 0 - czas zadania nie jest mierzony)
+
+      @note Zmierzony czas wykonania zadania koryguje model (PrintTimeModel::addSample), więc
+            mierzone zadanie powinno kończyć się odczytem statusu ENQ (FiscalPrinter::getEnqStatus),
+            tak jak zakłada oszacowanie.
+   */
+  virtual fp::PrintEstimate estimate(const fp::PrintTimeModel &model) const { (void)model; return fp::PrintEstimate(); }
+
+}; // class Job
+
+
+/// Kolejkowanie rozkazów wysyłanych do drukarki według klas priorytetu.
+/**
+    Wątek Scheduler'a ma wyłączny dostęp do drukarki. Zadania z klasy SP_INTERACTIVE są
+    wysyłane przed kolejną ramką rozpoczętego zadania z innej klasy, więc otwarcie szuflady
+    nie czeka na zakończenie n.p. odczytu pamięci fiskalnej albo długiego wydruku niefiskalnego.
+    Rozpoczęte zadanie z klasy SP_NORMAL lub SP_BULK nie jest przerywane zadaniem z klasy
+    SP_NORMAL (drukarka byłaby w niewłaściwym trybie).
+
+    Czas wykonania zadań z oszacowaniem czasu wydruku (Job::estimate, n.p. Scheduler::printNonFiscal)
+    jest mierzony od pierwszego kroku do ostatniego (bez czasu oczekiwania w kolejce, razem z czasem
+    wstrzymania nadawania przez XOFF) i koryguje model czasu wydruku drukarki. Pomiar jest pomijany,
+    jeśli w trakcie zadania wykonywano zadania z klasy SP_INTERACTIVE albo zadanie zakończyło się błędem.
+ */
+class Scheduler
+{
+
+public:
+
+  typedef boost::function<void (fp::FiscalPrinter &)> Step;
+  typedef boost::function<void (bool, const std::string &)> CompletionHandler;
+  typedef boost::function<void (fp::FiscalMemoryRecord *)> RecordHandler;
+  typedef boost::function<bool (fp::FiscalPrinter &)> Recovery;
+
+  explicit Scheduler(fp::FiscalPrinter &printer);
+  ~Scheduler();
+
+  /// Uruchomienie wątku.
+  void start();
+
+  /// Zatrzymanie wątku.
+  /**
+      @note Metoda wołana w destruktorze. Zadania w kolejkach nie są wykonywane.
+   */
+  void stop();
+
+  /// Ustawienie funkcji odtwarzającej połączenie po błędzie wejścia/wyjścia portu.
+  /**
+      Po błędzie wejścia/wyjścia zadanie kończy się błędem, a Scheduler woła funkcję odtwarzającą
+      przed wykonaniem kolejnych zadań (zadania oczekujące w kolejkach nie są tracone).
+
+      @see ReconnectSupervisor::recover
+   */
+  void setRecovery(const Recovery &recovery);
+
+  /// Wstrzymanie zadań z klasy SP_BULK, gdy drukarka wstrzymała nadawanie (XOFF).
+  /**
+      Drukarka wysyła XOFF, gdy bufor wydruku jest pełny. Rozpoczęte zadanie z klasy SP_BULK
+      (n.p. długi wydruk niefiskalny) nie wysyła wtedy kolejnych ramek, a nowe nie są rozpoczynane.
+      Zadania z klasy SP_INTERACTIVE są wykonywane bez zmian.
+
+      @param pollInterval Co ile milisekund sprawdzać stan XON/XOFF w czasie wstrzymania, 0 - wyłączone
+
+      @note Wymaga SerialOptions::userFlowControl.
+   */
+  void setBulkBackPressure(int pollInterval = 100);
+
+  /// Ustawienie modelu czasu wydruku drukarki (n.p. prędkość transmisji, parametry z poprzednich pomiarów).
+  void setPrintTimeModel(const fp::PrintTimeModel &model);
+
+  /// Model czasu wydruku drukarki (skorygowany pomiarami zadań).
+  fp::PrintTimeModel getPrintTimeModel() const;
+
+  /// Oszacowanie czasu wydruku niefiskalnego (Scheduler::printNonFiscal).
+  fp::PrintEstimate estimate(const fp::NonFiscalDocument &document) const;
+
+  /// Zlecenie zadania.
+  /**
+      @param priority Klasa priorytetu
+      @param job Zadanie (zwalniane przez Scheduler operatorem 'delete')
+   */
+  void submit(fp::SCHEDULER_PRIORITY priority, fp::Job *job);
+
+  /// Zlecenie zadania składającego się z kroków.
+  /**
+      @param priority Klasa priorytetu
+      @param steps Kroki (każdy krok powinien wysyłać jedną ramkę)
+      @param handler Funkcja wołana po zakończeniu zadania
+   */
+  void submit(fp::SCHEDULER_PRIORITY priority, const std::vector<Step> &steps,
+    const CompletionHandler &handler = CompletionHandler());
+
+  /// Zlecenie zadania składającego się z jednego kroku.
+  void submit(fp::SCHEDULER_PRIORITY priority, const Step &step,
+    const CompletionHandler &handler = CompletionHandler());
+
+  /// Otwarcie szuflady (SP_INTERACTIVE).
+  void openDrawer();
+
+  /// Sygnał dźwiękowy (SP_INTERACTIVE).
+  void bell();
+
+  /// Wysłanie napisu do wyświetlacza (SP_INTERACTIVE).
+  void setDisplayMessage(const std::string &message);
+
+  /// Wydruk niefiskalny (SP_BULK), każda linia jest osobnym krokiem.
+  /**
+      Po zakończeniu wydruku odczytywany jest status ENQ (koniec pomiaru czasu wydruku).
+
+      @note Jeśli krok po rozpoczęciu wydruku zakończy się błędem, to wydruk jest zamykany
+            (FiscalPrinter::abortNonFiscal) przed zakończeniem zadania.
+   */
+  void printNonFiscal(const fp::NonFiscalDocument &document,
+    const CompletionHandler &handler = CompletionHandler());
+
+  /// Odczyt pamięci fiskalnej (SP_BULK), każdy rekord jest osobnym krokiem.
+  /**
+      @param row Numer pierwszego rekordu
+      @param count Maksymalna ilość rekordów
+      @param recordHandler Funkcja wołana dla każdego rekordu (właścicielem rekordu jest funkcja)
+      @param handler Funkcja wołana po zakończeniu odczytu
+
+      @note Odczyt kończy się po odczytaniu pustego rekordu lub po odczytaniu 'count' rekordów.
+   */
+  void readFiscalMemory(long row, int count, const RecordHandler &recordHandler,
+    const CompletionHandler &handler = CompletionHandler());
+
+  /// Ilość zadań oczekujących w danej klasie priorytetu (łącznie z rozpoczętym).
+  size_t pending(fp::SCHEDULER_PRIORITY priority) const;
+
+  /// Oczekiwanie na wykonanie wszystkich zleconych zadań.
+  void wait();
+
+private:
+
+  static const int PRIORITIES = 3;
+
+  void run();
+
+  fp::Job *next(int &priority);
+
+  bool checkBackPressure();
+
+  fp::FiscalPrinter &printer;
+
+  Recovery recovery;
+
+  fp::PrintTimeModel model;
+
+  int backPressurePoll;
+  bool paused; // drukarka wstrzymała nadawanie, zadania z klasy SP_BULK czekają
+
+  std::deque<fp::Job *> queues[PRIORITIES];
+
+  fp::Job *current;
+  int currentPriority;
+
+  bool running;
+
+  mutable boost::mutex mutex;
+  boost::condition_variable condition;
+  boost::condition_variable idle;
+
+  boost::thread *thread;
+
+}; // class Scheduler
+
+
+} // namespace fp
+
+
+#endif // __FP_SCHEDULER_HPP__
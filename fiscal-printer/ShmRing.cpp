@@ -0,0 +1,727 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/ShmRing.hpp>
+
+#include <boost/system/system_error.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+using namespace fp;
+using namespace fp::shm;
+using namespace std;
+
+
+namespace
+{
+
+const boost::uint32_t RING_MAGIC = 0x46505247; // "FPRG"
+const boost::uint32_t RING_VERSION = 3;
+
+
+/// Zapisanie napisu w polu rekordu, napis dłuższy niż pole jest odrzucany.
+template <size_t N>
+void putString(char (&dst)[N], const string &src, const char *field)
+{
+  if (src.size() > N - 1)
+  {
+    throw std::length_error(string("fp::ShmRing: field too long: ") + field);
+  }
+
+  memcpy(dst, src.data(), src.size());
+
+  dst[src.size()] = '\0';
+}
+
+
+/// Zapisanie napisu w polu rekordu, obcięcie na granicy znaku UTF-8.
+template <size_t N>
+void putTruncated(char (&dst)[N], const string &src)
+{
+  size_t n = std::min(src.size(), N - 1);
+
+  while (n > 0 && n < src.size() && (src[n] & 0xc0) == 0x80) // bajt kontynuacji
+  {
+    --n;
+  }
+
+  memcpy(dst, src.data(), n);
+
+  dst[n] = '\0';
+}
+
+
+template <size_t N>
+string getString(const char (&src)[N])
+{
+  size_t n = 0;
+
+  while (n < N && src[n] != '\0')
+  {
+    ++n;
+  }
+
+  return string(src, n);
+}
+
+
+boost::uint32_t load(const boost::uint32_t *p)
+{
+  return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+
+void store(boost::uint32_t *p, boost::uint32_t value)
+{
+  __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+
+long futex(boost::uint32_t *word, int op, boost::uint32_t value, const struct timespec *timeout)
+{
+  // bez FUTEX_PRIVATE_FLAG, słowo leży w pamięci dzielonej między procesami
+
+  return ::syscall(SYS_futex, word, op, value, timeout, NULL, 0);
+}
+
+
+long long nowMs()
+{
+  struct timespec ts;
+
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+} // namespace
+
+
+/// Nagłówek bufora (liczniki nadawcy i odbiorcy w osobnych liniach pamięci podręcznej).
+struct ShmRing::Header
+{
+  boost::uint32_t magic;
+  boost::uint32_t version;
+  boost::uint32_t capacity;
+  boost::uint32_t recordSize;
+
+  char pad0[48];
+
+  boost::uint32_t head;            // zapisywany przez nadawcę
+  boost::uint32_t consumerWaiting;
+
+  char pad1[56];
+
+  boost::uint32_t tail;            // zapisywany przez odbiorcę
+  boost::uint32_t producerWaiting;
+  boost::uint32_t taken;           // ilość rekordów odczytanego paragonu (0 - brak), zapisywany przez odbiorcę
+  boost::uint32_t takenTail;       // pozycja odczytanego paragonu
+
+  char pad2[48];
+
+}; // struct ShmRing::Header
+
+
+size_t fp::shm::receiptRecords(const Receipt &receipt, const PaymentFormsInfo2 *paymentForms)
+{
+  size_t result = 2 + receipt.items.size(); // RT_BEGIN, RT_ITEM..., RT_CONFIRM
+
+  if (paymentForms != NULL)
+  {
+    result += paymentForms->paymentForms.size();
+    result += paymentForms->depositCollected.size();
+    result += paymentForms->depositReturned.size();
+  }
+
+  return result;
+}
+
+
+ShmRing::ShmRing() : header(NULL), records(NULL), size(0), mask(0)
+{
+}
+
+
+ShmRing::~ShmRing()
+{
+  close();
+}
+
+
+void ShmRing::create(const string &name, size_t capacity)
+{
+  close();
+
+  boost::uint32_t c = 1;
+
+  while (c < capacity)
+  {
+    c <<= 1;
+  }
+
+  int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+
+  if (fd == -1)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "shm_open");
+  }
+
+  size_t s = sizeof(Header) + c * sizeof(Record);
+
+  if (::ftruncate(fd, s) == -1)
+  {
+    int err = errno;
+
+    ::close(fd);
+
+    throw boost::system::system_error(err, boost::system::system_category(), "ftruncate");
+  }
+
+  map(fd, s);
+
+  memset(header, 0, sizeof(Header));
+
+  header->capacity = c;
+  header->recordSize = sizeof(Record);
+  header->version = RING_VERSION;
+
+  store(&header->magic, RING_MAGIC); // odbiorca sprawdza magic po otwarciu
+
+  mask = c - 1;
+}
+
+
+void ShmRing::open(const string &name)
+{
+  close();
+
+  int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+
+  if (fd == -1)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "shm_open");
+  }
+
+  struct stat st;
+
+  if (::fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(Header))
+  {
+    ::close(fd);
+
+    throw boost::system::system_error(EINVAL, boost::system::system_category(), "shm_open");
+  }
+
+  map(fd, st.st_size);
+
+  if (load(&header->magic) != RING_MAGIC || header->version != RING_VERSION ||
+    header->recordSize != sizeof(Record) || header->capacity == 0 ||
+    (header->capacity & (header->capacity - 1)) != 0 ||
+    sizeof(Header) + header->capacity * sizeof(Record) > size)
+  {
+    close();
+
+    throw boost::system::system_error(EINVAL, boost::system::system_category(), "shm_open");
+  }
+
+  mask = header->capacity - 1;
+}
+
+
+void ShmRing::close()
+{
+  if (header != NULL)
+  {
+    ::munmap(header, size);
+
+    header = NULL;
+    records = NULL;
+
+    size = 0;
+    mask = 0;
+  }
+}
+
+
+void ShmRing::unlink(const string &name)
+{
+  ::shm_unlink(name.c_str());
+}
+
+
+bool ShmRing::isOpen() const
+{
+  return header != NULL;
+}
+
+
+size_t ShmRing::freeSlots() const
+{
+  return header->capacity - (header->head - load(&header->tail));
+}
+
+
+Record *ShmRing::claim(size_t i)
+{
+  return &records[(header->head + i) & mask];
+}
+
+
+void ShmRing::publish(size_t n)
+{
+  store(&header->head, header->head + n);
+
+  if (load(&header->consumerWaiting) != 0)
+  {
+    futex(&header->head, FUTEX_WAKE, INT_MAX, NULL);
+  }
+}
+
+
+bool ShmRing::waitFree(size_t n, int timeout)
+{
+  return wait(&header->tail, &header->producerWaiting, n, false, timeout);
+}
+
+
+size_t ShmRing::available() const
+{
+  return load(&header->head) - header->tail;
+}
+
+
+const Record *ShmRing::peek(size_t i) const
+{
+  return &records[(header->tail + i) & mask];
+}
+
+
+void ShmRing::release(size_t n)
+{
+  store(&header->tail, header->tail + n);
+
+  if (load(&header->producerWaiting) != 0)
+  {
+    futex(&header->tail, FUTEX_WAKE, INT_MAX, NULL);
+  }
+}
+
+
+bool ShmRing::waitAvailable(size_t n, int timeout)
+{
+  return wait(&header->head, &header->consumerWaiting, n, true, timeout);
+}
+
+
+bool ShmRing::submitReceipt(boost::uint32_t seq, const Receipt &receipt, const PaymentFormsInfo2 *paymentForms)
+{
+  size_t n = receiptRecords(receipt, paymentForms);
+
+  if (n > header->capacity)
+  {
+    throw std::length_error("fp::ShmRing: receipt exceeds ring capacity");
+  }
+
+  if (n > freeSlots())
+  {
+    return false;
+  }
+
+  size_t i = 0;
+
+  Record *r = claim(i++);
+
+  r->type = RT_BEGIN;
+  r->seq = seq;
+  r->data.begin.records = n;
+
+  putString(r->data.begin.receiptId, receipt.receiptId, "Receipt::receiptId");
+  putString(r->data.begin.printerId, receipt.id.printerId, "Id::printerId");
+  putString(r->data.begin.operatorId, receipt.id.operatorId, "Id::operatorId");
+
+  for (size_t j = 0; j < receipt.items.size(); ++j)
+  {
+    const Item &item = receipt.items[j];
+
+    r = claim(i++);
+
+    r->type = RT_ITEM;
+    r->seq = seq;
+
+    ItemRecord &ir = r->data.item;
+
+    ir.line = item.line;
+
+    putString(ir.name, item.name, "Item::name");
+    putString(ir.barcode, item.barcode, "Item::barcode");
+    putString(ir.description, item.description, "Item::description");
+    putString(ir.vat, item.vat, "Item::vat");
+    putString(ir.quantity, item.quantity, "Item::quantity");
+
+    ir.price = item.price;
+    ir.gross = item.gross;
+
+    ir.discountType = item.discountType;
+    ir.discountDesc = item.discountDesc;
+    ir.discountValue = item.discountValue;
+
+    putString(ir.discountName, item.discountName, "Item::discountName");
+  }
+
+  if (paymentForms != NULL)
+  {
+    for (size_t j = 0; j < paymentForms->paymentForms.size(); ++j)
+    {
+      const PaymentForm &form = paymentForms->paymentForms[j];
+
+      r = claim(i++);
+
+      r->type = RT_PAYMENT_FORM;
+      r->seq = seq;
+
+      r->data.paymentForm.type = form.type;
+      r->data.paymentForm.amount = form.amount;
+
+      putString(r->data.paymentForm.name, form.name, "PaymentForm::name");
+    }
+
+    for (int k = 0; k < 2; ++k)
+    {
+      const PaymentFormsInfo2::Deposits &deposits = k == 0 ? paymentForms->depositCollected : paymentForms->depositReturned;
+
+      for (size_t j = 0; j < deposits.size(); ++j)
+      {
+        r = claim(i++);
+
+        r->type = RT_DEPOSIT;
+        r->seq = seq;
+
+        r->data.deposit.returned = k;
+        r->data.deposit.amount = deposits[j].amount;
+
+        putString(r->data.deposit.nr, deposits[j].nr, "Deposit::nr");
+        putString(r->data.deposit.quantity, deposits[j].quantity, "Deposit::quantity");
+      }
+    }
+  }
+
+  r = claim(i++);
+
+  r->type = RT_CONFIRM;
+  r->seq = seq;
+
+  ConfirmRecord &cr = r->data.confirm;
+
+  cr.paymentForms = paymentForms != NULL;
+
+  cr.cashFlag = paymentForms != NULL && paymentForms->cashFlag;
+  cr.changeFlag = paymentForms != NULL && paymentForms->changeFlag;
+
+  cr.cashIn = paymentForms != NULL ? paymentForms->cashIn : receipt.cashIn;
+  cr.changeOut = paymentForms != NULL ? paymentForms->changeOut : 0.0;
+  cr.total = receipt.total;
+
+  putString(cr.line1, receipt.extraLines.line1, "ExtraLines::line1");
+  putString(cr.line2, receipt.extraLines.line2, "ExtraLines::line2");
+  putString(cr.line3, receipt.extraLines.line3, "ExtraLines::line3");
+
+  publish(n); // cały paragon widoczny dla odbiorcy jednocześnie
+
+  return true;
+}
+
+
+bool ShmRing::takeReceipt(boost::uint32_t &seq, Receipt &receipt, PaymentFormsInfo2 &paymentForms, bool &usePaymentForms,
+  bool &interrupted)
+{
+  const Record *r = peek(0);
+
+  if (r->type != RT_BEGIN || r->data.begin.records < 2 || r->data.begin.records > available())
+  {
+    release(1);
+
+    return false;
+  }
+
+  size_t n = r->data.begin.records;
+
+  seq = r->seq;
+
+  // znacznik pozostał po odbiorcy, który nie zwolnił paragonu (ShmRing::releaseReceipt)
+
+  interrupted = load(&header->taken) != 0 && load(&header->takenTail) == header->tail;
+
+  receipt = Receipt();
+  paymentForms = PaymentFormsInfo2();
+
+  usePaymentForms = false;
+
+  receipt.receiptId = getString(r->data.begin.receiptId);
+  receipt.id.printerId = getString(r->data.begin.printerId);
+  receipt.id.operatorId = getString(r->data.begin.operatorId);
+
+  for (size_t i = 1; i < n; ++i)
+  {
+    r = peek(i);
+
+    switch (r->type)
+    {
+    case RT_ITEM:
+    {
+      const ItemRecord &ir = r->data.item;
+
+      Item item;
+
+      item.line = ir.line;
+
+      item.name = getString(ir.name);
+      item.barcode = getString(ir.barcode);
+      item.description = getString(ir.description);
+      item.vat = getString(ir.vat);
+      item.quantity = getString(ir.quantity);
+
+      item.price = ir.price;
+      item.gross = ir.gross;
+
+      item.discountType = (ITEM_DISCOUNT_TYPE)ir.discountType;
+      item.discountDesc = (DISCOUNT_DESCRIPTION_TYPE)ir.discountDesc;
+      item.discountValue = ir.discountValue;
+
+      item.discountName = getString(ir.discountName);
+
+      receipt.items.push_back(item);
+      break;
+    }
+
+    case RT_PAYMENT_FORM:
+    {
+      PaymentForm form;
+
+      form.type = (PAYMENT_TYPE)r->data.paymentForm.type;
+      form.name = getString(r->data.paymentForm.name);
+      form.amount = r->data.paymentForm.amount;
+
+      paymentForms.paymentForms.push_back(form);
+      break;
+    }
+
+    case RT_DEPOSIT:
+    {
+      Deposit deposit;
+
+      deposit.nr = getString(r->data.deposit.nr);
+      deposit.quantity = getString(r->data.deposit.quantity);
+      deposit.amount = r->data.deposit.amount;
+
+      if (r->data.deposit.returned)
+      {
+        paymentForms.depositReturned.push_back(deposit);
+      }
+      else
+      {
+        paymentForms.depositCollected.push_back(deposit);
+      }
+      break;
+    }
+
+    case RT_CONFIRM:
+    {
+      const ConfirmRecord &cr = r->data.confirm;
+
+      usePaymentForms = cr.paymentForms != 0;
+
+      paymentForms.cashFlag = cr.cashFlag != 0;
+      paymentForms.changeFlag = cr.changeFlag != 0;
+      paymentForms.cashIn = cr.cashIn;
+      paymentForms.changeOut = cr.changeOut;
+
+      receipt.cashIn = cr.cashIn;
+      receipt.total = cr.total;
+
+      receipt.extraLines.line1 = getString(cr.line1);
+      receipt.extraLines.line2 = getString(cr.line2);
+      receipt.extraLines.line3 = getString(cr.line3);
+      break;
+    }
+
+    default:
+      break;
+    }
+  }
+
+  // najpierw pozycja, potem ilość, znacznik z poprzedniego paragonu jest wyzerowany
+
+  store(&header->takenTail, header->tail);
+  store(&header->taken, n);
+
+  return true;
+}
+
+
+void ShmRing::releaseReceipt()
+{
+  boost::uint32_t n = load(&header->taken);
+
+  if (n == 0)
+  {
+    return;
+  }
+
+  // najpierw przesunięcie odbiorcy, znacznik nie wskazuje wtedy już na żaden paragon
+
+  release(n);
+
+  store(&header->taken, 0);
+}
+
+
+bool ShmRing::submitCompletion(boost::uint32_t seq, bool ok, const string &error)
+{
+  if (freeSlots() == 0)
+  {
+    return false;
+  }
+
+  Record *r = claim(0);
+
+  r->type = RT_COMPLETION;
+  r->seq = seq;
+
+  r->data.completion.ok = ok;
+
+  putTruncated(r->data.completion.error, error); // opis błędu tylko informacyjnie
+
+  publish(1);
+
+  return true;
+}
+
+
+bool ShmRing::takeCompletion(boost::uint32_t &seq, bool &ok, string &error)
+{
+  while (available() > 0)
+  {
+    const Record *r = peek(0);
+
+    if (r->type == RT_COMPLETION)
+    {
+      seq = r->seq;
+      ok = r->data.completion.ok != 0;
+      error = getString(r->data.completion.error);
+
+      release(1);
+
+      return true;
+    }
+
+    release(1);
+  }
+
+  return false;
+}
+
+
+void ShmRing::map(int fd, size_t s)
+{
+  void *p = ::mmap(NULL, s, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  int err = errno;
+
+  ::close(fd);
+
+  if (p == MAP_FAILED)
+  {
+    throw boost::system::system_error(err, boost::system::system_category(), "mmap");
+  }
+
+  header = (Header *)p;
+  records = (Record *)((char *)p + sizeof(Header));
+
+  size = s;
+}
+
+
+bool ShmRing::wait(boost::uint32_t *word, boost::uint32_t *waiting, size_t n, bool forData, int timeout)
+{
+  long long deadline = timeout >= 0 ? nowMs() + timeout : 0;
+
+  while (true)
+  {
+    if ((forData ? available() : freeSlots()) >= n)
+    {
+      return true;
+    }
+
+    boost::uint32_t observed = load(word);
+
+    store(waiting, 1);
+
+    // ponowne sprawdzenie po ustawieniu flagi, druga strona mogła zmienić licznik przed jej odczytaniem
+
+    if ((forData ? available() : freeSlots()) >= n)
+    {
+      store(waiting, 0);
+
+      return true;
+    }
+
+    struct timespec ts;
+    struct timespec *pts = NULL;
+
+    if (timeout >= 0)
+    {
+      long long left = deadline - nowMs();
+
+      if (left <= 0)
+      {
+        store(waiting, 0);
+
+        return false;
+      }
+
+      ts.tv_sec = left / 1000;
+      ts.tv_nsec = (left % 1000) * 1000000;
+
+      pts = &ts;
+    }
+
+    futex(word, FUTEX_WAIT, observed, pts);
+
+    store(waiting, 0);
+  }
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_SHM_RING_HPP__
+#define __FP_SHM_RING_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+#include <boost/cstdint.hpp>
+
+
+namespace fp
+{
+
+
+/// Rekordy przesyłane przez pamięć dzieloną (stały rozmiar, bez wskaźników).
+/**
+    Pola tekstowe są w UTF-8 i mieszczą maksymalną długość pola w drukarce (w znakach Mazovia),
+    gdy każdy znak jest polską literą (2 bajty), razem z zerem kończącym.
+ */
+namespace shm
+{
+
+
+/// Typ rekordu.
+enum RECORD_TYPE
+{
+  RT_BEGIN        = 1, ///< Rozpoczęcie paragonu (BeginRecord).
+  RT_ITEM         = 2, ///< Linia paragonu (ItemRecord).
+  RT_PAYMENT_FORM = 3, ///< Forma płatności (PaymentFormRecord).
+  RT_DEPOSIT      = 4, ///< Kaucja (DepositRecord).
+  RT_CONFIRM      = 5, ///< Zatwierdzenie paragonu (ConfirmRecord).
+  RT_COMPLETION   = 6  ///< Wynik wydruku paragonu (CompletionRecord).
+
+}; // enum RECORD_TYPE
+
+
+struct BeginRecord
+{
+  boost::uint32_t records;   ///< Ilość rekordów paragonu (łącznie z tym rekordem).
+
+  char receiptId[32];
+  char printerId[20];  // 8 znaków
+  char operatorId[68]; // 32 znaki
+
+}; // struct BeginRecord
+
+
+struct ItemRecord
+{
+  boost::int32_t line;
+
+  char name[84];         // 40 znaków
+  char barcode[64];      // 31 znaków
+  char description[324]; // 160 znaków
+  char vat[4];
+  char quantity[16];
+
+  float price;
+  float gross;
+
+  boost::int32_t discountType;
+  boost::int32_t discountDesc;
+  float discountValue;
+
+  char discountName[84]; // 40 znaków
+
+}; // struct ItemRecord
+
+
+struct PaymentFormRecord
+{
+  boost::int32_t type;
+
+  char name[44]; // 20 znaków
+
+  float amount;
+
+}; // struct PaymentFormRecord
+
+
+struct DepositRecord
+{
+  boost::int32_t returned; ///< 0 - kaucja pobrana, 1 - kaucja zwrócona.
+
+  char nr[16];
+  char quantity[16];
+
+  float amount;
+
+}; // struct DepositRecord
+
+
+struct ConfirmRecord
+{
+  boost::int32_t paymentForms; ///< 1 - zatwierdzenie z formami płatności (PaymentFormsInfo2).
+
+  boost::int32_t cashFlag;
+  boost::int32_t changeFlag;
+
+  float cashIn;
+  float changeOut;
+  float total;
+
+  char line1[84]; // 40 znaków
+  char line2[84];
+  char line3[84];
+
+}; // struct ConfirmRecord
+
+
+struct CompletionRecord
+{
+  boost::int32_t ok;
+
+  char error[128];
+
+}; // struct CompletionRecord
+
+
+/// Rekord (jedno miejsce w buforze).
+struct Record
+{
+  boost::uint32_t type; ///< Typ rekordu (RECORD_TYPE).
+  boost::uint32_t seq;  ///< Numer paragonu nadany przez nadawcę.
+
+  union
+  {
+    BeginRecord begin;
+    ItemRecord item;
+    PaymentFormRecord paymentForm;
+    DepositRecord deposit;
+    ConfirmRecord confirm;
+    CompletionRecord completion;
+
+  } data;
+
+}; // struct Record
+
+
+/// Ilość rekordów potrzebna do przesłania paragonu.
+size_t receiptRecords(const fp::Receipt &receipt, const fp::PaymentFormsInfo2 *paymentForms);
+
+
+} // namespace shm
+
+
+/// Bufor cykliczny w pamięci dzielonej (jeden nadawca, jeden odbiorca).
+/**
+    Nadawca i odbiorca działają w osobnych procesach. Wstawienie rekordów nie wymaga wywołań
+    systemowych, chyba że odbiorca czeka na dane (wtedy budzony jest przez futex w pamięci
+    dzielonej). Rekordy są publikowane razem (ShmRing::publish), więc odbiorca widzi od razu
+    cały paragon.
+
+    @note Bufor tworzy nadawca żądań (aplikacja POS), przy uruchomieniu bufor jest zerowany.
+
+    @note Paragon zajmuje miejsce w buforze żądań do czasu odesłania wyniku (RT_COMPLETION).
+          Jeśli wynik nie wraca w oczekiwanym czasie, aplikacja nie powinna wysyłać paragonu
+          ponownie: po ponownym uruchomieniu procesu drukującego paragon otrzyma wynik
+          (przerwany paragon - błąd). Dopiero po takim błędzie należy sprawdzić na drukarce
+          (n.p. numer ostatniego paragonu), czy paragon został wydrukowany, i ewentualnie
+          wysłać go pod nowym numerem.
+ */
+class ShmRing
+{
+
+public:
+
+  ShmRing();
+  ~ShmRing();
+
+  /// Utworzenie bufora.
+  /**
+      @param name Nazwa pamięci dzielonej (n.p. "/fp-lane1-requests")
+      @param capacity Ilość rekordów (zaokrąglana w górę do potęgi 2)
+   */
+  void create(const std::string &name, size_t capacity = 256);
+
+  /// Otwarcie istniejącego bufora.
+  void open(const std::string &name);
+
+  /// Zamknięcie bufora.
+  void close();
+
+  /// Usunięcie nazwy pamięci dzielonej.
+  static void unlink(const std::string &name);
+
+  bool isOpen() const;
+
+  // nadawca
+
+  /// Ilość wolnych miejsc.
+  size_t freeSlots() const;
+
+  /// Miejsce na i-ty kolejny rekord (i < freeSlots()).
+  fp::shm::Record *claim(size_t i);
+
+  /// Publikacja 'n' kolejnych rekordów.
+  void publish(size_t n);
+
+  /// Oczekiwanie na 'n' wolnych miejsc.
+  /**
+      @return false, jeśli upłynął czas oczekiwania
+   */
+  bool waitFree(size_t n, int timeout);
+
+  // odbiorca
+
+  /// Ilość rekordów do odczytania.
+  size_t available() const;
+
+  /// I-ty rekord do odczytania (i < available()).
+  const fp::shm::Record *peek(size_t i) const;
+
+  /// Zwolnienie 'n' odczytanych rekordów.
+  void release(size_t n);
+
+  /// Oczekiwanie na 'n' rekordów.
+  /**
+      @param n Ilość rekordów
+      @param timeout Czas oczekiwania w milisekundach (ujemny - bez ograniczenia)
+
+      @return false, jeśli upłynął czas oczekiwania
+   */
+  bool waitAvailable(size_t n, int timeout);
+
+  /// Przesłanie paragonu (bez wywołań systemowych, jeśli odbiorca nie czeka).
+  /**
+      @param seq Numer paragonu (wraca w rekordzie RT_COMPLETION)
+      @param receipt Paragon
+      @param paymentForms Formy płatności (jeśli NULL, to paragon jest zatwierdzany bez form płatności)
+
+      @return false, jeśli w buforze nie ma miejsca (aplikacja nie jest blokowana)
+
+      @throw std::length_error Pole tekstowe nie mieści się w rekordzie lub paragon ma więcej rekordów
+             niż pojemność bufora (ponowienie nic nie zmieni). Nic nie jest wtedy wysyłane.
+   */
+  bool submitReceipt(boost::uint32_t seq, const fp::Receipt &receipt, const fp::PaymentFormsInfo2 *paymentForms = NULL);
+
+  /// Odczytanie paragonu (odbiorca).
+  /**
+      Rekordy paragonu pozostają w buforze do wywołania ShmRing::releaseReceipt, więc awaria
+      odbiorcy przed odesłaniem wyniku nie gubi paragonu.
+
+      @param interrupted true, jeśli paragon został już odczytany przez odbiorcę, który nie zwolnił
+             go przed zakończeniem (wynik wydruku nie jest znany)
+
+      @return false, jeśli pierwszy rekord nie jest rekordem RT_BEGIN (rekordy są pomijane)
+   */
+  bool takeReceipt(boost::uint32_t &seq, fp::Receipt &receipt, fp::PaymentFormsInfo2 &paymentForms, bool &usePaymentForms,
+    bool &interrupted);
+
+  /// Zwolnienie rekordów odczytanego paragonu (po opublikowaniu wyniku).
+  void releaseReceipt();
+
+  /// Przesłanie wyniku wydruku paragonu.
+  bool submitCompletion(boost::uint32_t seq, bool ok, const std::string &error);
+
+  /// Odczytanie wyniku wydruku paragonu (bez oczekiwania).
+  bool takeCompletion(boost::uint32_t &seq, bool &ok, std::string &error);
+
+private:
+
+  struct Header;
+
+  void map(int fd, size_t size);
+
+  bool wait(boost::uint32_t *word, boost::uint32_t *waiting, size_t n, bool forData, int timeout);
+
+  Header *header;
+  fp::shm::Record *records;
+
+  size_t size;
+  boost::uint32_t mask;
+
+}; // class ShmRing
+
+
+} // namespace fp
+
+
+#endif // __FP_SHM_RING_HPP__
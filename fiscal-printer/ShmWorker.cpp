@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include <fiscal-printer/ShmWorker.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+
+using namespace fp;
+using namespace std;
+
+
+ShmWorker::ShmWorker(FiscalPrinter &p, ShmRing &r, ShmRing &c) : printer(p), requests(r), completions(c),
+  running(false), thread(NULL)
+{
+}
+
+
+ShmWorker::~ShmWorker()
+{
+  stop();
+}
+
+
+void ShmWorker::start()
+{
+  if (thread != NULL)
+  {
+    return;
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    running = true;
+  }
+
+  thread = new boost::thread(boost::bind(&ShmWorker::loop, this));
+}
+
+
+void ShmWorker::stop()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    running = false;
+  }
+
+  if (thread != NULL)
+  {
+    thread->join();
+
+    delete thread;
+    thread = NULL;
+  }
+}
+
+
+void ShmWorker::run()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    running = true;
+  }
+
+  loop();
+}
+
+
+bool ShmWorker::isRunning() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return running;
+}
+
+
+void ShmWorker::loop()
+{
+  // flaga ustawiana przed uruchomieniem wątku, więc wcześniejsze ShmWorker::stop nie zostanie zgubione
+
+  while (isRunning())
+  {
+    // ograniczony czas oczekiwania, żeby zauważyć ShmWorker::stop
+
+    if (!requests.waitAvailable(1, 200))
+    {
+      continue;
+    }
+
+    boost::uint32_t seq = 0;
+
+    Receipt receipt;
+    PaymentFormsInfo2 paymentForms;
+
+    bool usePaymentForms = false;
+    bool interrupted = false;
+
+    if (!requests.takeReceipt(seq, receipt, paymentForms, usePaymentForms, interrupted))
+    {
+      continue;
+    }
+
+    bool ok = true;
+
+    string error;
+
+    try
+    {
+      if (interrupted)
+      {
+        // paragon mógł zostać wydrukowany, ponowny wydruk mógłby go zdublować
+
+        recover(receipt);
+      }
+      else
+      {
+        print(receipt, paymentForms, usePaymentForms);
+      }
+    }
+    catch (const std::exception &e)
+    {
+      ok = false;
+      error = e.what();
+    }
+
+    bool submitted = false;
+
+    while (isRunning() && !(submitted = completions.submitCompletion(seq, ok, error)))
+    {
+      completions.waitFree(1, 200);
+    }
+
+    // bez opublikowanego wyniku paragon zostaje w buforze i po ponownym uruchomieniu jest zgłaszany jako przerwany
+
+    if (submitted)
+    {
+      requests.releaseReceipt();
+    }
+  }
+}
+
+
+void ShmWorker::recover(const Receipt &receipt)
+{
+  EnqStatus status = printer.getEnqStatus();
+
+  if (status.transaction)
+  {
+    printer.cancelTransaction(receipt.id);
+
+    throw std::runtime_error("fp::ShmWorker: interrupted receipt cancelled");
+  }
+
+  throw std::runtime_error("fp::ShmWorker: interrupted receipt, check the printer before resubmitting");
+}
+
+
+void ShmWorker::print(const Receipt &receipt, const PaymentFormsInfo2 &paymentForms, bool usePaymentForms)
+{
+  printer.beginTransaction(0, ExtraLines::none(), CIDT_NONE, "");
+
+  try
+  {
+    for (size_t i = 0; i < receipt.items.size(); ++i)
+    {
+      printer.printReceiptLine(receipt.items[i]);
+    }
+
+    if (usePaymentForms)
+    {
+      printer.confirmTransactionWithPaymentForms2(receipt.id, paymentForms, receipt.total, DT_0, 0.0, "", false,
+        receipt.extraLines);
+    }
+    else
+    {
+      printer.confirmTransaction(receipt.id, receipt.cashIn, receipt.total, TDT_0, 0.0, receipt.extraLines);
+    }
+  }
+  catch (const std::exception &)
+  {
+    printer.cancelTransaction(receipt.id);
+
+    throw;
+  }
+
+  EnqStatus status = printer.getEnqStatus();
+
+  if (status.transaction || !status.transactionOk)
+  {
+    string error = printer.getLastError().toString();
+
+    if (status.transaction)
+    {
+      printer.cancelTransaction(receipt.id);
+    }
+
+    throw std::runtime_error(error);
+  }
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_SHM_WORKER_HPP__
+#define __FP_SHM_WORKER_HPP__
+
+
+#include <fiscal-printer/ShmRing.hpp>
+
+#include <boost/thread.hpp>
+
+
+namespace fp
+{
+
+
+class FiscalPrinter;
+
+
+/// Proces drukujący paragony z bufora w pamięci dzielonej.
+/**
+    Odbiera paragony z bufora żądań, drukuje je i odsyła wyniki przez bufor wyników.
+    Zawieszenie drukarki blokuje tylko proces drukujący, aplikacja POS wysyła paragony
+    bez oczekiwania (ShmRing::submitReceipt).
+
+    Paragon jest zwalniany z bufora żądań dopiero po odesłaniu wyniku. Paragon przerwany
+    przez awarię procesu drukującego nie jest drukowany ponownie: po uruchomieniu zgłaszany jest
+    błąd (transakcja otwarta na drukarce jest anulowana).
+
+    @see ShmRing
+ */
+class ShmWorker
+{
+
+public:
+
+  /// Konstruktor.
+  /**
+      @param printer Drukarka
+      @param requests Bufor żądań (worker jest odbiorcą)
+      @param completions Bufor wyników (worker jest nadawcą)
+   */
+  ShmWorker(fp::FiscalPrinter &printer, fp::ShmRing &requests, fp::ShmRing &completions);
+  ~ShmWorker();
+
+  /// Uruchomienie wątku.
+  void start();
+
+  /// Zatrzymanie wątku.
+  void stop();
+
+  /// Obsługa paragonów w bieżącym wątku (do wywołania ShmWorker::stop).
+  void run();
+
+private:
+
+  bool isRunning() const;
+
+  void loop();
+
+  void recover(const fp::Receipt &receipt);
+
+  void print(const fp::Receipt &receipt, const fp::PaymentFormsInfo2 &paymentForms, bool usePaymentForms);
+
+  fp::FiscalPrinter &printer;
+
+  fp::ShmRing &requests;
+  fp::ShmRing &completions;
+
+  bool running;
+
+  mutable boost::mutex mutex;
+
+  boost::thread *thread;
+
+}; // class ShmWorker
+
+
+} // namespace fp
+
+
+#endif // __FP_SHM_WORKER_HPP__
@@ -0,0 +1,766 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+#include <fiscal-printer/Spool.hpp>
+#include <fiscal-printer/FiscalPrinter.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+using namespace fp;
+using namespace std;
+using namespace boost;
+
+
+namespace
+{
+
+const char *SPOOL_EXTENSION = ".receipt";
+const char *CONFIRM_EXTENSION = ".confirm"; // znacznik wysłanego rozkazu zatwierdzenia
+
+
+/// Trwałe zapisanie znacznika wysłania rozkazu zatwierdzenia paragonu (przed wysłaniem rozkazu).
+void markConfirmSent(const string &file)
+{
+  string marker = file + CONFIRM_EXTENSION;
+
+  int fd = ::open(marker.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if (fd == -1)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "open");
+  }
+
+  ::fsync(fd);
+  ::close(fd);
+
+  // wpis katalogu też musi przetrwać awarię
+
+  string directory = file.substr(0, file.rfind('/') + 1);
+
+  fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+
+  if (fd != -1)
+  {
+    ::fsync(fd);
+    ::close(fd);
+  }
+}
+
+
+void clearConfirmSent(const string &file)
+{
+  ::unlink((file + CONFIRM_EXTENSION).c_str());
+}
+
+
+bool isConfirmSent(const string &file)
+{
+  return ::access((file + CONFIRM_EXTENSION).c_str(), F_OK) == 0;
+}
+
+
+void writeString(ostream &out, const string &s)
+{
+  out << s.size() << ':' << s << '\n';
+}
+
+
+string readString(istream &in)
+{
+  size_t size = 0;
+  char c = 0;
+
+  in >> size;
+  in.get(c); // ':'
+
+  string s(size, '\0');
+
+  if (size > 0)
+  {
+    in.read(&s[0], size);
+  }
+
+  in.get(c); // '\n'
+
+  return s;
+}
+
+
+void writeReceipt(ostream &out, const Receipt &receipt)
+{
+  out << 1 << '\n'; // wersja formatu
+
+  out << setprecision(12);
+
+  writeString(out, receipt.receiptId);
+
+  writeString(out, receipt.id.printerId);
+  writeString(out, receipt.id.operatorId);
+
+  writeString(out, receipt.extraLines.line1);
+  writeString(out, receipt.extraLines.line2);
+  writeString(out, receipt.extraLines.line3);
+
+  out << receipt.cashIn << '\n';
+  out << receipt.total << '\n';
+
+  out << receipt.items.size() << '\n';
+
+  for (size_t i = 0; i < receipt.items.size(); ++i)
+  {
+    const Item &item = receipt.items[i];
+
+    out << item.line << '\n';
+
+    writeString(out, item.name);
+    writeString(out, item.barcode);
+    writeString(out, item.description);
+    writeString(out, item.vat);
+    writeString(out, item.quantity);
+
+    out << item.price << '\n';
+    out << item.gross << '\n';
+
+    out << (int)item.discountType << '\n';
+    out << (int)item.discountDesc << '\n';
+    out << item.discountValue << '\n';
+
+    writeString(out, item.discountName);
+  }
+}
+
+
+bool readReceipt(istream &in, Receipt &receipt)
+{
+  int version = 0;
+
+  in >> version;
+
+  if (version != 1)
+  {
+    return false;
+  }
+
+  receipt.receiptId = readString(in);
+
+  receipt.id.printerId = readString(in);
+  receipt.id.operatorId = readString(in);
+
+  receipt.extraLines.line1 = readString(in);
+  receipt.extraLines.line2 = readString(in);
+  receipt.extraLines.line3 = readString(in);
+
+  in >> receipt.cashIn;
+  in >> receipt.total;
+
+  size_t count = 0;
+
+  in >> count;
+
+  receipt.items.clear();
+
+  for (size_t i = 0; i < count && in; ++i)
+  {
+    Item item;
+
+    int discountType = 0;
+    int discountDesc = 0;
+
+    in >> item.line;
+
+    item.name = readString(in);
+    item.barcode = readString(in);
+    item.description = readString(in);
+    item.vat = readString(in);
+    item.quantity = readString(in);
+
+    in >> item.price;
+    in >> item.gross;
+
+    in >> discountType;
+    in >> discountDesc;
+    in >> item.discountValue;
+
+    item.discountType = (ITEM_DISCOUNT_TYPE)discountType;
+    item.discountDesc = (DISCOUNT_DESCRIPTION_TYPE)discountDesc;
+
+    item.discountName = readString(in);
+
+    receipt.items.push_back(item);
+  }
+
+  return !in.fail();
+}
+
+} // namespace
+
+
+Spool::Spool(FiscalPrinter &p, const string &d) : printer(p), directory(d), baudRate(9600),
+  pollInterval(1000), seq(0), available(false), running(false), thread(NULL)
+{
+  // numeracja jest kontynuowana od razu, więc paragon dodany przed start() nie nadpisze
+  // paragonu (ani znacznika zatwierdzenia) pozostałego z poprzedniego uruchomienia
+
+  vector<string> files;
+
+  scan(files);
+}
+
+
+Spool::~Spool()
+{
+  stop();
+}
+
+
+void Spool::setResultHandler(const ResultHandler &h)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  handler = h;
+}
+
+
+void Spool::setDevice(const string &d, int b)
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  device = d;
+  baudRate = b;
+}
+
+
+void Spool::start(int p)
+{
+  if (thread != NULL)
+  {
+    return;
+  }
+
+  load();
+
+  pollInterval = p;
+  running = true;
+
+  thread = new boost::thread(boost::bind(&Spool::run, this));
+}
+
+
+void Spool::stop()
+{
+  if (thread == NULL)
+  {
+    return;
+  }
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    running = false;
+  }
+
+  condition.notify_all();
+
+  thread->join();
+
+  delete thread;
+  thread = NULL;
+}
+
+
+void Spool::enqueue(const Receipt &receipt)
+{
+  Entry entry;
+
+  entry.receipt = receipt;
+  entry.interrupted = false;
+  entry.confirmSent = false;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    char name[32];
+    snprintf(name, sizeof(name), "%010ld", ++seq);
+
+    entry.file = directory + "/" + name + SPOOL_EXTENSION;
+  }
+
+  store(entry.file, receipt);
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    queue.push_back(entry);
+  }
+
+  condition.notify_all();
+}
+
+
+size_t Spool::size() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return queue.size();
+}
+
+
+bool Spool::isPrinterAvailable() const
+{
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  return available;
+}
+
+
+void Spool::run()
+{
+  bool reopen = false;
+
+  while (true)
+  {
+    Entry entry;
+
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+
+      while (running && queue.empty())
+      {
+        condition.wait(lock);
+      }
+
+      if (!running)
+      {
+        break;
+      }
+
+      entry = queue.front();
+    }
+
+    bool ok = checkPrinter(reopen);
+
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+
+      available = ok;
+    }
+
+    if (!ok)
+    {
+      boost::unique_lock<boost::mutex> lock(mutex);
+
+      if (running)
+      {
+        condition.timed_wait(lock, boost::posix_time::milliseconds(pollInterval));
+      }
+
+      continue;
+    }
+
+    string error;
+
+    bool printed = false;
+    bool retry = false;
+
+    try
+    {
+      if (entry.interrupted)
+      {
+        // poprzednia próba została przerwana, sprawdzamy jak daleko doszła
+
+        CashRegisterInfo6 info = printer.getCashRegisterInfo6(CRI6M_0);
+        EnqStatus status = printer.getEnqStatus();
+
+        if (info.transaction != 0 || status.transaction)
+        {
+          printer.cancelTransaction(entry.receipt.id);
+        }
+        else if (entry.confirmSent && status.transactionOk)
+        {
+          printed = true;
+        }
+      }
+
+      if (!printed)
+      {
+        printed = print(entry, error);
+
+        // drukarka przestała być dostępna w trakcie wydruku (n.p. skończył się papier),
+        // paragon zostaje w kolejce
+
+        if (!printed && !checkPrinter(reopen))
+        {
+          retry = true;
+        }
+      }
+    }
+    catch (const boost::system::system_error &)
+    {
+      // utrata połączenia z drukarką
+
+      reopen = true;
+
+      printer.close();
+
+      boost::lock_guard<boost::mutex> lock(mutex);
+
+      queue.front().interrupted = true;
+      queue.front().confirmSent = entry.confirmSent;
+
+      available = false;
+
+      continue;
+    }
+    catch (const std::exception &e)
+    {
+      // błąd w danych paragonu (n.p. fp::PrinterException), ponowienie skończy się tak samo,
+      // więc paragon jest odrzucany
+
+      printed = false;
+      error = e.what();
+
+      try
+      {
+        if (printer.getEnqStatus().transaction)
+        {
+          printer.cancelTransaction(entry.receipt.id);
+        }
+      }
+      catch (const boost::system::system_error &)
+      {
+        // transakcja mogła zostać otwarta - anulowanie przy następnej próbie
+
+        reopen = true;
+
+        printer.close();
+
+        boost::lock_guard<boost::mutex> lock(mutex);
+
+        queue.front().interrupted = true;
+        queue.front().confirmSent = entry.confirmSent;
+
+        available = false;
+
+        continue;
+      }
+    }
+
+    if (retry)
+    {
+      clearConfirmSent(entry.file);
+
+      boost::lock_guard<boost::mutex> lock(mutex);
+
+      queue.front().interrupted = true;
+      queue.front().confirmSent = false;
+
+      continue;
+    }
+
+    ::unlink(entry.file.c_str());
+
+    clearConfirmSent(entry.file);
+
+    {
+      boost::lock_guard<boost::mutex> lock(mutex);
+
+      queue.pop_front();
+    }
+
+    report(entry.receipt.receiptId, printed, error);
+  }
+}
+
+
+bool Spool::checkPrinter(bool &reopen)
+{
+  try
+  {
+    if (reopen || !printer.isOpen())
+    {
+      string d;
+      int b;
+
+      {
+        boost::lock_guard<boost::mutex> lock(mutex);
+
+        d = device;
+        b = baudRate;
+      }
+
+      if (d.empty())
+      {
+        return false;
+      }
+
+      printer.open(d, b);
+
+      reopen = false;
+    }
+
+    DleStatus status = printer.getDleStatus();
+
+    return status.online && !status.paper && !status.error;
+  }
+  catch (const boost::system::system_error &)
+  {
+    printer.close();
+
+    reopen = true;
+
+    return false;
+  }
+  catch (const std::exception &)
+  {
+    // nie jest to utrata połączenia, port pozostaje otwarty
+
+    return false;
+  }
+}
+
+
+bool Spool::print(Entry &entry, string &error)
+{
+  const Receipt &receipt = entry.receipt;
+
+  if (entry.confirmSent)
+  {
+    clearConfirmSent(entry.file);
+  }
+
+  entry.confirmSent = false;
+
+  printer.beginTransaction(0, ExtraLines::none(), CIDT_NONE, "");
+
+  for (size_t i = 0; i < receipt.items.size(); ++i)
+  {
+    printer.printReceiptLine(receipt.items[i]);
+  }
+
+  markConfirmSent(entry.file); // przed wysłaniem, żeby paragon nie został wydrukowany ponownie po awarii
+
+  entry.confirmSent = true;
+
+  printer.confirmTransaction(receipt.id, receipt.cashIn, receipt.total, TDT_0, 0.0, receipt.extraLines);
+
+  EnqStatus status = printer.getEnqStatus();
+
+  if (status.transaction || !status.transactionOk)
+  {
+    error = printer.getLastError().toString();
+
+    if (status.transaction)
+    {
+      printer.cancelTransaction(receipt.id);
+    }
+
+    return false;
+  }
+
+  return true;
+}
+
+
+void Spool::scan(vector<string> &files)
+{
+  vector<string> markers;
+
+  DIR *dir = ::opendir(directory.c_str());
+
+  if (dir == NULL)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "opendir");
+  }
+
+  struct dirent *e;
+
+  size_t len = strlen(SPOOL_EXTENSION);
+  size_t markerLen = len + strlen(CONFIRM_EXTENSION);
+
+  long last = 0;
+
+  while ((e = ::readdir(dir)) != NULL)
+  {
+    string name = e->d_name;
+
+    if (name.find(SPOOL_EXTENSION) == string::npos)
+    {
+      continue;
+    }
+
+    // numer zajmują także znaczniki i pliki tymczasowe bez pliku paragonu
+
+    long n = atol(name.c_str());
+
+    if (n > last)
+    {
+      last = n;
+    }
+
+    if (name.size() > len && name.compare(name.size() - len, len, SPOOL_EXTENSION) == 0)
+    {
+      files.push_back(name);
+    }
+    else if (name.size() > markerLen && name.compare(name.size() - markerLen, markerLen,
+      string(SPOOL_EXTENSION) + CONFIRM_EXTENSION) == 0)
+    {
+      markers.push_back(name.substr(0, name.size() - strlen(CONFIRM_EXTENSION)));
+    }
+  }
+
+  ::closedir(dir);
+
+  sort(files.begin(), files.end()); // nazwy plików to numery kolejne z zerami wiodącymi
+
+  // znacznik bez pliku paragonu to pozostałość po awarii między usunięciem paragonu a znacznika
+
+  for (size_t i = 0; i < markers.size(); ++i)
+  {
+    if (!binary_search(files.begin(), files.end(), markers[i]))
+    {
+      clearConfirmSent(directory + "/" + markers[i]);
+    }
+  }
+
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  if (last > seq)
+  {
+    seq = last;
+  }
+}
+
+
+void Spool::load()
+{
+  vector<string> files;
+
+  scan(files);
+
+  boost::lock_guard<boost::mutex> lock(mutex);
+
+  queue.clear();
+
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    Entry entry;
+
+    entry.file = directory + "/" + files[i];
+    entry.interrupted = true; // nie wiadomo, czy paragon nie był w trakcie wydruku
+    entry.confirmSent = isConfirmSent(entry.file);
+
+    ifstream in(entry.file.c_str(), ios::binary);
+
+    if (readReceipt(in, entry.receipt))
+    {
+      queue.push_back(entry);
+    }
+  }
+}
+
+
+void Spool::store(const string &file, const Receipt &receipt)
+{
+  ostringstream out;
+
+  writeReceipt(out, receipt);
+
+  string data = out.str();
+  string tmp = file + ".tmp";
+
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if (fd == -1)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "open");
+  }
+
+  const char *p = data.data();
+  size_t size = data.size();
+
+  while (size > 0)
+  {
+    ssize_t n = ::write(fd, p, size);
+
+    if (n == -1)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+
+      int err = errno;
+
+      ::close(fd);
+
+      throw boost::system::system_error(err, boost::system::system_category(), "write");
+    }
+
+    p += n;
+    size -= n;
+  }
+
+  ::fdatasync(fd);
+  ::close(fd);
+
+  if (::rename(tmp.c_str(), file.c_str()) == -1)
+  {
+    throw boost::system::system_error(errno, boost::system::system_category(), "rename");
+  }
+}
+
+
+void Spool::report(const string &receiptId, bool ok, const string &error)
+{
+  ResultHandler h;
+
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+
+    h = handler;
+  }
+
+  if (h)
+  {
+    SpoolResult result;
+
+    result.receiptId = receiptId;
+    result.ok = ok;
+    result.error = error;
+
+    h(result);
+  }
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+#ifndef __FP_SPOOL_HPP__
+#define __FP_SPOOL_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+#include <deque>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+
+namespace fp
+{
+
+
+class FiscalPrinter;
+
+
+/// Wynik wydruku paragonu z kolejki.
+struct SpoolResult
+{
+  std::string receiptId; ///< Identyfikator paragonu.
+
+  bool ok;               ///< Paragon został wydrukowany.
+
+  std::string error;     ///< Opis błędu (jeśli paragon nie został wydrukowany).
+
+  SpoolResult() : ok(false) {}
+
+}; // struct SpoolResult
+
+
+/// Kolejka paragonów wystawianych w czasie niedostępności drukarki.
+/**
+    Paragony są zapisywane w katalogu kolejki (jeden plik na paragon), więc przetrwają
+    restart aplikacji. Wątek kolejki sprawdza status DLE drukarki i, gdy drukarka jest
+    dostępna, drukuje zaległe paragony w kolejności przyjęcia.
+
+    @note Podczas pracy kolejki wątek kolejki ma wyłączny dostęp do drukarki. Nie należy
+          wtedy wywoływać metod drukarki z innych wątków.
+
+    @note Przed wysłaniem rozkazu zatwierdzenia zapisywany jest znacznik (plik ".confirm" obok pliku
+          paragonu), więc po awarii paragon zatwierdzony już przez drukarkę nie jest drukowany ponownie.
+          Błędy inne niż błędy wejścia/wyjścia (n.p. fp::PrinterException) odrzucają paragon.
+
+    @note Jeśli port zostanie zamknięty przez system (n.p. po odłączeniu konwertera USB),
+          to kolejka próbuje otworzyć go ponownie (Spool::setDevice).
+ */
+class Spool
+{
+
+public:
+
+  typedef boost::function<void (const fp::SpoolResult &)> ResultHandler;
+
+  /// Konstruktor.
+  /**
+      @param printer Drukarka
+      @param directory Katalog kolejki (musi istnieć)
+
+      @note Numeracja plików kolejki jest kontynuowana od ostatniego pliku w katalogu,
+            więc paragony można dodawać także przed Spool::start().
+   */
+  Spool(fp::FiscalPrinter &printer, const std::string &directory);
+  ~Spool();
+
+  /// Ustawienie funkcji wołanej po wydrukowaniu (lub odrzuceniu) każdego paragonu.
+  /**
+      @note Funkcja jest wołana z wątku kolejki.
+   */
+  void setResultHandler(const ResultHandler &handler);
+
+  /// Ustawienie urządzenia otwieranego ponownie po utracie połączenia.
+  /**
+      @param device Nazwa urządzenia (n.p. "/dev/ttyUSB0")
+      @param baudRate Prędkość transmisji
+   */
+  void setDevice(const std::string &device, int baudRate = 9600);
+
+  /// Uruchomienie wątku kolejki.
+  /**
+      @param pollInterval Co ile milisekund sprawdzać status drukarki, gdy jest niedostępna
+
+      @note Paragony zapisane w katalogu kolejki są wczytywane przy uruchomieniu.
+   */
+  void start(int pollInterval = 1000);
+
+  /// Zatrzymanie wątku kolejki.
+  /**
+      @note Metoda wołana w destruktorze. Niewydrukowane paragony pozostają w katalogu kolejki.
+   */
+  void stop();
+
+  /// Dodanie paragonu do kolejki.
+  /**
+      @note Paragon jest zapisywany na dysk przed powrotem z metody. Metoda nie czeka na drukarkę.
+            Paragon dodany przed Spool::start() zostanie wydrukowany po uruchomieniu kolejki.
+   */
+  void enqueue(const fp::Receipt &receipt);
+
+  /// Ilość paragonów oczekujących na wydruk.
+  size_t size() const;
+
+  /// Czy drukarka była dostępna przy ostatnim sprawdzeniu.
+  bool isPrinterAvailable() const;
+
+private:
+
+  struct Entry
+  {
+    std::string file;
+
+    fp::Receipt receipt;
+
+    bool interrupted; // poprzednia próba wydruku została przerwana przez utratę połączenia
+    bool confirmSent; // rozkaz zatwierdzenia został wysłany w poprzedniej próbie
+
+  }; // struct Entry
+
+  void run();
+
+  bool checkPrinter(bool &reopen);
+
+  bool print(Entry &entry, std::string &error);
+
+  void scan(std::vector<std::string> &files);
+  void load();
+  void store(const std::string &file, const fp::Receipt &receipt);
+
+  void report(const std::string &receiptId, bool ok, const std::string &error);
+
+  fp::FiscalPrinter &printer;
+
+  std::string directory;
+
+  std::string device;
+  int baudRate;
+
+  int pollInterval;
+
+  long seq;
+
+  bool available;
+  bool running;
+
+  ResultHandler handler;
+
+  std::deque<Entry> queue;
+
+  mutable boost::mutex mutex;
+  boost::condition_variable condition;
+
+  boost::thread *thread;
+
+}; // class Spool
+
+
+} // namespace fp
+
+
+#endif // __FP_SPOOL_HPP__
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#ifndef __FP_STATIC_VECTOR_HPP__
+#define __FP_STATIC_VECTOR_HPP__
+
+
+#include <cstddef>
+#include <stdexcept>
+
+
+namespace fp
+{
+
+
+/// Wektor o stałej pojemności z elementami przechowywanymi wewnątrz obiektu.
+/**
+    Pojemność odpowiada limitowi protokołu (n.p. 16 form płatności w rozkazie $y), więc dodawanie
+    elementów nie alokuje pamięci na kontener (w przeciwieństwie do std::vector), a przekroczenie
+    limitu jest zgłaszane już przy dodawaniu elementu, a nie dopiero przez drukarkę.
+
+    @note Elementy same mogą alokować pamięć (n.p. pola std::string dłuższe niż bufor wewnętrzny
+          napisu, jak nazwa formy płatności "Karta płatnicza").
+
+    @note Wszystkie N elementów jest tworzonych konstruktorem domyślnym razem z obiektem.
+          StaticVector::clear nie zwalnia elementów, są one nadpisywane przy kolejnym dodaniu.
+ */
+template <typename T, std::size_t N>
+class StaticVector
+{
+
+public:
+
+  typedef T value_type;
+  typedef T &reference;
+  typedef const T &const_reference;
+  typedef T *iterator;
+  typedef const T *const_iterator;
+  typedef std::size_t size_type;
+
+  static const std::size_t CAPACITY = N; ///< Maksymalna ilość elementów.
+
+  StaticVector() : count(0) {}
+
+  /// Dodanie elementu.
+  /**
+      @throw std::length_error Przekroczona pojemność
+   */
+  void push_back(const T &value)
+  {
+    if (count == N)
+    {
+      throw std::length_error("fp::StaticVector: capacity exceeded");
+    }
+
+    items[count++] = value;
+  }
+
+  /// Usunięcie ostatniego elementu.
+  void pop_back()
+  {
+    if (count > 0)
+    {
+      items[--count] = T();
+    }
+  }
+
+  void clear() { count = 0; }
+
+  std::size_t size() const { return count; }
+  static std::size_t capacity() { return N; }
+  static std::size_t max_size() { return N; }
+
+  bool empty() const { return count == 0; }
+  bool full() const { return count == N; }
+
+  T &operator[](std::size_t i) { return items[i]; }
+  const T &operator[](std::size_t i) const { return items[i]; }
+
+  /// Element z kontrolą zakresu.
+  /**
+      @throw std::out_of_range Indeks poza zakresem
+   */
+  T &at(std::size_t i)
+  {
+    check(i);
+
+    return items[i];
+  }
+
+  const T &at(std::size_t i) const
+  {
+    check(i);
+
+    return items[i];
+  }
+
+  T &front() { return items[0]; }
+  const T &front() const { return items[0]; }
+
+  T &back() { return items[count - 1]; }
+  const T &back() const { return items[count - 1]; }
+
+  iterator begin() { return items; }
+  iterator end() { return items + count; }
+
+  const_iterator begin() const { return items; }
+  const_iterator end() const { return items + count; }
+
+private:
+
+  void check(std::size_t i) const
+  {
+    if (i >= count)
+    {
+      throw std::out_of_range("fp::StaticVector: index out of range");
+    }
+  }
+
+  T items[N];
+
+  std::size_t count;
+
+}; // class StaticVector
+
+
+} // namespace fp
+
+
+#endif // __FP_STATIC_VECTOR_HPP__
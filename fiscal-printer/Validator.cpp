@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#include <fiscal-printer/Validator.hpp>
+#include <fiscal-printer/Frame.hpp>
+
+
+using namespace fp;
+using namespace std;
+using namespace boost;
+
+
+namespace
+{
+
+string describe(const ValidationErrors &errors)
+{
+  string result;
+
+  for (size_t i = 0; i < errors.size(); ++i)
+  {
+    if (i > 0)
+    {
+      result += "; ";
+    }
+
+    result += errors[i].toString();
+  }
+
+  return result;
+}
+
+
+bool checkLength(const string &text, size_t min, size_t max, const char *field, int code, ValidationErrors &errors)
+{
+  size_t length = mazoviaLength(text);
+
+  if (length < min || length > max)
+  {
+    errors.push_back(ValidationError(field, code));
+
+    return false;
+  }
+
+  return true;
+}
+
+
+bool checkRange(float value, float min, float max, const char *field, int code, ValidationErrors &errors)
+{
+  if (!(value >= min && value <= max)) // NaN też jest błędem
+  {
+    errors.push_back(ValidationError(field, code));
+
+    return false;
+  }
+
+  return true;
+}
+
+const float MAX_AMOUNT = 99999999.99f; // 10 cyfr, 2 miejsca po przecinku
+
+} // namespace
+
+
+PrinterException::PrinterException(const ValidationErrors &e) : std::runtime_error(describe(e)),
+  error(e.empty() ? PrinterError() : e.front().error), errors(e)
+{
+}
+
+
+bool fp::validate(const Id &id, ValidationErrors &errors)
+{
+  bool ok = true;
+
+  ok &= checkLength(id.printerId, 0, 8, "Id::printerId", 41, errors);
+  ok &= checkLength(id.operatorId, 0, 32, "Id::operatorId", 42, errors);
+
+  return ok;
+}
+
+
+bool fp::validate(const Item &item, ValidationErrors &errors)
+{
+  bool ok = validateItemTemplate(item, errors);
+
+  ok &= validateItemLine(item.line, item.quantity, item.gross, errors);
+
+  return ok;
+}
+
+
+bool fp::validateItemTemplate(const Item &item, ValidationErrors &errors)
+{
+  bool ok = true;
+
+  ok &= checkLength(item.name, 2, 40, "Item::name", 16, errors);
+  ok &= checkLength(item.description, 0, 160, "Item::description", 34, errors);
+  ok &= checkLength(item.discountName, 0, 40, "Item::discountName", 38, errors);
+
+  if (!item.barcode.empty())
+  {
+    ok &= checkLength(item.barcode, 1, 31, "Item::barcode", 34, errors);
+  }
+
+  if (item.vat.size() != 1 || item.vat[0] < 'A' || item.vat[0] > 'G')
+  {
+    errors.push_back(ValidationError("Item::vat", 18));
+    ok = false;
+  }
+
+  ok &= checkRange(item.price, 0.0, MAX_AMOUNT, "Item::price", 19, errors);
+
+  return ok;
+}
+
+
+bool fp::validateItemLine(int line, const string &quantity, float gross, ValidationErrors &errors)
+{
+  bool ok = true;
+
+  if (line != 0 && quantity.empty())
+  {
+    errors.push_back(ValidationError("Item::quantity", 17));
+    ok = false;
+  }
+
+  ok &= checkRange(gross, 0.0, MAX_AMOUNT, "Item::gross", 20, errors);
+
+  return ok;
+}
+
+
+bool fp::validate(const PaymentFormsInfo1 &info, ValidationErrors &errors)
+{
+  bool ok = true;
+
+  ok &= checkLength(info.cardName, 0, 16, "PaymentFormsInfo1::cardName", 34, errors);
+  ok &= checkLength(info.chequeName, 0, 16, "PaymentFormsInfo1::chequeName", 34, errors);
+  ok &= checkLength(info.couponName, 0, 16, "PaymentFormsInfo1::couponName", 34, errors);
+
+  return ok;
+}
+
+
+bool fp::validate(const BeginInvoiceData &data, ValidationErrors &errors)
+{
+  bool ok = true;
+
+  if (data.items < 0 || data.items > 255)
+  {
+    errors.push_back(ValidationError("BeginInvoiceData::items", 23));
+    ok = false;
+  }
+
+  if ((data.additionalCopies < 0 || data.additionalCopies > 9) && data.additionalCopies != 255)
+  {
+    errors.push_back(ValidationError("BeginInvoiceData::additionalCopies", 4));
+    ok = false;
+  }
+
+  ok &= checkLength(data.invoiceNr, 0, 15, "BeginInvoiceData::invoiceNr", 34, errors);
+  ok &= checkLength(data.nip, 13, 13, "BeginInvoiceData::nip", 34, errors);
+  ok &= checkLength(data.timeout, 0, 16, "BeginInvoiceData::timeout", 34, errors);
+  ok &= checkLength(data.paymentForm, 0, 20, "BeginInvoiceData::paymentForm", 34, errors);
+
+  if (data.paymentForm == "INNA" || data.paymentForm == "INNE")
+  {
+    errors.push_back(ValidationError("BeginInvoiceData::paymentForm", 34));
+    ok = false;
+  }
+
+  ok &= checkLength(data.client, 0, 26, "BeginInvoiceData::client", 44, errors);
+  ok &= checkLength(data.seller, 0, 26, "BeginInvoiceData::seller", 34, errors);
+  ok &= checkLength(data.systemNr, 0, 30, "BeginInvoiceData::systemNr", 34, errors);
+
+  return ok;
+}
+
+
+bool fp::validateHeader(const string &header, ValidationErrors &errors)
+{
+  return checkLength(header, 0, 200, "header", 12, errors);
+}
+
+
+bool fp::validateClientId(CLIENT_ID_TYPE clientIdType, const string &clientId, ValidationErrors &errors)
+{
+  if (clientIdType == CIDT_NONE)
+  {
+    return true;
+  }
+
+  return checkLength(clientId, 0, 13, "clientId", 34, errors);
+}
+
+
+bool fp::validateShift(const string &shift, ValidationErrors &errors)
+{
+  return checkLength(shift, 0, 8, "shift", 33, errors);
+}
+
+
+void fp::require(const ValidationErrors &errors)
+{
+  if (!errors.empty())
+  {
+    throw PrinterException(errors);
+  }
+}
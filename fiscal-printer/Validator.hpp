@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+
+#ifndef __FP_VALIDATOR_HPP__
+#define __FP_VALIDATOR_HPP__
+
+
+#include <fiscal-printer/Common.hpp>
+
+#include <stdexcept>
+
+
+namespace fp
+{
+
+
+/// Błąd danych rozkazu wykryty przed wysłaniem do drukarki.
+struct ValidationError
+{
+  std::string field;      ///< Pole (n.p. "Item::name").
+
+  fp::PrinterError error; ///< Błąd, który zgłosiłaby drukarka.
+
+  ValidationError() {}
+  ValidationError(const std::string &f, int code) : field(f), error(code) {}
+
+  std::string toString() const { return field + ": " + error.toString(); }
+
+}; // struct ValidationError
+
+
+typedef std::vector<fp::ValidationError> ValidationErrors;
+
+
+/// Wyjątek z błędem drukarki wykrytym przez bibliotekę (rozkaz nie został wysłany).
+class PrinterException : public std::runtime_error
+{
+
+public:
+
+  explicit PrinterException(const fp::ValidationErrors &errors);
+  virtual ~PrinterException() throw() {}
+
+  /// Pierwszy błąd (kod jak w odpowiedzi na rozkaz #n).
+  const fp::PrinterError &getError() const { return error; }
+
+  /// Wszystkie wykryte błędy.
+  const fp::ValidationErrors &getErrors() const { return errors; }
+
+private:
+
+  fp::PrinterError error;
+
+  fp::ValidationErrors errors;
+
+}; // class PrinterException
+
+
+/// Sprawdzenie ograniczeń pól opisanych w dokumentacji protokołu.
+/**
+    Długości tekstów są liczone w bajtach po zakodowaniu w Mazovia (polskie litery zajmują w UTF-8
+    dwa bajty, a w ramce jeden). Każdy błąd jest dopisywany do 'errors' z kodem błędu, który
+    zgłosiłaby drukarka, więc aplikacja może obsłużyć go tak samo jak FiscalPrinter::getLastError.
+
+    @return true, jeśli dane są poprawne
+
+    @see FiscalPrinter::setValidation
+ */
+bool validate(const fp::Id &id, fp::ValidationErrors &errors);
+bool validate(const fp::Item &item, fp::ValidationErrors &errors);
+bool validate(const fp::PaymentFormsInfo1 &info, fp::ValidationErrors &errors);
+bool validate(const fp::BeginInvoiceData &data, fp::ValidationErrors &errors);
+
+/// Pola linii paragonu zapisywane w szablonie (FiscalPrinter::makeItemTemplate), bez numeru linii, ilości i kwoty brutto.
+bool validateItemTemplate(const fp::Item &item, fp::ValidationErrors &errors);
+
+/// Pola linii paragonu podawane przy wydruku z szablonu (numer linii, ilość, kwota brutto).
+bool validateItemLine(int line, const std::string &quantity, float gross, fp::ValidationErrors &errors);
+
+/// Nagłówek (maksymalnie 200 znaków).
+bool validateHeader(const std::string &header, fp::ValidationErrors &errors);
+
+/// Identyfikator nabywcy (maksymalnie 13 znaków).
+bool validateClientId(fp::CLIENT_ID_TYPE clientIdType, const std::string &clientId, fp::ValidationErrors &errors);
+
+/// Nazwa zmiany (maksymalnie 8 znaków).
+bool validateShift(const std::string &shift, fp::ValidationErrors &errors);
+
+/// Zgłoszenie wykrytych błędów.
+/**
+    @throw fp::PrinterException Lista błędów nie jest pusta
+ */
+void require(const fp::ValidationErrors &errors);
+
+
+} // namespace fp
+
+
+#endif // __FP_VALIDATOR_HPP__
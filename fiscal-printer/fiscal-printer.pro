@@ -8,6 +8,8 @@ INCLUDEPATH += ..
 
 DEFINES += DEBUG_FISCAL_PRINTER
 
-SOURCES += FiscalPrinter.cpp
+SOURCES += FiscalPrinter.cpp Journal.cpp Spool.cpp Scheduler.cpp DisplayChannel.cpp ItemTemplateCache.cpp Protocol.cpp Client.cpp ShmRing.cpp ShmWorker.cpp ReconnectSupervisor.cpp FrameDecoder.cpp PrintTimeModel.cpp NonFiscalRouter.cpp Frame.cpp Validator.cpp InfoView.cpp EndOfDay.cpp SalesJournal.cpp
 
-HEADERS += Common.hpp FiscalPrinter.hpp
+HEADERS += Common.hpp FiscalPrinter.hpp Command.hpp Journal.hpp Spool.hpp Scheduler.hpp DisplayChannel.hpp ItemTemplateCache.hpp Protocol.hpp Client.hpp ShmRing.hpp ShmWorker.hpp ReconnectSupervisor.hpp FrameDecoder.hpp PrintTimeModel.hpp NonFiscalRouter.hpp Frame.hpp StaticVector.hpp Validator.hpp InfoView.hpp EndOfDay.hpp SalesJournal.hpp
+
+LIBS += -lrt -lboost_coroutine -lboost_context
@@ -0,0 +1,553 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include "Daemon.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include <unistd.h>
+
+
+using namespace fp;
+using namespace fp::protocol;
+using namespace std;
+using namespace boost;
+
+
+namespace
+{
+
+/// Zlecenie klienta wykonywane krok po kroku (jedna ramka na krok).
+class RequestJob : public Job
+{
+
+public:
+
+  typedef boost::function<void (const Completion &)> Handler;
+
+  RequestJob(const Request &r, const string &d, int b, const Handler &h) : request(r), device(d), baudRate(b),
+    handler(h), command(0), stage(0), line(0), inTransaction(false), inNonFiscal(false)
+  {
+    completion.requestId = request.requestId;
+  }
+
+  bool step(FiscalPrinter &printer)
+  {
+    try
+    {
+      if (command == 0 && stage == 0 && !printer.isOpen())
+      {
+        printer.open(device, baudRate);
+      }
+
+      if (command < request.commands.size() && execute(printer, request.commands[command]))
+      {
+        stage = 0;
+        line = 0;
+
+        ++command;
+        ++completion.executed;
+      }
+    }
+    catch (const std::exception &)
+    {
+      if (inTransaction)
+      {
+        // przerwany paragon nie może zostać otwarty w drukarce
+
+        try
+        {
+          printer.cancelTransaction(request.commands[command].receipt.id);
+        }
+        catch (const std::exception &)
+        {
+          printer.close();
+        }
+
+        inTransaction = false;
+      }
+
+      if (inNonFiscal)
+      {
+        // przerwany wydruk niefiskalny blokowałby kolejne paragony
+
+        printer.abortNonFiscal(request.commands[command].nonFiscal.printNr);
+
+        inNonFiscal = false;
+      }
+
+      throw;
+    }
+
+    return command < request.commands.size();
+  }
+
+  void finished(bool ok, const string &error)
+  {
+    completion.ok = ok;
+    completion.error = error;
+
+    handler(completion);
+  }
+
+  PrintEstimate estimate(const PrintTimeModel &model) const
+  {
+    int lines = 0;
+    int frames = 0;
+    long bytes = 0;
+
+    for (size_t i = 0; i < request.commands.size(); ++i)
+    {
+      const Command &c = request.commands[i];
+
+      PrintEstimate e;
+
+      if (c.type == CT_RECEIPT)
+      {
+        e = model.estimate(c.receipt);
+      }
+      else if (c.type == CT_NON_FISCAL)
+      {
+        e = model.estimate(c.nonFiscal);
+      }
+
+      lines += e.lines;
+      frames += e.frames;
+      bytes += e.bytes;
+    }
+
+    // zlecenie bez paragonów i wydruków niefiskalnych nie jest mierzone
+
+    return frames > 0 ? model.estimate(lines, frames, bytes) : PrintEstimate();
+  }
+
+private:
+
+  /// Kolejny krok rozkazu, true jeśli rozkaz został zakończony.
+  bool execute(FiscalPrinter &printer, const Command &c)
+  {
+    switch (c.type)
+    {
+    case CT_RECEIPT:
+      return receipt(printer, c.receipt);
+
+    case CT_NON_FISCAL:
+      return nonFiscal(printer, c.nonFiscal);
+
+    case CT_OPEN_DRAWER:
+      printer.openDrawer();
+      return true;
+
+    case CT_BELL:
+      printer.bell();
+      return true;
+
+    case CT_DISPLAY_MESSAGE:
+      printer.setDisplayMessage(c.message);
+      return true;
+
+    default:
+      throw std::runtime_error("unknown command");
+    }
+  }
+
+  bool receipt(FiscalPrinter &printer, const Receipt &r)
+  {
+    switch (stage)
+    {
+    case 0:
+      printer.beginTransaction(0, ExtraLines::none(), CIDT_NONE, "");
+
+      inTransaction = true;
+
+      ++stage;
+      return false;
+
+    case 1:
+      if (line < r.items.size())
+      {
+        printer.printReceiptLine(r.items[line++]);
+
+        return false;
+      }
+
+      printer.confirmTransaction(r.id, r.cashIn, r.total, TDT_0, 0.0, r.extraLines);
+
+      ++stage;
+      return false;
+
+    default:
+    {
+      EnqStatus status = printer.getEnqStatus();
+
+      if (status.transaction || !status.transactionOk)
+      {
+        string error = printer.getLastError().toString();
+
+        throw std::runtime_error(error); // anulowanie w step()
+      }
+
+      inTransaction = false;
+
+      return true;
+    }
+    }
+  }
+
+  bool nonFiscal(FiscalPrinter &printer, const NonFiscalDocument &d)
+  {
+    switch (stage)
+    {
+    case 0:
+      printer.beginNonFiscal(d.printNr, d.headerNr);
+
+      inNonFiscal = true;
+
+      ++stage;
+      return false;
+
+    case 1:
+      if (line < d.lines.size())
+      {
+        printer.printNonFiscal(d.lines[line++]);
+
+        return false;
+      }
+
+      printer.finishNonFiscal(d.printNr, d.sysNr, d.extraLines);
+
+      inNonFiscal = false;
+
+      ++stage;
+      return false;
+
+    default:
+      printer.getEnqStatus(); // odpowiedź po wydrukowaniu (pomiar czasu wydruku, jak dla paragonu)
+
+      return true;
+    }
+  }
+
+  Request request;
+
+  string device;
+  int baudRate;
+
+  Handler handler;
+
+  Completion completion;
+
+  size_t command;
+  int stage;
+  size_t line;
+
+  bool inTransaction;
+  bool inNonFiscal;
+
+}; // class RequestJob
+
+
+/// Klasa priorytetu zlecenia ustalana przez demona na podstawie rozkazów.
+/**
+    Paragony wykonywane są z SP_NORMAL, wydruki niefiskalne z SP_BULK.
+    SP_INTERACTIVE (przeplatany z trwającym zleceniem) dozwolony jest tylko
+    dla szuflady, sygnału i wyświetlacza - nie zmieniają one stanu transakcji.
+
+    @return false, jeśli klient zażądał SP_INTERACTIVE dla zlecenia z paragonem lub wydrukiem niefiskalnym
+ */
+bool schedulingPriority(const Request &request, SCHEDULER_PRIORITY &priority)
+{
+  bool receipts = false;
+  bool nonFiscal = false;
+
+  for (size_t i = 0; i < request.commands.size(); ++i)
+  {
+    if (request.commands[i].type == CT_RECEIPT)
+    {
+      receipts = true;
+    }
+    else if (request.commands[i].type == CT_NON_FISCAL)
+    {
+      nonFiscal = true;
+    }
+  }
+
+  if (!receipts && !nonFiscal)
+  {
+    priority = request.priority;
+    return true;
+  }
+
+  if (request.priority == SP_INTERACTIVE)
+  {
+    return false;
+  }
+
+  priority = receipts ? SP_NORMAL : SP_BULK;
+  return true;
+}
+
+} // namespace
+
+
+Daemon::Session::Session(Daemon &d, boost::asio::io_service &io) : daemon(d), socket(io)
+{
+}
+
+
+boost::asio::local::stream_protocol::socket &Daemon::Session::getSocket()
+{
+  return socket;
+}
+
+
+void Daemon::Session::start()
+{
+  readHeader();
+}
+
+
+void Daemon::Session::send(const string &data)
+{
+  bool idle = output.empty();
+
+  output.push_back(data);
+
+  if (idle)
+  {
+    write();
+  }
+}
+
+
+void Daemon::Session::readHeader()
+{
+  boost::asio::async_read(socket, boost::asio::buffer(header, sizeof(header)),
+    boost::bind(&Session::handleHeader, shared_from_this(), boost::asio::placeholders::error));
+}
+
+
+void Daemon::Session::handleHeader(const boost::system::error_code &error)
+{
+  if (error)
+  {
+    return; // rozłączenie klienta, zlecenia w kolejkach są wykonywane dalej
+  }
+
+  uint32_t size = decodeLength(header);
+
+  if (size == 0 || size > MAX_MESSAGE_SIZE)
+  {
+    socket.close();
+
+    return;
+  }
+
+  body.assign(size, '\0');
+
+  boost::asio::async_read(socket, boost::asio::buffer(&body[0], size),
+    boost::bind(&Session::handleBody, shared_from_this(), boost::asio::placeholders::error));
+}
+
+
+void Daemon::Session::handleBody(const boost::system::error_code &error)
+{
+  if (error)
+  {
+    return;
+  }
+
+  Request request;
+
+  if (!decodeRequest(body, request))
+  {
+    socket.close(); // niepoprawna wiadomość, dalsza synchronizacja strumienia nie jest możliwa
+
+    return;
+  }
+
+  daemon.execute(shared_from_this(), request);
+
+  readHeader();
+}
+
+
+void Daemon::Session::write()
+{
+  boost::asio::async_write(socket, boost::asio::buffer(output.front()),
+    boost::bind(&Session::handleWrite, shared_from_this(), boost::asio::placeholders::error));
+}
+
+
+void Daemon::Session::handleWrite(const boost::system::error_code &error)
+{
+  if (error)
+  {
+    output.clear();
+
+    return;
+  }
+
+  output.pop_front();
+
+  if (!output.empty())
+  {
+    write();
+  }
+}
+
+
+Daemon::Daemon(const string &p) : socketPath(p), acceptor(io), signals(io, SIGINT, SIGTERM)
+{
+  ::unlink(socketPath.c_str());
+
+  boost::asio::local::stream_protocol::endpoint endpoint(socketPath);
+
+  acceptor.open(endpoint.protocol());
+  acceptor.bind(endpoint);
+  acceptor.listen();
+
+  signals.async_wait(boost::bind(&Daemon::stop, this));
+}
+
+
+Daemon::~Daemon()
+{
+  for (std::map<string, Printer *>::iterator i = printers.begin(); i != printers.end(); ++i)
+  {
+    i->second->supervisor.stop();
+    i->second->scheduler.stop();
+
+    delete i->second;
+  }
+
+  ::unlink(socketPath.c_str());
+}
+
+
+void Daemon::addPrinter(const string &name, const string &device, int baudRate)
+{
+  Printer *printer = new Printer(device, baudRate);
+
+  try
+  {
+    printer->printer.open(device, baudRate);
+  }
+  catch (const std::exception &e)
+  {
+    std::cerr << name << ": " << device << ": " << e.what() << std::endl;
+  }
+
+  printer->supervisor.setDevice(device, baudRate);
+  printer->supervisor.start();
+
+  printer->scheduler.setRecovery(boost::bind(&ReconnectSupervisor::recover, &printer->supervisor, _1));
+  printer->scheduler.setPrintTimeModel(PrintTimeModel(baudRate));
+  printer->scheduler.start();
+
+  printers[name] = printer;
+}
+
+
+void Daemon::run()
+{
+  accept();
+
+  io.run();
+}
+
+
+void Daemon::stop()
+{
+  io.stop();
+}
+
+
+void Daemon::accept()
+{
+  SessionPtr session(new Session(*this, io));
+
+  acceptor.async_accept(session->getSocket(),
+    boost::bind(&Daemon::handleAccept, this, session, boost::asio::placeholders::error));
+}
+
+
+void Daemon::handleAccept(SessionPtr session, const boost::system::error_code &error)
+{
+  if (!error)
+  {
+    session->start();
+  }
+
+  accept();
+}
+
+
+void Daemon::execute(SessionPtr session, const Request &request)
+{
+  std::map<string, Printer *>::iterator i = printers.find(request.printer);
+
+  if (i == printers.end())
+  {
+    Completion completion;
+
+    completion.requestId = request.requestId;
+    completion.error = "unknown printer: " + request.printer;
+
+    session->send(encodeCompletion(completion));
+
+    return;
+  }
+
+  SCHEDULER_PRIORITY priority;
+
+  if (!schedulingPriority(request, priority))
+  {
+    Completion completion;
+
+    completion.requestId = request.requestId;
+    completion.error = "interactive priority not allowed for receipts and non-fiscal printouts";
+
+    session->send(encodeCompletion(completion));
+
+    return;
+  }
+
+  Printer *printer = i->second;
+
+  printer->scheduler.submit(priority, new RequestJob(request, printer->device, printer->baudRate,
+    boost::bind(&Daemon::complete, this, session, _1)));
+}
+
+
+void Daemon::complete(SessionPtr session, const Completion &completion)
+{
+  // wołane z wątku Scheduler'a, wysyłanie w wątku demona
+
+  io.post(boost::bind(&Session::send, session, encodeCompletion(completion)));
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#ifndef __FP_DAEMON_HPP__
+#define __FP_DAEMON_HPP__
+
+
+#include <fiscal-printer/FiscalPrinter.hpp>
+#include <fiscal-printer/Protocol.hpp>
+#include <fiscal-printer/ReconnectSupervisor.hpp>
+#include <fiscal-printer/Scheduler.hpp>
+
+#include <deque>
+#include <map>
+
+#include <boost/asio.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
+
+
+namespace fp
+{
+
+
+/// Demon drukarek fiskalnych.
+/**
+    Demon ma wyłączny dostęp do drukarek. Porty są otwierane przy uruchomieniu i pozostają
+    otwarte niezależnie od klientów. Zlecenia klientów trafiają do Scheduler'a drukarki,
+    więc dostęp do jednej drukarki jest szeregowany.
+
+    @see Client
+ */
+class Daemon
+{
+
+public:
+
+  /// Konstruktor.
+  /**
+      @param socketPath Ścieżka gniazda Unix (istniejący plik jest usuwany)
+   */
+  explicit Daemon(const std::string &socketPath);
+  ~Daemon();
+
+  /// Dodanie drukarki.
+  /**
+      @param name Nazwa drukarki używana w zleceniach
+      @param device Nazwa urządzenia (n.p. "/dev/ttyUSB0")
+      @param baudRate Prędkość transmisji
+
+      @note Jeśli port nie może zostać otwarty, to jest otwierany ponownie przy kolejnym zleceniu.
+            Po odłączeniu urządzenia port jest otwierany ponownie przez ReconnectSupervisor.
+   */
+  void addPrinter(const std::string &name, const std::string &device, int baudRate = 9600);
+
+  /// Obsługa klientów (do wywołania Daemon::stop lub sygnału SIGINT/SIGTERM).
+  void run();
+
+  /// Zatrzymanie demona.
+  void stop();
+
+private:
+
+  struct Printer
+  {
+    std::string device;
+    int baudRate;
+
+    fp::FiscalPrinter printer;
+    fp::Scheduler scheduler;
+    fp::ReconnectSupervisor supervisor;
+
+    Printer(const std::string &d, int b) : device(d), baudRate(b), scheduler(printer) {}
+
+  }; // struct Printer
+
+  class Session : public boost::enable_shared_from_this<Session>
+  {
+
+  public:
+
+    Session(fp::Daemon &daemon, boost::asio::io_service &io);
+
+    boost::asio::local::stream_protocol::socket &getSocket();
+
+    void start();
+
+    void send(const std::string &data);
+
+  private:
+
+    void readHeader();
+    void handleHeader(const boost::system::error_code &error);
+    void handleBody(const boost::system::error_code &error);
+
+    void write();
+    void handleWrite(const boost::system::error_code &error);
+
+    fp::Daemon &daemon;
+
+    boost::asio::local::stream_protocol::socket socket;
+
+    char header[4];
+    std::string body;
+
+    std::deque<std::string> output;
+
+  }; // class Session
+
+  typedef boost::shared_ptr<Session> SessionPtr;
+
+  void accept();
+  void handleAccept(SessionPtr session, const boost::system::error_code &error);
+
+  void execute(SessionPtr session, const fp::protocol::Request &request);
+
+  void complete(SessionPtr session, const fp::protocol::Completion &completion);
+
+  std::string socketPath;
+
+  boost::asio::io_service io;
+  boost::asio::local::stream_protocol::acceptor acceptor;
+  boost::asio::signal_set signals;
+
+  std::map<std::string, Printer *> printers;
+
+}; // class Daemon
+
+
+} // namespace fp
+
+
+#endif // __FP_DAEMON_HPP__
@@ -0,0 +1,15 @@
+CONFIG -= qt
+
+CONFIG += console
+
+TARGET = fiscal-printerd
+
+TEMPLATE = app
+
+INCLUDEPATH += . ..
+
+SOURCES += main.cpp Daemon.cpp
+
+HEADERS += Daemon.hpp
+
+LIBS += -L../fiscal-printer -lfiscal-printer -lboost_regex -lboost_system -lboost_thread -lboost_coroutine -lboost_context
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2014 Emanuel Koczwara Software <emanuel.koczwara@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the Free
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This library and documentation is based on resources provided
+ * by NOVITUS (http://www.novitus.pl/). Protocol description
+ * can be downloaded from website for free.
+ *
+ */
+
+
+
+#include "Daemon.hpp"
+
+#include <iostream>
+#include <cstdlib>
+
+
+using namespace fp;
+using namespace std;
+
+
+// fiscal-printerd <gniazdo> <nazwa>=<urządzenie>[@<prędkość>] ...
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3)
+  {
+    cerr << "usage: " << argv[0] << " <socket> <name>=<device>[@<baud rate>] ..." << endl;
+
+    return 1;
+  }
+
+  try
+  {
+    Daemon daemon(argv[1]);
+
+    for (int i = 2; i < argc; ++i)
+    {
+      string arg = argv[i];
+
+      size_t eq = arg.find('=');
+
+      if (eq == string::npos || eq == 0)
+      {
+        cerr << "invalid printer: " << arg << endl;
+
+        return 1;
+      }
+
+      string name = arg.substr(0, eq);
+      string device = arg.substr(eq + 1);
+
+      int baudRate = 9600;
+
+      size_t at = device.find('@');
+
+      if (at != string::npos)
+      {
+        baudRate = atoi(device.c_str() + at + 1);
+        device = device.substr(0, at);
+      }
+
+      daemon.addPrinter(name, device, baudRate);
+    }
+
+    daemon.run();
+  }
+  catch (const std::exception &e)
+  {
+    cerr << e.what() << endl;
+
+    return 1;
+  }
+
+  return 0;
+}